@@ -29,7 +29,7 @@ namespace tiny {
         //calculates the addresses of the functions and basic blocks
         void firstPass(t86::Program &program) {
             for(auto& [funName, function] : program.getFunctions()) {
-                noteLabel(funName.name());
+                noteLabel(std::string{funName.name()});
                 for (auto &block : function->getBasicBlocks()) {
                     noteLabel(block->name);
                     sizeOfProgram += block->size();
@@ -48,12 +48,21 @@ namespace tiny {
                         if (jumpIns) {
                             int address = labelAddressMap.at(jumpIns->lbl_->toString());
                             jumpIns->patchLabel(address);
+                            continue;
                         }
 
                         auto *callIns = dynamic_cast<t86::CALLIns *>(ins);
                         if (callIns) {
                             int address = labelAddressMap.at(callIns->lbl_->toString());
                             callIns->patchLabel(address);
+                            continue;
+                        }
+
+                        // addresses of basic blocks used as values, such as jump tables
+                        for (auto *operand : ins->getOperands()) {
+                            auto *lbl = dynamic_cast<t86::LabelOp *>(operand);
+                            if (lbl)
+                                lbl->patch(labelAddressMap.at(lbl->toString()));
                         }
                     }
                 }
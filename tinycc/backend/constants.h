@@ -8,4 +8,11 @@
 #define T86_WORD_SZ 8
 //how many words are in a register - if we eg push a register to the stack
 //we want to know how many words it takes up
-#define REG_TO_MEM_WORD T86_REG_SZ / T86_WORD_SZ
\ No newline at end of file
+#define REG_TO_MEM_WORD T86_REG_SZ / T86_WORD_SZ
+
+//switches with at least this many cases are dispatched through a jump table, if the table
+//has at most this many entries per case, otherwise the cases are found by a binary search
+#define JUMP_TABLE_MIN_CASES 4
+#define JUMP_TABLE_MAX_ENTRIES_PER_CASE 2
+//the binary search compares the cases one by one when there are only this many left
+#define SWITCH_LINEAR_MAX_CASES 3
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "optimizer/il.h"
+#include "constants.h"
+#include "stack.h"
+
+namespace tiny {
+
+    /** Stack homes of the IL values that live across basic blocks.
+
+        The register allocator works on single basic blocks, so a value used in another block, such as a variable promoted to a register by the optimizer, is stored to its home when defined and loaded from it by the other blocks. So is the value of a switch, whose dispatch takes several blocks. Phis are written by the jumps to their blocks. Results of calls stay in EAX unless used after the next call, or more than once. Arguments already have their homes where the caller pushed them:
+            ARG0     <- BP + 2
+            RET ADDR <- BP + 1
+            OLD BP   <- BP, SP
+
+        To avoid copying a variable between homes on every jump, a phi shares its home with the values it selects from unless any of them are live at the same time (the values interfere).
+     */
+    class HomeAllocator {
+    public:
+
+        HomeAllocator() = default;
+
+        HomeAllocator(il::Function const * f, StackAllocator & stack) {
+            findHomed(f);
+            computeLiveness(f);
+            computeInterference(f);
+            coalesce(f);
+            for (il::Instruction const * v : homed_) {
+                il::Instruction const * root = find(v);
+                if (! stack.has(root))
+                    stack.allocate(root, T86_WORD_SZ);
+                homes_[v] = stack.getOffset(root);
+            }
+            for (size_t i = 0; i < f->numArgs(); ++i) {
+                auto arg = dynamic_cast<il::Instruction::ImmI const *>(f->getArg(i));
+                assert(arg && "Argument is not an immediate instruction");
+                // add REG_TO_MEM_WORD because we have to skip the return address
+                // add 1 because the arguments are numbered from 0
+                homes_[arg] = REG_TO_MEM_WORD + static_cast<int>(arg->value) + 1;
+            }
+        }
+
+        bool contains(il::Instruction const * v) const { return homes_.find(v) != homes_.end(); }
+
+        /** Offset of the home from BP.
+         */
+        int offset(il::Instruction const * v) const {
+            assert(contains(v));
+            return homes_.at(v);
+        }
+
+        /** Number of uses of the value in the basic block, including the phis of the successors.
+         */
+        size_t uses(il::BasicBlock const * b, il::Instruction const * v) const {
+            auto i = uses_.find(b);
+            if (i == uses_.end())
+                return 0;
+            auto j = i->second.find(v);
+            return j == i->second.end() ? 0 : j->second;
+        }
+
+    private:
+
+        using ValueSet = std::unordered_set<il::Instruction const *>;
+
+        /** Calls the function for the values used by the instruction. Phis use their values at the end of the predecessors and are skipped.
+         */
+        template<typename FN>
+        static void forEachUse(il::Instruction * ins, FN fn) {
+            if (ins->opcode != il::Opcode::PHI)
+                il::forEachOperand(ins, [&](il::Instruction * & v) { fn(v); });
+        }
+
+        static std::vector<il::Instruction::Phi *> phis(il::BasicBlock const * b) {
+            std::vector<il::Instruction::Phi *> result;
+            for (size_t i = 0, e = b->numPhis(); i != e; ++i)
+                result.push_back(static_cast<il::Instruction::Phi *>((*b)[i]));
+            return result;
+        }
+
+        void findHomed(il::Function const * f) {
+            for (auto const & b : f->getBasicBlocks())
+                for (auto const & ins : b->getInstructions())
+                    defs_[ins.get()] = b.get();
+            ValueSet crossBlock;
+            auto use = [&](il::Instruction const * v, il::BasicBlock const * b) {
+                ++uses_[b][v];
+                auto def = defs_.find(v);
+                if (def != defs_.end() && def->second != b)
+                    crossBlock.insert(v);
+            };
+            for (auto const & b : f->getBasicBlocks()) {
+                for (auto const & ins : b->getInstructions())
+                    forEachUse(ins.get(), [&](il::Instruction * v) { use(v, b.get()); });
+                for (il::Instruction::Phi * phi : phis(b.get())) {
+                    for (auto & in : phi->incoming)
+                        use(in.second, in.first);
+                    crossBlock.insert(phi);
+                }
+                // the value of a switch is compared in the blocks of its dispatch
+                if (auto sw = dynamic_cast<il::Instruction::TerminatorRegBBs *>(b->size() == 0 ? nullptr : (*b)[b->size() - 1]); sw && ! sw->cases.empty())
+                    crossBlock.insert(sw->reg);
+            }
+            for (auto const & b : f->getBasicBlocks()) {
+                for (auto const & ins : b->getInstructions()) {
+                    il::Opcode op = ins->opcode;
+                    // addresses of variables and functions are not kept in registers
+                    if (op == il::Opcode::ALLOCA || op == il::Opcode::ALLOCG || op == il::Opcode::FUN)
+                        continue;
+                    if (crossBlock.count(ins.get()) || (op == il::Opcode::CALL && ! keepsInEAX(b.get(), ins.get())))
+                        homed_.push_back(ins.get());
+                }
+            }
+            homedSet_.insert(homed_.begin(), homed_.end());
+        }
+
+        /** The result of a call can be used directly from EAX if it is used once, before any other call. Uses by the phis of the successors happen at the very end of the block.
+         */
+        bool keepsInEAX(il::BasicBlock const * b, il::Instruction const * call) const {
+            size_t n = uses(b, call);
+            if (n == 0)
+                return true;
+            if (n > 1)
+                return false;
+            bool after = false;
+            for (auto const & ins : b->getInstructions()) {
+                if (ins.get() == call) {
+                    after = true;
+                    continue;
+                }
+                if (! after)
+                    continue;
+                bool uses = false;
+                forEachUse(ins.get(), [&](il::Instruction * v) { uses = uses || v == call; });
+                if (uses)
+                    return true;
+                if (ins->opcode == il::Opcode::CALL)
+                    return false;
+            }
+            return false;
+        }
+
+        /** Computes the homed values live at the end of each basic block.
+         */
+        void computeLiveness(il::Function const * f) {
+            std::unordered_map<il::BasicBlock const *, ValueSet> liveIn;
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (auto b = f->getBasicBlocks().rbegin(), e = f->getBasicBlocks().rend(); b != e; ++b) {
+                    ValueSet out;
+                    for (il::BasicBlock * s : (*b)->successors()) {
+                        ValueSet const & in = liveIn[s];
+                        out.insert(in.begin(), in.end());
+                        for (il::Instruction::Phi * phi : phis(s))
+                            if (il::Instruction * v = phi->from(b->get()); homedSet_.count(v))
+                                out.insert(v);
+                    }
+                    ValueSet in;
+                    for (il::Instruction const * v : out)
+                        if (defs_[v] != b->get())
+                            in.insert(v);
+                    for (auto const & ins : (*b)->getInstructions())
+                        forEachUse(ins.get(), [&](il::Instruction * v) {
+                            if (homedSet_.count(v) && defs_[v] != b->get())
+                                in.insert(v);
+                        });
+                    if (in != liveIn[b->get()]) {
+                        liveIn[b->get()] = std::move(in);
+                        changed = true;
+                    }
+                    liveOut_[b->get()] = std::move(out);
+                }
+            }
+        }
+
+        /** Two values interfere if one is live where the other is defined. Phis of a block are all defined at its beginning.
+         */
+        void computeInterference(il::Function const * f) {
+            for (auto const & b : f->getBasicBlocks()) {
+                ValueSet live = liveOut_[b.get()];
+                auto & insns = b->getInstructions();
+                for (auto i = insns.rbegin(), e = insns.rend(); i != e; ++i) {
+                    il::Instruction * ins = i->get();
+                    if (ins->opcode == il::Opcode::PHI)
+                        break;
+                    if (homedSet_.count(ins)) {
+                        live.erase(ins);
+                        for (il::Instruction const * v : live)
+                            interfere(ins, v);
+                    }
+                    forEachUse(ins, [&](il::Instruction * v) {
+                        if (homedSet_.count(v))
+                            live.insert(v);
+                    });
+                }
+                std::vector<il::Instruction::Phi *> ps = phis(b.get());
+                for (il::Instruction::Phi * phi : ps) {
+                    for (il::Instruction const * v : live)
+                        if (v != phi)
+                            interfere(phi, v);
+                    for (il::Instruction::Phi * other : ps)
+                        if (other != phi)
+                            interfere(phi, other);
+                }
+            }
+        }
+
+        void interfere(il::Instruction const * a, il::Instruction const * b) {
+            interference_[a].insert(b);
+            interference_[b].insert(a);
+        }
+
+        /** Merges the homes of each phi and the values it selects from, unless any two values of the merged homes interfere.
+         */
+        void coalesce(il::Function const * f) {
+            for (il::Instruction const * v : homed_)
+                members_[v] = {v};
+            for (auto const & b : f->getBasicBlocks()) {
+                for (il::Instruction::Phi * phi : phis(b.get())) {
+                    for (auto & in : phi->incoming) {
+                        if (! homedSet_.count(in.second))
+                            continue;
+                        il::Instruction const * a = find(phi);
+                        il::Instruction const * c = find(in.second);
+                        if (a == c || interfere(members_[a], members_[c]))
+                            continue;
+                        root_[c] = a;
+                        auto & into = members_[a];
+                        into.insert(into.end(), members_[c].begin(), members_[c].end());
+                        members_.erase(c);
+                    }
+                }
+            }
+        }
+
+        bool interfere(std::vector<il::Instruction const *> const & a, std::vector<il::Instruction const *> const & b) const {
+            for (il::Instruction const * x : a) {
+                auto i = interference_.find(x);
+                if (i == interference_.end())
+                    continue;
+                for (il::Instruction const * y : b)
+                    if (i->second.count(y))
+                        return true;
+            }
+            return false;
+        }
+
+        il::Instruction const * find(il::Instruction const * v) const {
+            auto i = root_.find(v);
+            while (i != root_.end()) {
+                v = i->second;
+                i = root_.find(v);
+            }
+            return v;
+        }
+
+        std::unordered_map<il::Instruction const *, il::BasicBlock const *> defs_;
+        std::unordered_map<il::BasicBlock const *, std::unordered_map<il::Instruction const *, size_t>> uses_;
+        /** Values that need homes in the order of their definitions, excluding arguments.
+         */
+        std::vector<il::Instruction const *> homed_;
+        ValueSet homedSet_;
+        std::unordered_map<il::BasicBlock const *, ValueSet> liveOut_;
+        std::unordered_map<il::Instruction const *, ValueSet> interference_;
+        /** Coalesced values point towards the value whose home they share.
+         */
+        std::unordered_map<il::Instruction const *, il::Instruction const *> root_;
+        std::unordered_map<il::Instruction const *, std::vector<il::Instruction const *>> members_;
+        std::unordered_map<il::Instruction const *, int> homes_;
+
+    }; // tiny::HomeAllocator
+
+} // namespace tiny
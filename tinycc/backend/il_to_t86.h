@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <queue>
 #include <deque>
 
@@ -13,6 +14,7 @@
 #include "common/colors.h"
 #include "common/symbol.h"
 #include "stack.h"
+#include "homes.h"
 #include "constants.h"
 #include "register_alloc.h"
 
@@ -49,12 +51,46 @@ namespace tiny {
             Symbol gmain = Symbol{"global main"};
             f_ = p_.addFunction(gmain);
             bb_ = f_->addBasicBlock("entry");
+            initializeData();
             (*this) += new t86::CALLIns(new t86::LabelOp("main"));
             (*this) += new t86::PUTNUMIns(new t86::RegOp(t86::EAX));
             (*this) += new t86::HALTIns();
             leaveFunction();
         }
 
+        /** The globals are laid out one after another in the data segment at the beginning of the memory. Their initial contents, such as the string pool (see ASTToILTranslator::initializeStrings()), are emitted as the data of the program, so no instructions are needed to initialize them. The globals basic block only computes addresses in the globals from immediates.
+         */
+        void initializeData() {
+            int size = 0;
+            std::unordered_map<il::Instruction const *, int64_t> immediates;
+            for (auto const & ins : ilp_.globals()->getInstructions()) {
+                switch (ins->opcode) {
+                    case il::Opcode::FUN:
+                        break;
+                    case il::Opcode::ALLOCG:
+                        data_[ins.get()] = size;
+                        if (auto words = ilp_.getData(ins.get())) {
+                            p_.data().resize(static_cast<size_t>(size));
+                            p_.data().insert(p_.data().end(), words->begin(), words->end());
+                        }
+                        size += static_cast<int>(StackAllocator{}.normalize(static_cast<size_t>(static_cast<il::Instruction::ImmI *>(ins.get())->value)));
+                        break;
+                    case il::Opcode::LDI:
+                        immediates[ins.get()] = static_cast<il::Instruction::ImmI *>(ins.get())->value;
+                        break;
+                    case il::Opcode::GEP: {
+                        auto gep = static_cast<il::Instruction::RegRegImmI *>(ins.get());
+                        int64_t bytes = immediates.at(gep->reg2) * gep->value;
+                        assert(bytes % T86_WORD_SZ == 0 && "Unaligned address");
+                        data_[ins.get()] = data_.at(gep->reg1) + static_cast<int>(bytes / T86_WORD_SZ);
+                        break;
+                    }
+                    default:
+                        NOT_IMPLEMENTED;
+                }
+            }
+        }
+
         void generate(il::Program const &program) {
             constructGlobalMain();
             Symbol main = Symbol{"main"};
@@ -68,13 +104,18 @@ namespace tiny {
                 while (!bbWorklist_.empty()) {
                     il::BasicBlock *bb = bbWorklist_.front();
                     bb_ = f_->addBasicBlock(bb->name);
+                    ilbb_ = bb;
                     bbWorklist_.pop_front();
+                    // registers do not live across basic blocks, values from other blocks are loaded from their homes
+                    regMap_.clear();
+                    addresses_.clear();
                     if (generatePrologue) {
                         generateCdeclPrologue();
                         generatePrologue = false;
                     }
                     for (auto const &instr: bb->getInstructions()) {
                         translate(instr.get());
+                        storeHome(instr.get());
                     }
                 }
                 leaveFunction();
@@ -106,30 +147,9 @@ namespace tiny {
             (*this) += new t86::MOVIns(new t86::RegOp(t86::BP),
                                        new t86::RegOp(t86::SP));
             // 3. allocate stack space for local variables
-            int stackSize = ilf_->getStackSize(true);
             (*this) += new t86::SUBIns(new t86::RegOp(t86::SP),
-                                                     new t86::ImmOp(stackSize));
-            // currently we have a primitive way of handling function arguments
-            // - the caller pushes the arguments on the stack
-            // - the callee then MOVs the arguments from the stack to the function's stack frame (the immediate
-            //   value represents the offset of the argument)
-            // - the callee then uses the arguments from the stack frame
-            // - additionally we assume that all the arguments have fixed size
-            for (size_t i = 0; i < ilf_->numArgs(); ++i) {
-                // the immediate value represents the offset of the arg
-                auto *instr = dynamic_cast<il::Instruction::ImmI*>(const_cast<il::Instruction *>(ilf_->getArg(i)));
-                assert(instr && "Argument is not an immediate instruction");
-                // allocate new register for the argument
-                // then move the argument from the stack to the register
-                // add REG_TO_MEM_WORD because we have to skip the return address
-                // add 1 because the arguments are numbered from 0 - so the first argument is at:
-                //  ARG0     <- BP + 2
-                //  RET ADDR <- BP + 1
-                //  OLD BP   <- BP, SP
-                auto dest = new t86::RegOp(regAllocator_.allocate());
-                auto src = new t86::MemRegOffsetOp(t86::BP, REG_TO_MEM_WORD + instr->value + 1);
-                addMOV(instr, dest, src);
-            }
+                                                     new t86::ImmOp(frameSize_));
+            // the arguments are loaded from the stack where they are used, see HomeAllocator
         }
 
         void generateCdeclEpilogue() {
@@ -137,9 +157,8 @@ namespace tiny {
             (*this) += new t86::JMPIns(new t86::LabelOp(tmp->name));
             bb_ = tmp;
             // 1. cleanup the local variables
-            int stackSize = ilf_->getStackSize(true);
             (*this) += new t86::ADDIns(new t86::RegOp(t86::SP),
-                                                     new t86::ImmOp(stackSize));
+                                                     new t86::ImmOp(frameSize_));
             // 2. restore base pointer
             (*this) += new t86::POPIns(new t86::RegOp(t86::BP));
             // 3. return
@@ -151,10 +170,98 @@ namespace tiny {
             assert(f_ == nullptr && ilf_ == nullptr && "Cannot enter a function while another function is being translated");
             f_ = p_.addFunction(name);
             ilf_ = ilp_.getFunction(name);
+            computeHomes();
             addBBToWorklist(ilp_.getFunction(name)->start());
             return f_;
         }
 
+        /** Values used outside of their basic blocks get homes on the stack, see HomeAllocator. The homes are at the top of the stack frame, local variables follow.
+         */
+        void computeHomes() {
+            stackAllocator_ = StackAllocator{};
+            homes_ = HomeAllocator{ilf_, stackAllocator_};
+            frameSize_ = stackAllocator_.getStackSize() + static_cast<int>(ilf_->getStackSize(true));
+        }
+
+        /** Returns the register holding the value in the current basic block, loading it from its home if it is defined elsewhere.
+         */
+        t86::RegOp * reg(il::Instruction * value) {
+            auto i = regMap_.find(value);
+            if (i != regMap_.end())
+                return i->second;
+            // an address used as a value, e.g. stored to a pointer
+            if (value->opcode == il::Opcode::ALLOCA || addresses_.count(value)) {
+                Address a = address(value);
+                auto dest = new t86::RegOp(regAllocator_.allocate());
+                addMOV(value, dest, new t86::RegOp(a.base));
+                if (a.offset != 0)
+                    (*this) += new t86::ADDIns(dest, new t86::ImmOp(a.offset));
+                return dest;
+            }
+            // the address of a global, e.g. of a string literal
+            if (auto g = data_.find(value); g != data_.end()) {
+                auto dest = new t86::RegOp(regAllocator_.allocate());
+                addMOV(value, dest, new t86::ImmOp(g->second));
+                return dest;
+            }
+            assert(homes_.contains(value) && "Value is not available in the basic block");
+            auto dest = new t86::RegOp(regAllocator_.allocate());
+            addMOV(value, dest, new t86::MemRegOffsetOp(t86::BP, homes_.offset(value)));
+            return dest;
+        }
+
+        /** Returns a register with the value that the instruction may overwrite. As the arithmetic instructions store the result to their first operand, the value is copied first if anything else uses it, or if it is a result of a call still in EAX, which the next call would overwrite.
+         */
+        t86::RegOp * clobberedReg(il::Instruction * value) {
+            t86::RegOp * src = reg(value);
+            if (homes_.uses(ilbb_, value) <= 1 && src->reg_ != t86::EAX)
+                return src;
+            auto dest = new t86::RegOp(regAllocator_.allocate());
+            (*this) += new t86::MOVIns(dest, src);
+            return dest;
+        }
+
+        /** A memory location in the form of the t86 addressing mode, i.e. a register and an offset in words.
+         */
+        struct Address {
+            t86::Reg base;
+            int offset;
+        };
+
+        /** Returns the location the IL address points to. Variables are at their offsets from BP and addresses computed by GEPs in the basic block are folded into the addressing mode, any other address is the value of a register.
+         */
+        Address address(il::Instruction * addr) {
+            if (addr->opcode == il::Opcode::ALLOCA)
+                return {t86::BP, stackAllocator_.getOffset(addr)};
+            auto i = addresses_.find(addr);
+            if (i != addresses_.end())
+                return i->second;
+            t86::RegOp * r = reg(addr);
+            // the next call would overwrite EAX
+            if (r->reg_ == t86::EAX) {
+                auto copy = new t86::RegOp(regAllocator_.allocate());
+                (*this) += new t86::MOVIns(copy, r);
+                r = copy;
+            }
+            return {r->reg_, 0};
+        }
+
+        /** Returns the memory operand for the IL address.
+         */
+        t86::MemRegOffsetOp * memory(il::Instruction * addr) {
+            Address a = address(addr);
+            return new t86::MemRegOffsetOp(a.base, a.offset);
+        }
+
+        /** Stores the value just defined to its home, if it has one.
+         */
+        void storeHome(il::Instruction * instr) {
+            if (instr->opcode == il::Opcode::PHI || instr->opcode == il::Opcode::ARG || instr->opcode == il::Opcode::CALL)
+                return;
+            if (homes_.contains(instr))
+                (*this) += new t86::MOVIns(new t86::MemRegOffsetOp(t86::BP, homes_.offset(instr)), reg(instr));
+        }
+
         void leaveFunction() {
             assert(bbWorklist_.empty() && "Not all function's basic blocks were translated");
             f_ = nullptr;
@@ -204,8 +311,7 @@ namespace tiny {
             switch (instr->opcode) {
                 case il::Opcode::LD: {
                     auto dest = new t86::RegOp(regAllocator_.allocate());
-                    auto src = new t86::MemRegOffsetOp(t86::BP, stackAllocator_.getOffset(instr->reg));
-                    addMOV(instr, dest, src);
+                    addMOV(instr, dest, memory(instr->reg));
                     break;
                 }
                 default:
@@ -213,12 +319,18 @@ namespace tiny {
             }
         }
 
+        /** Phis are loaded from their homes when used.
+         */
+        void visit(il::Instruction::Phi* instr) override {
+            MARK_AS_UNUSED(instr);
+        }
+
         void visit(il::Instruction::RegReg* instr) override {
             switch (instr->opcode) {
                 #define ARITHMETIC_INS(IR_INSTR, T86_INSTR) \
                     case il::Opcode::IR_INSTR: {            \
-                    t86::RegOp *op1 = regMap_[instr->reg1]; \
-                    t86::RegOp *op2 = regMap_[instr->reg2]; \
+                    t86::RegOp *op1 = clobberedReg(instr->reg1); \
+                    t86::RegOp *op2 = reg(instr->reg2); \
                     (*this) += new t86::T86_INSTR##Ins( \
                         op1, \
                         op2 \
@@ -233,19 +345,48 @@ namespace tiny {
                 ARITHMETIC_INS(DIV, DIV)
 
                 case il::Opcode::LT: // fallthrough
+                case il::Opcode::LTE: // fallthrough
                 case il::Opcode::GT: // fallthrough
+                case il::Opcode::GTE: // fallthrough
                 case il::Opcode::EQ: {
-                    (*this) += new t86::CMPIns(regMap_[instr->reg1], regMap_[instr->reg2]);
+                    (*this) += new t86::CMPIns(reg(instr->reg1), reg(instr->reg2));
                     break;
                 }
 
                 case il::Opcode::ST: {
-                    // 1. fetch the address of the target variable
-                    auto offset = stackAllocator_.getOffset(instr->reg1);
-                    auto *dest = new t86::MemRegOffsetOp(t86::BP, offset);
-                    // 2. load the register containing the value to be stored
-                    t86::RegOp *src = regMap_[instr->reg2];
-                    addMOV(instr, dest, src);
+                    // 1. load the register containing the value to be stored
+                    t86::RegOp *src = reg(instr->reg2);
+                    // 2. fetch the address of the target
+                    addMOV(instr, memory(instr->reg1), src);
+                    break;
+                }
+                default:
+                    NOT_IMPLEMENTED;
+            }
+        }
+
+        /** GEPs emit no code when the index is a constant, it only moves the offset of the address. A variable index is scaled and added to the base register, so that the offset of an array on the stack stays in the addressing mode and only BP is added to the index.
+
+            Registers do not live across basic blocks, so an access in a loop scales its index in every iteration. Hoisting the scaled base out of the loop would need strength reduction of the induction variable in the optimizer.
+         */
+        void visit(il::Instruction::RegRegImmI* instr) override {
+            switch (instr->opcode) {
+                case il::Opcode::GEP: {
+                    // t86 memory is addressed by words, which is the size of int
+                    Address base = address(instr->reg1);
+                    if (instr->reg2->opcode == il::Opcode::LDI) {
+                        int64_t bytes = static_cast<il::Instruction::ImmI *>(instr->reg2)->value * instr->value;
+                        assert(bytes % T86_WORD_SZ == 0 && "Unaligned address");
+                        addresses_.emplace(instr, Address{base.base, base.offset + static_cast<int>(bytes / T86_WORD_SZ)});
+                        break;
+                    }
+                    assert(instr->value % T86_WORD_SZ == 0 && "Elements take whole words, see Type::slotSize()");
+                    int words = static_cast<int>(instr->value / T86_WORD_SZ);
+                    t86::RegOp * index = clobberedReg(instr->reg2);
+                    if (words != 1)
+                        (*this) += new t86::MULIns(index, new t86::ImmOp(words));
+                    (*this) += new t86::ADDIns(index, new t86::RegOp(base.base));
+                    addresses_.emplace(instr, Address{index->reg_, base.offset});
                     break;
                 }
                 default:
@@ -267,6 +408,17 @@ namespace tiny {
         void visit(il::Instruction::TerminatorB* instr) override {
             switch (instr->opcode) {
                 case il::Opcode::JMP: {
+                    // the phis of the target take their values all at once, so all are read before any is written
+                    // phis sharing the home with their value need no copy
+                    std::vector<std::pair<int, t86::RegOp *>> copies;
+                    for (size_t i = 0, e = instr->target->numPhis(); i != e; ++i) {
+                        il::Instruction * phi = (*instr->target)[i];
+                        il::Instruction * value = static_cast<il::Instruction::Phi *>(phi)->from(ilbb_);
+                        if (! homes_.contains(value) || homes_.offset(value) != homes_.offset(phi))
+                            copies.emplace_back(homes_.offset(phi), reg(value));
+                    }
+                    for (auto [home, value] : copies)
+                        (*this) += new t86::MOVIns(new t86::MemRegOffsetOp(t86::BP, home), value);
                     (*this) += new t86::JMPIns(new t86::LabelOp(instr->target->name));
                     addBBToWorklist(instr->target);
                     break;
@@ -280,7 +432,7 @@ namespace tiny {
             switch (instr->opcode) {
                 case il::Opcode::RETR: {
                     // we move the return value to the eax register
-                    addMOV(instr, new t86::RegOp(t86::EAX), regMap_[instr->reg]);
+                    addMOV(instr, new t86::RegOp(t86::EAX), reg(instr->reg));
                     generateCdeclEpilogue();
                     break;
                 }
@@ -297,7 +449,9 @@ namespace tiny {
                     break; \
                 }
                 JMP_INS(LT, JGE)
+                JMP_INS(LTE, JG)
                 JMP_INS(GT, JLE)
+                JMP_INS(GTE, JL)
                 JMP_INS(EQ, JNE)
 
                 default:
@@ -305,13 +459,40 @@ namespace tiny {
             }
         }
 
+        /** Jumps to the target if the condition is false. A comparison right before the branch has set the flags already, any other value is compared to zero.
+         */
+        void jumpIfFalse(il::Instruction * cond, std::string const & target) {
+            switch (cond->opcode) {
+                case il::Opcode::LT: // fallthrough
+                case il::Opcode::LTE: // fallthrough
+                case il::Opcode::GT: // fallthrough
+                case il::Opcode::GTE: // fallthrough
+                case il::Opcode::EQ:
+                    assert(ilbb_->size() >= 2 && (*ilbb_)[ilbb_->size() - 2] == cond && "Comparison is not right before the branch");
+                    (*this) += selectJmp(cond->opcode, target);
+                    break;
+                default:
+                    (*this) += new t86::CMPIns(reg(cond), new t86::ImmOp(0));
+                    (*this) += new t86::JEIns(new t86::LabelOp(target));
+            }
+        }
+
         void visit(il::Instruction::TerminatorRegBB* instr) override {
             switch (instr->opcode) {
                 case il::Opcode::BR: {
-                    (*this) += selectJmp(instr->reg->opcode, instr->target2->name);
+                    // the optimizer splits the edges to phis, so that the copies can be placed before jumps
+                    assert(instr->target1->numPhis() == 0 && instr->target2->numPhis() == 0);
+                    bool fallthrough = bbVisited_.find(instr->target1) == bbVisited_.end();
+                    jumpIfFalse(instr->reg, instr->target2->name);
                     // compile the true branch - that will be the fallthrough case
                     // therefore we add it to the front of the worklist
-                    addBBToWorklist(instr->target1, true);
+                    // if it has been compiled already (e.g. a break), we fall through to a jump to it instead
+                    if (fallthrough) {
+                        addBBToWorklist(instr->target1, true);
+                    } else {
+                        bb_ = f_->addBasicBlock(t86::BasicBlock::makeUniqueName("fallthrough"));
+                        (*this) += new t86::JMPIns(new t86::LabelOp(instr->target1->name));
+                    }
                     addBBToWorklist(instr->target2);
                     break;
                 }
@@ -320,19 +501,103 @@ namespace tiny {
             }
         }
 
+        /** The cases are looked up by a binary search over their values, dense ranges of the cases use jump tables. The dispatch consists of several basic blocks, each loading the value from its home, see HomeAllocator.
+         */
+        void visit(il::Instruction::TerminatorRegBBs* instr) override {
+            switch (instr->opcode) {
+                case il::Opcode::SWITCH: {
+                    // the optimizer splits the edges to phis, so that the copies can be placed before jumps
+                    assert(instr->defaultTarget->numPhis() == 0);
+                    std::vector<std::pair<int64_t, il::BasicBlock *>> cases{instr->cases};
+                    std::sort(cases.begin(), cases.end(), [](auto const & a, auto const & b) { return a.first < b.first; });
+                    for (auto & c : cases) {
+                        assert(c.second->numPhis() == 0);
+                        addBBToWorklist(c.second);
+                    }
+                    addBBToWorklist(instr->defaultTarget);
+                    if (cases.empty()) {
+                        (*this) += new t86::JMPIns(new t86::LabelOp(instr->defaultTarget->name));
+                        break;
+                    }
+                    // the registers do not live across basic blocks, so the current one ends before the dispatch
+                    auto dispatch = f_->addBasicBlock(t86::BasicBlock::makeUniqueName("switch"));
+                    (*this) += new t86::JMPIns(new t86::LabelOp(dispatch->name));
+                    bb_ = dispatch;
+                    generateSwitch(instr->reg, cases.begin(), cases.end(), instr->defaultTarget);
+                    break;
+                }
+                default:
+                    NOT_IMPLEMENTED;
+            }
+        }
+
+        using SwitchCase = std::vector<std::pair<int64_t, il::BasicBlock *>>::const_iterator;
+
+        /** Generates the part of the dispatch that finds the cases in [first, last) into the current basic block, jumping to the default block for values between them that have no case.
+         */
+        void generateSwitch(il::Instruction * value, SwitchCase first, SwitchCase last, il::BasicBlock * defaultTarget) {
+            auto v = new t86::RegOp(regAllocator_.allocate());
+            (*this) += new t86::MOVIns(v, new t86::MemRegOffsetOp(t86::BP, homes_.offset(value)));
+            size_t n = static_cast<size_t>(last - first);
+            // the distance of the cases always fits unsigned, unlike the number of the table entries, which is one more
+            uint64_t span = static_cast<uint64_t>((last - 1)->first) - static_cast<uint64_t>(first->first);
+            if (n >= JUMP_TABLE_MIN_CASES && span < n * JUMP_TABLE_MAX_ENTRIES_PER_CASE) {
+                generateJumpTable(v, first, last, span + 1, defaultTarget);
+            } else if (n <= SWITCH_LINEAR_MAX_CASES) {
+                for (auto c = first; c != last; ++c) {
+                    (*this) += new t86::CMPIns(v, new t86::ImmOp(c->first));
+                    (*this) += new t86::JEIns(new t86::LabelOp(c->second->name));
+                }
+                (*this) += new t86::JMPIns(new t86::LabelOp(defaultTarget->name));
+            } else {
+                SwitchCase mid = first + static_cast<std::ptrdiff_t>(n / 2);
+                auto less = f_->addBasicBlock(t86::BasicBlock::makeUniqueName("switch"));
+                auto greater = f_->addBasicBlock(t86::BasicBlock::makeUniqueName("switch"));
+                (*this) += new t86::CMPIns(v, new t86::ImmOp(mid->first));
+                (*this) += new t86::JLIns(new t86::LabelOp(less->name));
+                (*this) += new t86::JGIns(new t86::LabelOp(greater->name));
+                (*this) += new t86::JMPIns(new t86::LabelOp(mid->second->name));
+                bb_ = less;
+                generateSwitch(value, first, mid, defaultTarget);
+                bb_ = greater;
+                generateSwitch(value, mid + 1, last, defaultTarget);
+            }
+        }
+
+        /** The table is a basic block of jumps, one for each value from the first case to the last, that is jumped into by the value's offset from the first case. Values outside of the range compare as too large unsigned numbers.
+         */
+        void generateJumpTable(t86::RegOp * v, SwitchCase first, SwitchCase last, uint64_t entries, il::BasicBlock * defaultTarget) {
+            auto table = f_->addBasicBlock(t86::BasicBlock::makeUniqueName("switch-table"));
+            // the value is not modified in place, as its home would be overwritten by it at the end of the block
+            auto index = new t86::RegOp(regAllocator_.allocate());
+            // the negated first case wraps around like the addition, even for the smallest value
+            (*this) += new t86::MOVIns(index, new t86::ImmOp(static_cast<int64_t>(0 - static_cast<uint64_t>(first->first))));
+            (*this) += new t86::ADDIns(index, v);
+            (*this) += new t86::CMPIns(index, new t86::ImmOp(static_cast<int64_t>(entries)));
+            (*this) += new t86::JAEIns(new t86::LabelOp(defaultTarget->name));
+            (*this) += new t86::ADDIns(index, new t86::LabelOp(table->name));
+            (*this) += new t86::IndirectJMPIns(index);
+            bb_ = table;
+            for (auto c = first; c != last; ++c) {
+                // values without a case between the previous one and this one
+                while (static_cast<uint64_t>(bb_->size()) < static_cast<uint64_t>(c->first) - static_cast<uint64_t>(first->first))
+                    (*this) += new t86::JMPIns(new t86::LabelOp(defaultTarget->name));
+                (*this) += new t86::JMPIns(new t86::LabelOp(c->second->name));
+            }
+            assert(bb_->size() == entries);
+        }
+
         void visit(il::Instruction::RegRegs* instr) override {
             switch (instr->opcode) {
                 case il::Opcode::CALL: {
                     // 1. push all the arguments to the stack in reverse order
-                    for (auto it = instr->regs.rbegin(); it != instr->regs.rend(); ++it) {
-                        assert(regMap_.find(*it) != regMap_.end() && "Argument register not found");
-                        (*this) += new t86::PUSHIns(regMap_[*it]);
-                    }
+                    for (auto it = instr->regs.rbegin(); it != instr->regs.rend(); ++it)
+                        (*this) += new t86::PUSHIns(reg(*it));
                     // 2. call the function
                     auto *sfun = dynamic_cast<il::Instruction::ImmS *>(instr->reg);
                     assert(sfun && "Currently we only support calls via symbols");
                     (*this) += new t86::CALLIns(
-                            new t86::LabelOp(sfun->value.name())
+                            new t86::LabelOp(std::string{sfun->value.name()})
                     );
                     // 3. clean up the stack b
                     // TODO we assume constant size of the arguments
@@ -342,8 +607,11 @@ namespace tiny {
                             new t86::ImmOp(instr->regs.size())
                     );
                     addFunToWorklist(Symbol{sfun->value});
-                    //associate the call instruction with the result register
-                    regMap_[instr] = new t86::RegOp{t86::EAX};
+                    //associate the call instruction with the result register, or store it to its home if the next call would overwrite it
+                    if (homes_.contains(instr))
+                        (*this) += new t86::MOVIns(new t86::MemRegOffsetOp(t86::BP, homes_.offset(instr)), new t86::RegOp{t86::EAX});
+                    else
+                        regMap_[instr] = new t86::RegOp{t86::EAX};
                     break;
                 }
                 default:
@@ -351,8 +619,16 @@ namespace tiny {
             }
         }
 
-        //maps original IR instructions to the corresponding registers
+        //maps original IR instructions to the corresponding registers in the current basic block
         std::unordered_map<il::Instruction*, t86::RegOp *> regMap_;
+        //addresses computed by GEPs in the current basic block, they are kept in registers only when used as values
+        std::unordered_map<il::Instruction const *, Address> addresses_;
+        //addresses of the globals in the data segment, in words
+        std::unordered_map<il::Instruction const *, int> data_;
+        //stack homes of the values used outside of their basic blocks
+        HomeAllocator homes_;
+        //words of the stack frame of the current function
+        int frameSize_ = 0;
         t86::Instruction *lastResult_;
         t86::AbstractRegAllocator regAllocator_;
         StackAllocator stackAllocator_;
@@ -362,6 +638,8 @@ namespace tiny {
         t86::Function *f_ = nullptr;
         //the function we are currently compiling, it is in the intermediate representation
         const il::Function *ilf_ = nullptr;
+        //the basic block we are currently compiling
+        il::BasicBlock *ilbb_ = nullptr;
 
         std::deque<il::BasicBlock *> bbWorklist_;
         std::unordered_set<il::BasicBlock *> bbVisited_;
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include "register.h"
 
@@ -90,7 +91,7 @@ namespace tiny::t86 {
 
     class ImmOp : public Operand {
     public:
-        ImmOp(int value) : value_(value) {}
+        ImmOp(int64_t value) : value_(value) {}
 
         std::string toString() const override {
             return std::to_string(value_);
@@ -102,10 +103,10 @@ namespace tiny::t86 {
         }
 
         std::size_t hash() const override {
-            return std::hash<int>{}(value_);
+            return std::hash<int64_t>{}(value_);
         }
 
-        int value_;
+        int64_t value_;
     };
 
     class LabelOp : public Operand {
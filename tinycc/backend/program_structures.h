@@ -140,8 +140,17 @@ namespace tiny::t86 {
 
         std::vector<std::pair<Symbol, Function *>> &getFunctions() { return functions_; }
 
+        /** The data segment, one value per word. It is loaded to the beginning of the memory, before the program starts.
+         */
+        std::vector<int64_t> & data() { return data_; }
+
         std::string toString(bool withAddr) const {
             std::stringstream ss;
+            if (! data_.empty()) {
+                ss << ".data" << "\n";
+                for (size_t i = 0; i < data_.size(); ++i)
+                    ss << data_[i] << ((i % 16 == 15 || i + 1 == data_.size()) ? "\n" : " ");
+            }
             ss << ".text" << "\n";
 
             int address = withAddr ? 0 : -1;
@@ -155,5 +164,6 @@ namespace tiny::t86 {
 
     private:
         std::vector<std::pair<Symbol, Function *>> functions_;
+        std::vector<int64_t> data_;
     };
 }
\ No newline at end of file
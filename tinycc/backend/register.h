@@ -51,7 +51,7 @@ namespace tiny::t86 {
             return !(*this == other);
         }
 
-        bool operator=(const Reg& other) {
+        Reg & operator=(const Reg& other) {
             auto typ = other.type();
             if (typ == Type::SP || typ == Type::BP || typ == Type::GP) {
                 assert(other.physical_);
@@ -60,6 +60,7 @@ namespace tiny::t86 {
             type_ = other.type_;
             index_ = other.index_;
             physical_ = other.physical_;
+            return *this;
         }
 
         bool physical() const {
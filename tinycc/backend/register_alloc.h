@@ -90,6 +90,7 @@ namespace tiny::t86 {
             liveness.clear();
             assert(freeRegs_.size() == numFreeRegs_);
             operandToRegMap_.clear();
+            dirty_.clear();
         }
 
         BeladyRegAllocator(Program &program, size_t numFreeRegs) : p_(program), numFreeRegs_(numFreeRegs) {
@@ -195,9 +196,10 @@ namespace tiny::t86 {
             curInsIndex++;
         }
 
+        // writes the memory operand back from its register, unless the register still holds the value loaded from it
         void spillIfMem(Operand* toSpill) {
             auto *mem = dynamic_cast<MemRegOffsetOp*>(toSpill);
-            if (mem != nullptr) {
+            if (mem != nullptr && dirty_.erase(toSpill) != 0) {
                 MOVIns *mov = new MOVIns(new MemRegOffsetOp(BP, mem->offset_),
                                          new RegOp(operandToRegMap_[toSpill]));
                 insertInsBeforeCurrent(mov);
@@ -233,9 +235,20 @@ namespace tiny::t86 {
             assert(curInsIndex < liveness.size());
 
             std::unordered_map<Operand*, Reg, OperandHash, OperandEqual> live = operandToRegMap_;
-            // filter out special reg operands
+            // filter out special reg operands, the registers used by the current instruction and the registers
+            // holding virtual registers used later, which have no place in memory to be spilled to
+            std::unordered_set<int> current;
+            for (Operand *o : currentBlock_->getInstructions()[curInsIndex]->getOperands()) {
+                auto it = operandToRegMap_.find(o);
+                if (it != operandToRegMap_.end() && !isSpecialRegOperand(o))
+                    current.insert(it->second.index());
+            }
+            for (const auto& [operand, reg] : operandToRegMap_) {
+                if (dynamic_cast<RegOp*>(operand) != nullptr && !isLastUse(liveness, operand, curInsIndex))
+                    current.insert(reg.index());
+            }
             for (auto it = live.begin(); it != live.end();) {
-                if (isSpecialRegOperand(it->first))
+                if (isSpecialRegOperand(it->first) || current.count(it->second.index()))
                     it = live.erase(it);
                 else ++it;
             }
@@ -267,6 +280,78 @@ namespace tiny::t86 {
             spillHelper(toSpill, true);
         }
 
+        // returns the memory operand of the instruction whose address is in a register other than BP, if any
+        static MemRegOffsetOp * pointerMemOperand(Instruction *ins) {
+            for (Operand *o : ins->getOperands()) {
+                auto mem = dynamic_cast<MemRegOffsetOp*>(o);
+                if (mem != nullptr && !isSpecialReg(mem->reg_))
+                    return mem;
+            }
+            return nullptr;
+        }
+
+        // writes the memory operands kept in registers back to memory and forgets them, so that they are loaded again
+        void writeBackMemOperands() {
+            std::vector<Reg> regs;
+            for (auto it = operandToRegMap_.begin(); it != operandToRegMap_.end();) {
+                if (dynamic_cast<MemRegOffsetOp*>(it->first) != nullptr) {
+                    spillIfMem(it->first);
+                    regs.push_back(it->second);
+                    it = operandToRegMap_.erase(it);
+                } else ++it;
+            }
+            for (Reg r : regs) {
+                bool used = false;
+                for (const auto& [operand, reg] : operandToRegMap_)
+                    used = used || reg == r;
+                if (!used)
+                    insertFreeReg(r);
+            }
+        }
+
+        // loads and stores through a pointer are not kept in registers like the variables on the stack,
+        // only the register with the address and the loaded or stored value are mapped
+        void remapPointerAccess(MOVIns *mov, MemRegOffsetOp *mem) {
+            RegOp base(mem->reg_);
+            assert(operandToRegMap_.find(&base) != operandToRegMap_.end());
+            auto memOp = new MemRegOffsetOp(operandToRegMap_[&base], mem->offset_);
+            if (mov->operand1_ == mem) {
+                mov->operand1_ = memOp;
+                auto source = dynamic_cast<RegOp*>(mov->operand2_);
+                if (source != nullptr && !isSpecialReg(source->reg_)) {
+                    assert(operandToRegMap_.find(source) != operandToRegMap_.end());
+                    mov->operand2_ = new RegOp(operandToRegMap_[source]);
+                }
+            } else {
+                auto target = dynamic_cast<RegOp*>(mov->operand1_);
+                assert(target != nullptr && !isSpecialReg(target->reg_));
+                mov->operand2_ = memOp;
+                Reg r = allocate();
+                operandToRegMap_[target] = r;
+                mov->operand1_ = new RegOp(r);
+            }
+        }
+
+        // frees the registers holding only values that are not used by the current instruction nor any later one,
+        // otherwise values kept in registers for the whole block (such as promoted variables) could be spilled
+        // while still live, registers mapped to memory are kept so that they are written back
+        void freeDeadRegs() {
+            std::unordered_map<int, bool> keep;
+            for (const auto& [operand, reg] : operandToRegMap_) {
+                if (isSpecialReg(reg))
+                    continue;
+                // immediates mapped to the register do not keep it, their later uses are unrelated
+                keep[reg.index()] = keep[reg.index()] || dynamic_cast<MemRegOffsetOp*>(operand) != nullptr
+                                    || (dynamic_cast<RegOp*>(operand) != nullptr && liveness[curInsIndex].count(operand) != 0);
+            }
+            for (auto it = operandToRegMap_.begin(); it != operandToRegMap_.end();) {
+                if (!isSpecialReg(it->second) && !keep[it->second.index()]) {
+                    insertFreeReg(it->second);
+                    it = operandToRegMap_.erase(it);
+                } else ++it;
+            }
+        }
+
         void printOperandToRegMap() {
             std::cout << "->->->->->->->->->->" << std::endl;
             for (const auto& [operand, reg] : operandToRegMap_) {
@@ -346,14 +431,21 @@ namespace tiny::t86 {
                     // and which is different from the target and which is not the last use
                     // if such operand exists, we need to move it to a different register
                     bool found = false;
-                    for (auto& [operand, reg] : operandToRegMap_) {
-                        if (*operand != *target) {
-                            if (reg == operandToRegMap_[target]) {
-                                if (!isLastUse(liveness, operand, curInsIndex)){
-                                    found = true;
-                                }
+                    for (auto it = operandToRegMap_.begin(); it != operandToRegMap_.end();) {
+                        auto operand = it->first;
+                        if (*operand != *target && it->second == operandToRegMap_[target]) {
+                            // memory operands are written back at the end of the block, so they are written back now
+                            // (if they were stored to) and loaded again if needed
+                            if (dynamic_cast<MemRegOffsetOp*>(operand) != nullptr) {
+                                spillIfMem(operand);
+                                it = operandToRegMap_.erase(it);
+                                continue;
+                            }
+                            if (!isLastUse(liveness, operand, curInsIndex)){
+                                found = true;
                             }
                         }
+                        ++it;
                     }
                     if (found) {
                         auto reg = allocate();
@@ -385,17 +477,28 @@ namespace tiny::t86 {
             auto &instructions = b->getInstructions();
             for (curInsIndex = 0; curInsIndex < instructions.size(); ++curInsIndex) {
                 Instruction *i = instructions[curInsIndex].get();
+                freeDeadRegs();
                 physicalRegInvariant();
                 std::cout << "Processing instruction " << i->toString() << std::endl;
                 printOperandToRegMap();
 
                 // last instruction in the block
                 if (curInsIndex + 1 == instructions.size()) {
-                    assert(dynamic_cast<NoOpIns*>(i) != nullptr || dynamic_cast<JumpIns*>(i) != nullptr);
+                    assert(dynamic_cast<NoOpIns*>(i) != nullptr || dynamic_cast<JumpIns*>(i) != nullptr || dynamic_cast<IndirectJMPIns*>(i) != nullptr);
                     finalizeBB();
                 }
 
                 auto mov = dynamic_cast<MOVIns*>(i);
+                if (mov != nullptr && pointerMemOperand(mov) != nullptr) {
+                    // the pointer may point to any of the memory operands kept in registers
+                    writeBackMemOperands();
+                    remapPointerAccess(mov, pointerMemOperand(mov));
+                    std::cout << i->toString() << std::endl;
+                    continue;
+                }
+                // the callee may access the memory operands through a pointer as well
+                if (dynamic_cast<CALLIns*>(i) != nullptr)
+                    writeBackMemOperands();
                 if (mov != nullptr) {
                     auto operands = mov->getOperands();
                     auto target = mov->operand1_;
@@ -404,6 +507,13 @@ namespace tiny::t86 {
                     // for special registers like SP, BP, EAX we don't care about allocation and
                     // use the instruction as is
                     if (isSpecialRegOperand(target) || isSpecialRegOperand(source)) {
+                        // copy of a special register (the result of a call in EAX) to a virtual register
+                        auto targetOp = dynamic_cast<RegOp*>(target);
+                        if (targetOp != nullptr && !isSpecialRegOperand(target)) {
+                            Reg r = allocate();
+                            operandToRegMap_[target] = r;
+                            mov->operand1_ = new RegOp(r);
+                        }
                         for (Operand *o: operands) {
                             if (isSpecialRegOperand(o)) {
                                 auto reg = dynamic_cast<RegOp*>(o);
@@ -429,6 +539,7 @@ namespace tiny::t86 {
                             // and map the memory operand to the register
                             operandToRegMap_[source] = r;
                             operandToRegMap_[target] = r;
+                            dirty_.insert(target);
                             mov->operand1_ = new RegOp(r);
 
                         }
@@ -450,10 +561,19 @@ namespace tiny::t86 {
                         // target is memory and source is in a register
                         // do the optimization to replace the MOV with NOP
                         if (memOp != nullptr) { // target is memory, thus we replace the MOV with NOP
-                            if (operandToRegMap_.find(target) != operandToRegMap_.end())
-                                if (operandToRegMap_[target] != operandToRegMap_[source])
-                                    insertFreeReg(operandToRegMap_[target]);
+                            // the old register is free unless it still holds another operand, such as a value
+                            // loaded from the memory before
+                            if (operandToRegMap_.find(target) != operandToRegMap_.end()) {
+                                Reg old = operandToRegMap_[target];
+                                operandToRegMap_[target] = operandToRegMap_[source];
+                                bool used = false;
+                                for (const auto& [operand, reg] : operandToRegMap_)
+                                    used = used || reg == old;
+                                if (!used)
+                                    insertFreeReg(old);
+                            }
                             operandToRegMap_[target] = operandToRegMap_[source];
+                            dirty_.insert(target);
                             i = replaceWithNOP(currentBlock_, curInsIndex); // assign is done just for printing purposes
                         }
                         // source is in register and target is a register
@@ -480,6 +600,7 @@ namespace tiny::t86 {
         Function *currentFunction_;
         size_t curInsIndex;
         std::unordered_map<Operand*, Reg, OperandHash, OperandEqual> operandToRegMap_;  // Map of operands to registers
+        std::unordered_set<Operand*, OperandHash, OperandEqual> dirty_;  // Memory operands stored to since they were loaded
         std::unordered_map<int, std::unordered_set<Operand*, OperandHash, OperandEqual>> liveness;
         std::set<int> freeRegs_;
         size_t numFreeRegs_;
@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include <unordered_map>
 #include "optimizer/il.h"
+#include "constants.h"
 
 namespace tiny {
 // when we allocate a variable on the stack, we need to skip the BP
@@ -27,22 +29,24 @@ namespace tiny {
         //
         StackAllocator() : offset_(SKIP_BP_OFFSET) {}
 
+        // returns the number of stack words a variable of given size occupies
         size_t normalize(size_t size) {
-            if (size <= 8)
-                return 1;
-            else {
-                //we can't handle variables larger than 8 bytes
-                NOT_IMPLEMENTED;
-            }
+            return std::max<size_t>((size + T86_WORD_SZ - 1) / T86_WORD_SZ, 1);
         }
 
+        // a variable larger than a word starts at its lowest word, so that its elements and fields
+        // are at increasing addresses
         int allocate(il::Instruction const *var, size_t size) {
             assert(offsets_.find(var) == offsets_.end());
-            offsets_.emplace(var, offset_);
             offset_ += normalize(size);
+            offsets_.emplace(var, offset_ - 1);
             return -offsets_.at(var);
         }
 
+        bool has(il::Instruction const *var) const {
+            return offsets_.find(var) != offsets_.end();
+        }
+
         int getOffset(il::Instruction const *var) const {
             assert(offsets_.find(var) != offsets_.end());
             return -offsets_.at(var);
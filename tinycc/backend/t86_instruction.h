@@ -114,6 +114,17 @@ namespace tiny::t86 {
         }
     };
 
+    // jumps to the address in the register, used for jump tables
+    class IndirectJMPIns : public UnaryIns {
+    public:
+        IndirectJMPIns(RegOp *reg)
+                : UnaryIns(reg) {}
+
+        std::string toString() const override {
+            return "JMP " + operand_->toString();
+        }
+    };
+
     #define UNARY_INSTRUCTION(name) \
     class name##Ins : public UnaryIns { \
     public: \
@@ -173,5 +184,8 @@ namespace tiny::t86 {
     JMP_INSTRUCTION(JLE);
     JMP_INSTRUCTION(JE);
     JMP_INSTRUCTION(JNE);
+    JMP_INSTRUCTION(JL);
+    JMP_INSTRUCTION(JG);
+    JMP_INSTRUCTION(JAE);
 
 } // namespace tiny
\ No newline at end of file
@@ -60,21 +60,27 @@ namespace tiny::t86 {
                     auto source = binary->getOperands()[1];
                     liveness[i].erase(target);
                     liveness[i].insert(source);
-                    continue;
                 }
                 else {
                     liveness[i].insert(binary->operand1_);
                     liveness[i].insert(binary->operand2_);
-                    continue;
                 }
             }
+            else {
+                for (const auto& operand : instruction->getOperands()) {
+                    // don't care for labels
+                    if (dynamic_cast<LabelOp*>(operand) != nullptr)
+                        continue;
 
-            for (const auto& operand : instruction->getOperands()) {
-                // don't care for labels
-                if (dynamic_cast<LabelOp*>(operand) != nullptr)
-                    continue;
+                    liveness[i].insert(operand);
+                }
+            }
 
-                liveness[i].insert(operand);
+            // the register holding the address of a memory operand is used too
+            for (const auto& operand : instruction->getOperands()) {
+                auto mem = dynamic_cast<MemRegOffsetOp*>(operand);
+                if (mem != nullptr && !isSpecialReg(mem->reg_))
+                    liveness[i].insert(new RegOp(mem->reg_));
             }
         }
 
@@ -0,0 +1,39 @@
+#include "ast_bench.h"
+
+#include "frontend/ast_cache.h"
+#include "frontend/parser.h"
+#include "frontend/typechecker.h"
+
+using namespace tiny;
+
+namespace {
+
+    /** Compares parsing & typechecking a file with loading its serialized tree. The cache is kept in memory so that only the work of the front end is measured.
+     */
+    void Cache(size_t bytes) {
+        std::string source = bench::GenerateSource(bytes);
+        SourceFile & file = SourceFile::FromText(source, "");
+        double t = bench::Measure([&]() {
+            std::unique_ptr<AST> ast = Parser::parseFile(file);
+            Typechecker::checkProgram(ast);
+            bench::sink = static_cast<ASTProgram *>(ast.get())->statements.size();
+        });
+        bench::Report(STR("parse & typecheck " << bytes / (1024 * 1024) << "MB"), source.size(), t);
+        std::unique_ptr<AST> ast = Parser::parseFile(file);
+        Typechecker::checkProgram(ast);
+        std::string data = ASTWriter::Write(static_cast<ASTProgram *>(ast.get()), file.text(), 0);
+        t = bench::Measure([&]() {
+            bench::sink = ASTReader::Read(data, file, 0)->statements.size();
+        });
+        bench::Report(STR("ASTReader::Read " << bytes / (1024 * 1024) << "MB"), source.size(), t);
+    }
+
+}
+
+std::vector<Benchmark> ast_benchmarks = {
+    BENCHMARK("AST cache", []() {
+        Cache(16 * 1024 * 1024);
+    }),
+};
+
+DEFINE_BENCHMARK_SUITE(ast_benchmarks)
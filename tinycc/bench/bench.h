@@ -0,0 +1,105 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+ * Benchmarks are organized the same way the tests are: BENCHMARK(name, function)
+ *   1. The benchmark name
+ *   2. A function that runs the measurements and reports them using bench::Report
+ *
+ *   Benchmarks are grouped in suites, each suite is a vector<Benchmark> registered
+ *   by DEFINE_BENCHMARK_SUITE. Suites are executed when the compiler is run with
+ *   the --bench argument. Only the release build gives meaningful numbers.
+ */
+
+struct Benchmark {
+    char const * file;
+    int line;
+    char const * name;
+    std::function<void()> run;
+};
+
+#define BENCHMARK(name, ...) Benchmark{__FILE__, __LINE__, name, __VA_ARGS__}
+
+/** The registry is a function local static so that suites can register themselves regardless of the order in which the translation units get initialized.
+ */
+inline std::map<std::string, std::vector<Benchmark>> & benchmarkSuites() {
+    static std::map<std::string, std::vector<Benchmark>> suites;
+    return suites;
+}
+
+#define DEFINE_BENCHMARK_SUITE(suite_name) \
+    extern std::vector<Benchmark> suite_name; \
+    namespace { \
+        struct AutoRegister##suite_name { \
+            AutoRegister##suite_name() { \
+                benchmarkSuites()[std::string(#suite_name)] = suite_name; \
+            } \
+        }; \
+        AutoRegister##suite_name autoRegister##suite_name; \
+    }
+
+namespace bench {
+
+    /** Sink for results of the measured code so that the compiler cannot optimize it away.
+     */
+    inline volatile size_t sink = 0;
+
+    /** Runs the function given number of times and returns the best time of a single run in seconds.
+     */
+    template<typename FN>
+    double Measure(FN && fn, size_t repetitions = 5) {
+        double best = 0;
+        for (size_t i = 0; i < repetitions; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            std::chrono::duration<double> t = std::chrono::steady_clock::now() - start;
+            if (i == 0 || t.count() < best)
+                best = t.count();
+        }
+        return best;
+    }
+
+    /** Reports throughput of a measurement.
+     */
+    inline void Report(std::string const & what, size_t bytes, double seconds) {
+        std::cout << "    " << std::left << std::setw(48) << what << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << (static_cast<double>(bytes) / seconds / (1024 * 1024)) << " MB/s" << std::setw(10) << (seconds * 1000) << " ms" << std::endl;
+    }
+
+    /** Reports time of a measurement normalized per item.
+     */
+    inline void ReportPer(std::string const & what, size_t items, double seconds, char const * itemName) {
+        std::cout << "    " << std::left << std::setw(48) << what << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << (seconds * 1e9 / static_cast<double>(items)) << " ns/" << itemName << std::setw(10) << (seconds * 1000) << " ms" << std::endl;
+    }
+
+    /** Generates syntactically valid tinyC source of roughly the given size. The program consists of small functions with the usual mix of indentation, comments, literals and expressions.
+     */
+    inline std::string GenerateSource(size_t bytes) {
+        std::string result;
+        result.reserve(bytes + 1024);
+        for (size_t i = 0; result.size() < bytes; ++i) {
+            std::string n = std::to_string(i);
+            result += "// computes the value of function " + n + "\n";
+            result += "int function_" + n + "(int argument, int other_argument) {\n";
+            result += "    /* local variables\n       are initialized right away */\n";
+            result += "    int local_value = argument * " + n + " + other_argument;\n";
+            result += "    double ratio = 3.14159 * local_value;\n";
+            result += "    char * message = \"function " + n + " is being evaluated\\n\";\n";
+            result += "    while (local_value < 1000) {\n";
+            result += "        local_value = local_value + other_argument * 2;\n";
+            result += "    }\n";
+            result += "    return local_value;\n";
+            result += "}\n\n";
+        }
+        return result;
+    }
+
+} // namespace bench
@@ -0,0 +1,106 @@
+#include "lexer_bench.h"
+
+#include "frontend/lexer.h"
+#include "frontend/scan.h"
+
+using namespace tiny;
+
+namespace {
+
+    constexpr size_t InputSize = 8 * 1024 * 1024;
+
+    std::string const & Source() {
+        static std::string source = bench::GenerateSource(InputSize);
+        return source;
+    }
+
+    constexpr size_t Repetitions = 5;
+
+    /** Measures the function on a fresh copy of the source in every repetition, so that lexing does not keep appending to the literal tables of a single file. The copies are closed once measured.
+     */
+    template<typename FN>
+    double MeasureOnFreshFiles(FN && fn) {
+        std::vector<SourceFile *> files;
+        for (size_t i = 0; i < Repetitions; ++i)
+            files.push_back(& SourceFile::FromText(Source(), ""));
+        size_t next = 0;
+        double t = bench::Measure([&]() {
+            fn(*files[next++]);
+        }, Repetitions);
+        for (SourceFile * file : files)
+            SourceFile::Close(file->id());
+        return t;
+    }
+
+    /** Input made of a single kind of characters, so that the kernels are measured on long runs.
+     */
+    std::string Run(std::string const & pattern) {
+        std::string result;
+        result.reserve(InputSize + pattern.size());
+        while (result.size() < InputSize)
+            result += pattern;
+        return result;
+    }
+
+    /** Calls the kernel repeatedly on the text, restarting one character after every position it stops at.
+     */
+    template<typename KERNEL>
+    void Kernel(std::string const & name, std::string const & text, KERNEL kernel) {
+        double t = bench::Measure([&]() {
+            char const * p = text.data();
+            char const * end = text.data() + text.size();
+            size_t stops = 0;
+            while (p != end) {
+                p = kernel(p, end);
+                if (p != end)
+                    ++p;
+                ++stops;
+            }
+            bench::sink = stops;
+        });
+        bench::Report(name, text.size(), t);
+    }
+
+    template<typename IMPL>
+    void Kernels(char const * impl) {
+        static std::string whitespace = Run("                \n\t\t\r\n    ") + "x";
+        static std::string identifiers = Run("a_rather_long_identifier_name0123 ");
+        static std::string digits = Run("31415926535897932384626433832795 ");
+        static std::string strings = Run("a string literal without any escapes in it\" ");
+        Kernel(STR(impl << " whitespace"), whitespace, IMPL::SkipWhitespace);
+        Kernel(STR(impl << " identifier end"), identifiers, IMPL::IdentifierEnd);
+        Kernel(STR(impl << " digits end"), digits, IMPL::DigitsEnd);
+        Kernel(STR(impl << " closing quote"), strings, [](char const * p, char const * end) { return IMPL::FindEither(p, end, '"', '\\'); });
+        Kernel(STR(impl << " comment end"), strings, [](char const * p, char const * end) { return IMPL::Find(p, end, '\n'); });
+    }
+
+    void AllKernels() {
+        Kernels<scan::Scalar>("scalar");
+#if (defined TINY_SCAN_AVX2)
+        Kernels<scan::Vector>("avx2");
+#elif (defined TINY_SCAN_SSE2)
+        Kernels<scan::Vector>("sse2");
+#endif
+    }
+
+}
+
+std::vector<Benchmark> lexer_benchmarks = {
+    BENCHMARK("scan kernels", AllKernels),
+    BENCHMARK("tokenize", []() {
+        double t = MeasureOnFreshFiles([](SourceFile & file) {
+            bench::sink = Lexer::Tokenize(file).size();
+        });
+        bench::Report(STR("Lexer::Tokenize " << Source().size() / (1024 * 1024) << "MB"), Source().size(), t);
+    }),
+    BENCHMARK("parallel tokenize", []() {
+        for (size_t chunks = 2; chunks <= std::max<size_t>(2, ThreadPool::Default().size()); chunks *= 2) {
+            double t = MeasureOnFreshFiles([chunks](SourceFile & file) {
+                bench::sink = Lexer::TokenizeParallel(file, chunks).size();
+            });
+            bench::Report(STR("Lexer::TokenizeParallel, " << chunks << " chunks"), Source().size(), t);
+        }
+    }),
+};
+
+DEFINE_BENCHMARK_SUITE(lexer_benchmarks)
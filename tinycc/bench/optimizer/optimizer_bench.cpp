@@ -0,0 +1,48 @@
+#include "optimizer_bench.h"
+
+#include "common/helpers.h"
+#include "frontend/parser.h"
+#include "frontend/typechecker.h"
+#include "optimizer/ast_to_il.h"
+#include "optimizer/il_interpreter.h"
+#include "optimizer/mem2reg.h"
+#include "test/basic_calculator/basic_calculator.h"
+
+using namespace tiny;
+
+namespace {
+
+    /** Number of IL instructions the interpreter executes for each of the basic calculator programs before and after the locals are promoted to registers.
+     */
+    void Promotion() {
+        uint64_t totalBefore = 0;
+        uint64_t totalAfter = 0;
+        for (Test const & t : basic_calculator_tests) {
+            if (! t.testResult)
+                continue;
+            std::unique_ptr<AST> ast = Parser::parse(t.input);
+            Typechecker::checkProgram(ast);
+            il::Program p = il::ASTToILTranslator::translateProgram(ast);
+            uint64_t before = 0;
+            uint64_t after = 0;
+            int64_t expected = il::ILInterpreter::run(p, before);
+            il::Mem2Reg::optimize(p);
+            int64_t result = il::ILInterpreter::run(p, after);
+            ASSERT(result == expected);
+            totalBefore += before;
+            totalAfter += after;
+            std::string file{t.file};
+            std::cout << "    " << std::left << std::setw(48) << STR(file.substr(file.rfind('/') + 1) << ":" << t.line) << std::right
+                      << std::setw(10) << before << " ->" << std::setw(8) << after << " instructions" << std::endl;
+        }
+        std::cout << "    " << std::left << std::setw(48) << "total" << std::right
+                  << std::setw(10) << totalBefore << " ->" << std::setw(8) << totalAfter << " instructions" << std::endl;
+    }
+
+}
+
+std::vector<Benchmark> optimizer_benchmarks = {
+    BENCHMARK("executed instructions after mem2reg", Promotion),
+};
+
+DEFINE_BENCHMARK_SUITE(optimizer_benchmarks)
@@ -0,0 +1,131 @@
+#include "parser_bench.h"
+
+#include "frontend/lazy.h"
+#include "frontend/parser.h"
+
+using namespace tiny;
+
+namespace {
+
+    /** Declaration heavy source. Most statements start with an identifier that is either a struct type, or a variable, so that the parser has to decide between a declaration and an expression for each of them.
+     */
+    std::string Declarations(size_t bytes) {
+        std::string result;
+        result.reserve(bytes + 1024);
+        result += "struct point { int x; int y; };\n";
+        for (size_t i = 0; result.size() < bytes; ++i) {
+            std::string n = std::to_string(i);
+            result += "point * global_" + n + ";\n";
+            result += "point ** function_" + n + "(point * a, point ** b, int c) {\n";
+            result += "    point * p = a;\n";
+            result += "    point ** q = b;\n";
+            result += "    point * r = *b;\n";
+            result += "    int i = c * 2, int j = i * c;\n";
+            result += "    p->x = p->y * i;\n";
+            result += "    i * j;\n";
+            result += "    for (int k = 0; k < j; ++k) { point * t = p; t->x = k; }\n";
+            result += "    return q;\n";
+            result += "}\n\n";
+        }
+        return result;
+    }
+
+    /** Parses inputs of growing size, the throughput should stay the same as the parser runs in linear time.
+     */
+    void Scaling(char const * name, std::string (*generate)(size_t)) {
+        for (size_t mb = 1; mb <= 16; mb *= 4) {
+            std::string source = generate(mb * 1024 * 1024);
+            double t = bench::Measure([&]() {
+                bench::sink = static_cast<ASTProgram *>(Parser::parse(source).get())->statements.size();
+            });
+            bench::Report(STR(name << " " << mb << "MB"), source.size(), t);
+        }
+    }
+
+    /** Functions whose bodies nest blocks to given depth, each block declares a variable and reads the variables of all enclosing blocks and a global.
+     */
+    std::string Nested(size_t bytes, size_t depth) {
+        std::string result;
+        result.reserve(bytes + 1024);
+        result += "int global;\n";
+        for (size_t i = 0; result.size() < bytes; ++i) {
+            result += "int function_" + std::to_string(i) + "(int a) {\n";
+            for (size_t d = 0; d < depth; ++d) {
+                std::string n = std::to_string(d);
+                result += "int v" + n + " = a + global;\n";
+                result += "a = a + v" + n + " * v" + std::to_string(d / 2) + ";\n";
+                result += "{\n";
+            }
+            for (size_t d = 0; d < depth; ++d)
+                result += "}\n";
+            result += "return a;\n}\n";
+        }
+        return result;
+    }
+
+    /** Measures typechecking of the source alone.
+     */
+    double MeasureTypecheck(std::string const & source, bool parallel = false) {
+        // the typechecker annotates the AST, so that every repetition gets a fresh one
+        std::vector<std::unique_ptr<AST>> asts;
+        for (size_t i = 0; i < 3; ++i)
+            asts.push_back(Parser::parse(source));
+        size_t next = 0;
+        return bench::Measure([&]() {
+            std::unique_ptr<AST> & ast = asts[next++];
+            Typechecker::checkProgram(ast, parallel);
+            bench::sink = static_cast<ASTProgram *>(ast.get())->statements.size();
+        }, asts.size());
+    }
+
+    /** Typechecks the same amount of code at growing nesting depths, lookups of the variables should not get slower with the depth.
+     */
+    void Nesting() {
+        for (size_t depth = 4; depth <= 256; depth *= 4) {
+            std::string source = Nested(4 * 1024 * 1024, depth);
+            double t = MeasureTypecheck(source);
+            bench::Report(STR("Typechecker, nesting depth " << depth), source.size(), t);
+        }
+    }
+
+    /** Typechecks a program of many functions with the bodies checked sequentially and on the thread pool.
+     */
+    void Parallel() {
+        for (size_t mb = 1; mb <= 16; mb *= 4) {
+            std::string source = bench::GenerateSource(mb * 1024 * 1024);
+            bench::Report(STR("Typechecker " << mb << "MB"), source.size(), MeasureTypecheck(source));
+            bench::Report(STR("Typechecker, parallel " << mb << "MB"), source.size(), MeasureTypecheck(source, true));
+        }
+    }
+
+    /** A library of many functions used by a small main. The lazy front end only parses and checks the one function main calls.
+     */
+    void Lazy() {
+        for (size_t mb = 1; mb <= 16; mb *= 4) {
+            std::string source = bench::GenerateSource(mb * 1024 * 1024) + "int main() { return function_0(1, 2); }\n";
+            double t = bench::Measure([&]() {
+                std::unique_ptr<AST> ast = Parser::parse(source);
+                Typechecker::checkProgram(ast);
+                bench::sink = static_cast<ASTProgram *>(ast.get())->statements.size();
+            });
+            bench::Report(STR("parse & typecheck " << mb << "MB"), source.size(), t);
+            t = bench::Measure([&]() {
+                bench::sink = static_cast<ASTProgram *>(LazyParser::parse(source).get())->statements.size();
+            });
+            bench::Report(STR("LazyParser::parse " << mb << "MB"), source.size(), t);
+        }
+    }
+
+}
+
+std::vector<Benchmark> parser_benchmarks = {
+    BENCHMARK("parse scaling", []() {
+        Scaling("Parser::parse functions", bench::GenerateSource);
+        Scaling("Parser::parse declarations", Declarations);
+    }),
+    BENCHMARK("lazy function bodies", Lazy),
+    BENCHMARK("typecheck nested scopes", Nesting),
+    BENCHMARK("parallel typecheck", Parallel),
+};
+
+DEFINE_BENCHMARK_SUITE(parser_benchmarks)
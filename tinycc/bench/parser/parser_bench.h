@@ -0,0 +1,7 @@
+#pragma once
+
+#include <vector>
+
+#include "bench/bench.h"
+
+extern std::vector<Benchmark> parser_benchmarks;
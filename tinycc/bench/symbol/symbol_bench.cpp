@@ -0,0 +1,58 @@
+#include <algorithm>
+#include <thread>
+
+#include "symbol_bench.h"
+
+#include "common/helpers.h"
+#include "common/symbol.h"
+
+using namespace tiny;
+
+namespace {
+
+    constexpr size_t NumNames = 1 << 16;
+    constexpr size_t LookupsPerThread = 1 << 20;
+
+    std::vector<std::string> const & Names() {
+        static std::vector<std::string> names = []() {
+            std::vector<std::string> result;
+            for (size_t i = 0; i < NumNames; ++i)
+                result.push_back("bench_identifier_" + std::to_string(i));
+            return result;
+        }();
+        return names;
+    }
+
+    /** Every thread interns the same set of names in a different order, as parallel compilations of similar sources would, and reads the names back.
+     */
+    void Intern(size_t threads) {
+        std::vector<std::string> const & names = Names();
+        double t = bench::Measure([&]() {
+            std::vector<std::thread> workers;
+            for (size_t i = 0; i < threads; ++i) {
+                workers.emplace_back([&names, i]() {
+                    size_t x = 0;
+                    for (size_t j = 0; j < LookupsPerThread; ++j) {
+                        Symbol s{names[(j * 7919 + i * 104729) % NumNames]};
+                        x += s.name().size();
+                    }
+                    bench::sink = x;
+                });
+            }
+            for (auto & w : workers)
+                w.join();
+        });
+        bench::ReportPer(STR("Symbol interning, " << threads << " thread(s)"), LookupsPerThread * threads, t, "symbol");
+    }
+
+}
+
+std::vector<Benchmark> symbol_benchmarks = {
+    BENCHMARK("concurrent interning", []() {
+        size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+            Intern(threads);
+    }),
+};
+
+DEFINE_BENCHMARK_SUITE(symbol_benchmarks)
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <vector>
+
+#include "bench/bench.h"
+
+extern std::vector<Benchmark> symbol_benchmarks;
@@ -0,0 +1,52 @@
+#include <algorithm>
+#include <thread>
+
+#include "types_bench.h"
+
+#include "common/helpers.h"
+#include "common/types.h"
+
+using namespace tiny;
+
+namespace {
+
+    constexpr size_t LookupsPerThread = 1 << 20;
+
+    /** Every thread asks for the same pointer and function types in a different order, as the typechecker does when it checks function bodies in parallel.
+     */
+    void Intern(size_t threads) {
+        Type::resetTypeInformation();
+        Type * basics[] = { Type::getInt(), Type::getDouble(), Type::getChar() };
+        double t = bench::Measure([&]() {
+            std::vector<std::thread> workers;
+            for (size_t i = 0; i < threads; ++i) {
+                workers.emplace_back([&basics, i]() {
+                    size_t x = 0;
+                    for (size_t j = 0; j < LookupsPerThread; ++j) {
+                        size_t k = j * 7919 + i * 104729;
+                        Type * p = basics[k % 3];
+                        for (size_t d = k % 4; d > 0; --d)
+                            p = Type::getPointerTo(p);
+                        x += Type::getFunction({p, basics[(k / 3) % 3], Type::getPointerTo(basics[(k / 9) % 3])})->id();
+                    }
+                    bench::sink = x;
+                });
+            }
+            for (auto & w : workers)
+                w.join();
+        });
+        bench::ReportPer(STR("Type interning, " << threads << " thread(s)"), LookupsPerThread * threads, t, "function type");
+        Type::resetTypeInformation();
+    }
+
+}
+
+std::vector<Benchmark> types_benchmarks = {
+    BENCHMARK("concurrent type interning", []() {
+        size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+            Intern(threads);
+    }),
+};
+
+DEFINE_BENCHMARK_SUITE(types_benchmarks)
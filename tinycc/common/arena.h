@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace tiny {
+
+    /** Bump allocator for objects that all die together.
+
+        Memory is handed out from large blocks and never returned one object at a time. Destroying the arena frees its blocks without running any destructors, so only objects whose destructors do nothing but free memory obtained from the arena itself may be placed in it. Containers can use the arena through Allocator.
+
+        The arena is not thread-safe.
+     */
+    class Arena {
+    public:
+
+        /** Allocator of standard containers whose storage lives in the arena. Deallocation does nothing, a container that grows leaves its old storage behind until the arena is destroyed.
+         */
+        template<typename T>
+        class Allocator {
+        public:
+            using value_type = T;
+
+            Allocator(Arena & arena):
+                arena_{& arena} {
+            }
+
+            template<typename U>
+            Allocator(Allocator<U> const & other):
+                arena_{other.arena_} {
+            }
+
+            T * allocate(size_t n) {
+                return static_cast<T *>(arena_->allocate(n * sizeof(T), alignof(T)));
+            }
+
+            void deallocate(T *, size_t) {
+            }
+
+            template<typename U>
+            bool operator == (Allocator<U> const & other) const {
+                return arena_ == other.arena_;
+            }
+
+            template<typename U>
+            bool operator != (Allocator<U> const & other) const {
+                return arena_ != other.arena_;
+            }
+
+        private:
+            template<typename U>
+            friend class Allocator;
+
+            Arena * arena_;
+        };
+
+        Arena() = default;
+
+        Arena(Arena const &) = delete;
+        Arena & operator = (Arena const &) = delete;
+
+        void * allocate(size_t size, size_t align) {
+            char * result = Align(cur_, align);
+            if (result == nullptr || result + size > end_) {
+                size_t blockSize = std::max(size + align, BlockSize);
+                blocks_.emplace_back(new char[blockSize]);
+                cur_ = blocks_.back().get();
+                end_ = cur_ + blockSize;
+                result = Align(cur_, align);
+            }
+            cur_ = result + size;
+            size_ += size;
+            return result;
+        }
+
+        /** Constructs the object in the arena. The object is never destroyed.
+         */
+        template<typename T, typename... ARGS>
+        T * make(ARGS &&... args) {
+            return new (allocate(sizeof(T), alignof(T))) T(std::forward<ARGS>(args)...);
+        }
+
+        /** Copies the string into the arena.
+         */
+        std::string_view copy(std::string_view str) {
+            char * result = static_cast<char *>(allocate(str.size(), 1));
+            std::memcpy(result, str.data(), str.size());
+            return std::string_view{result, str.size()};
+        }
+
+        /** Number of bytes allocated so far.
+         */
+        size_t size() const {
+            return size_;
+        }
+
+    private:
+
+        static constexpr size_t BlockSize = 64 * 1024;
+
+        static char * Align(char * p, size_t align) {
+            return reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(p) + align - 1) & ~(align - 1));
+        }
+
+        std::vector<std::unique_ptr<char[]>> blocks_;
+        char * cur_ = nullptr;
+        char * end_ = nullptr;
+        size_t size_ = 0;
+
+    }; // tiny::Arena
+
+} // namespace tiny
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#if (defined _MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace tiny {
+
+    /** Append-only array indexed by dense ids that can be read while it grows.
+
+        Storage is split into chunks of doubling size, chunk k holding FirstChunk << k elements, so that the elements never move once stored and the chunks can be published with a single atomic pointer. Reading an element is then a wait-free index computation and an acquire load. Elements are value-initialized.
+     */
+    template<typename T>
+    class ChunkedIndex {
+    public:
+        ChunkedIndex() = default;
+        ChunkedIndex(ChunkedIndex const &) = delete;
+        ChunkedIndex & operator = (ChunkedIndex const &) = delete;
+
+        ~ChunkedIndex() {
+            for (auto & c : chunks_)
+                delete [] c.load(std::memory_order_relaxed);
+        }
+
+        /** Returns the element of given id. The id must have been stored before.
+         */
+        T const & get(size_t id) const {
+            auto [chunk, offset] = Locate(id);
+            return chunks_[chunk].load(std::memory_order_acquire)[offset];
+        }
+
+        /** Stores the element under given id. Different ids may be stored concurrently, but the element must not be read before its store happened.
+         */
+        void store(size_t id, T const & value) {
+            auto [chunk, offset] = Locate(id);
+            T * c = chunks_[chunk].load(std::memory_order_acquire);
+            if (c == nullptr) {
+                T * fresh = new T[FirstChunk << chunk]();
+                if (chunks_[chunk].compare_exchange_strong(c, fresh, std::memory_order_acq_rel))
+                    c = fresh;
+                else
+                    delete [] fresh;
+            }
+            c[offset] = value;
+        }
+
+    private:
+        static constexpr size_t FirstChunk = 1024;
+        static constexpr size_t FirstChunkBits = 10;
+        static constexpr size_t MaxChunks = 40;
+
+        /** Chunk k starts at id (FirstChunk << k) - FirstChunk, i.e. the chunk is given by the highest set bit of id + FirstChunk.
+         */
+        static std::pair<size_t, size_t> Locate(size_t id) {
+            uint64_t x = static_cast<uint64_t>(id) + FirstChunk;
+            size_t chunk = HighestBit(x) - FirstChunkBits;
+            return std::make_pair(chunk, static_cast<size_t>(x - (uint64_t{FirstChunk} << chunk)));
+        }
+
+        static size_t HighestBit(uint64_t x) {
+#if (defined _MSC_VER)
+            unsigned long result;
+            _BitScanReverse64(&result, x);
+            return static_cast<size_t>(result);
+#else
+            return static_cast<size_t>(63 - __builtin_clzll(x));
+#endif
+        }
+
+        std::atomic<T *> chunks_[MaxChunks] = {};
+
+    }; // tiny::ChunkedIndex
+
+} // namespace tiny
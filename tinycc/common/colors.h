@@ -234,6 +234,11 @@ namespace colors {
             return *this;
         }
 
+        ColorPrinter & operator << (std::string_view str) {
+            s_ << str;
+            return *this;
+        }
+
         ColorPrinter & operator << (int64_t value) {
             s_ << numberLiteral << value;
             return *this;
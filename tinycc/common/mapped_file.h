@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+
+#if (defined _WIN32)
+#include <fstream>
+#include <sstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "helpers.h"
+
+namespace tiny {
+
+    /** Read-only contents of a file.
+
+        The file is memory-mapped where the platform allows it, on platforms without mmap it is read into memory in one go.
+     */
+    class MappedFile {
+    public:
+
+        MappedFile() = default;
+
+        explicit MappedFile(std::string const & filename) {
+#if (defined _WIN32)
+            std::ifstream f{filename, std::ios::binary};
+            if (!f)
+                throw std::runtime_error{STR("Unable to open file " << filename)};
+            std::stringstream s;
+            s << f.rdbuf();
+            contents_ = s.str();
+            data_ = contents_.data();
+            size_ = contents_.size();
+#else
+            int fd = open(filename.c_str(), O_RDONLY);
+            if (fd < 0)
+                throw std::runtime_error{STR("Unable to open file " << filename)};
+            struct stat st;
+            if (fstat(fd, &st) != 0) {
+                close(fd);
+                throw std::runtime_error{STR("Unable to stat file " << filename)};
+            }
+            size_ = static_cast<size_t>(st.st_size);
+            // mmap does not accept empty mappings, an empty file is simply an empty buffer
+            if (size_ > 0) {
+                void * addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr == MAP_FAILED) {
+                    close(fd);
+                    throw std::runtime_error{STR("Unable to map file " << filename)};
+                }
+                madvise(addr, size_, MADV_SEQUENTIAL);
+                data_ = static_cast<char const *>(addr);
+                mapped_ = true;
+            }
+            close(fd);
+#endif
+        }
+
+        MappedFile(MappedFile const &) = delete;
+        MappedFile & operator = (MappedFile const &) = delete;
+
+        ~MappedFile() {
+#if (! defined _WIN32)
+            if (mapped_)
+                munmap(const_cast<char *>(data_), size_);
+#endif
+        }
+
+        char const * data() const { return data_; }
+        size_t size() const { return size_; }
+
+        std::string_view text() const { return std::string_view{data_, size_}; }
+
+    private:
+        char const * data_ = nullptr;
+        size_t size_ = 0;
+        bool mapped_ = false;
+#if (defined _WIN32)
+        std::string contents_;
+#endif
+
+    }; // tiny::MappedFile
+
+} // namespace tiny
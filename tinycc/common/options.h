@@ -17,6 +17,11 @@ namespace tiny {
         static inline bool testIR = true;
         static inline bool testASM = true;
         static inline size_t numRegisters = 4;
+        static inline bool runBenchmarks = false;
+        static inline bool lazyParsing = false;
+        static inline bool astCache = false;
+        static inline bool packStructs = false;
+        static inline bool parallelTypecheck = false;
 
         static void setVerbose() {
             verboseAST = true;
@@ -36,6 +41,16 @@ namespace tiny {
                     verboseIL = true;
                 } else if (strcmp(argv[i], "--exitAfterFailure") == 0) {
                     exitAfterFailure = true;
+                } else if (strcmp(argv[i], "--bench") == 0) {
+                    runBenchmarks = true;
+                } else if (strcmp(argv[i], "--lazy") == 0) {
+                    lazyParsing = true;
+                } else if (strcmp(argv[i], "--cache") == 0) {
+                    astCache = true;
+                } else if (strcmp(argv[i], "--packStructs") == 0) {
+                    packStructs = true;
+                } else if (strcmp(argv[i], "--parallelTypecheck") == 0) {
+                    parallelTypecheck = true;
                 } else if (filename == nullptr) {
                     filename = argv[i];
                 } else {
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "helpers.h"
+#include "symbol.h"
+
+namespace tiny {
+
+    /** Symbol table of nested scopes.
+
+        All scopes share a single flat array indexed by the symbol id, which holds the innermost visible binding of every symbol. Declaring a symbol that is already bound in an outer scope records the shadowed binding in an undo log, leaving a scope restores the bindings recorded since it was entered. Lookups are thus a single index no matter how deep the nesting is and entering or leaving a scope does not allocate once the log has grown to the deepest nesting seen.
+
+        The table grows with the largest symbol id declared, which is at most the number of interned symbols.
+     */
+    template<typename T>
+    class ScopedTable {
+    public:
+
+        /** Opens a new innermost scope.
+         */
+        void enter() {
+            scopes_.push_back(log_.size());
+        }
+
+        /** Closes the innermost scope, all symbols declared in it become unbound or bound to what they shadowed again.
+         */
+        void leave() {
+            ASSERT(! scopes_.empty());
+            size_t mark = scopes_.back();
+            scopes_.pop_back();
+            while (log_.size() > mark) {
+                Undo & u = log_.back();
+                bindings_[u.id] = u.previous;
+                log_.pop_back();
+            }
+        }
+
+        /** Number of open scopes, the outermost scope has depth 1.
+         */
+        size_t depth() const {
+            return scopes_.size();
+        }
+
+        /** Binds the symbol in the innermost scope. Returns false, leaving the table unchanged, if the symbol is already declared in that scope.
+         */
+        bool add(Symbol name, T const & value) {
+            ASSERT(! scopes_.empty());
+            size_t id = name.id();
+            if (id >= bindings_.size())
+                bindings_.resize(id + 1);
+            Binding & b = bindings_[id];
+            if (b.depth == scopes_.size())
+                return false;
+            log_.push_back(Undo{id, b});
+            b = Binding{value, static_cast<uint32_t>(scopes_.size())};
+            return true;
+        }
+
+        /** Returns the innermost visible binding of the symbol, or nullptr if it is not bound.
+         */
+        T const * find(Symbol name) const {
+            size_t id = name.id();
+            if (id >= bindings_.size() || bindings_[id].depth == 0)
+                return nullptr;
+            return & bindings_[id].value;
+        }
+
+        /** Returns the depth of the scope the innermost visible binding of the symbol belongs to, 0 if the symbol is not bound.
+         */
+        size_t depthOf(Symbol name) const {
+            size_t id = name.id();
+            return id < bindings_.size() ? bindings_[id].depth : 0;
+        }
+
+    private:
+
+        struct Binding {
+            T value{};
+            /** Depth of the scope the binding belongs to, 0 if unbound.
+             */
+            uint32_t depth = 0;
+        }; // ScopedTable::Binding
+
+        struct Undo {
+            size_t id;
+            Binding previous;
+        }; // ScopedTable::Undo
+
+        std::vector<Binding> bindings_;
+        std::vector<Undo> log_;
+        /** Size of the log when each open scope was entered.
+         */
+        std::vector<size_t> scopes_;
+
+    }; // tiny::ScopedTable
+
+} // namespace tiny
@@ -1,57 +1,53 @@
 #pragma once
 
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
 #include <string>
-#include <unordered_map>
-#include <vector>
+
+#include "source_file.h"
 
 namespace tiny {
 
+    /** Location in a source file.
+
+        The location is only the file id and offset, line and column are computed from the file when needed.
+     */
     class SourceLocation {
     public:
-        SourceLocation(std::string const & filename, size_t line, size_t col):
-            line_(line),
-            col_(col) {
-            Filenames & f = Filenames_();
-            auto i = f.lookup.find(filename);
-            if (i == f.lookup.end()) {
-                i = f.lookup.insert(std::make_pair(filename, f.names.size())).first;
-                f.names.push_back(filename);
-            }
-            file_ = i->second;
+        SourceLocation(uint32_t file, uint32_t offset):
+            file_{file},
+            offset_{offset} {
         }
 
         std::string const & file() const {
-            return Filenames_().names[file_];
+            return SourceFile::Get(file_).filename();
+        }
+
+        uint32_t fileId() const {
+            return file_;
+        }
+
+        uint32_t offset() const {
+            return offset_;
         }
 
         size_t line() const {
-            return line_;
+            return SourceFile::Get(file_).lineAndCol(offset_).first;
         }
 
         size_t col() const {
-            return col_;
+            return SourceFile::Get(file_).lineAndCol(offset_).second;
         }
 
     private:
 
-        friend class Lexer;
-
-        size_t file_;
-        size_t line_;
-        size_t col_;
-
-        struct Filenames {
-            std::vector<std::string> names;
-            std::unordered_map<std::string, size_t> lookup;
-        };
-
-        static Filenames & Filenames_() {
-            static Filenames singleton;
-            return singleton;
-        }
+        uint32_t file_;
+        uint32_t offset_;
 
         friend std::ostream & operator << (std::ostream & s, SourceLocation const & l) {
-            s << l.file() << " [" << l.line() << ", " << l.col() << "]";
+            auto lineAndCol = SourceFile::Get(l.file_).lineAndCol(l.offset_);
+            s << l.file() << " [" << lineAndCol.first << ", " << lineAndCol.second << "]";
             return s;
         }
 
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "chunked_index.h"
+#include "helpers.h"
+#include "mapped_file.h"
+
+namespace tiny {
+
+    /** Source code as a single contiguous, read-only buffer.
+
+        Files are memory-mapped where the platform allows it so that the lexer scans the bytes in place instead of copying them through a stream first. On platforms without mmap the file is read into memory in one go.
+
+        All source files are kept in a global registry until they are closed and are identified by a 32-bit id. This is what lets tokens and source locations be just a file id and an offset: string literals are views into the buffer, other literal values are stored in side tables of the file and the line and column of a location are computed from the line offsets only when asked for, i.e. when an error is reported.
+
+        Tokens look their file up for every literal value, possibly from many threads at once, so the registry is read without locking: files are published in a ChunkedIndex the same way symbol names are and only registering, replacing and closing a file takes the lock.
+     */
+    class SourceFile {
+    public:
+
+        /** Maps the given file into memory and registers it.
+         */
+        static SourceFile & Open(std::string const & filename) {
+            return Register(std::unique_ptr<SourceFile>{new SourceFile{filename}});
+        }
+
+        /** Registers a copy of the given text as a source file.
+         */
+        static SourceFile & FromText(std::string text, std::string const & filename) {
+            return Register(std::unique_ptr<SourceFile>{new SourceFile{std::move(text), filename}});
+        }
+
+        /** Replaces the contents of a registered file with given text, keeping its id and filename. The new contents start with empty literal side tables, the caller moves the literals of the tokens it keeps over from the previous contents.
+
+            The previous contents are not destroyed but retired, so that references to them and views into their text stay valid until the owner of the file calls Release() once none of its tokens and locations refer to them.
+
+            Used by the incremental parser so that an edited file does not need a new registration, and with it new locations in all unchanged code, on every edit.
+         */
+        static SourceFile & Replace(uint32_t id, std::string text) {
+            Files & f{Files_()};
+            std::lock_guard<std::mutex> g{f.m};
+            SourceFile * old = f.index.get(id).file.load(std::memory_order_relaxed);
+            std::unique_ptr<SourceFile> file{new SourceFile{std::move(text), old->filename()}};
+            file->id_ = id;
+            f.retired[id].push_back(old);
+            f.index.store(id, Slot{file.get()});
+            return *file.release();
+        }
+
+        /** Destroys the contents of the file retired by Replace().
+         */
+        static void Release(uint32_t id) {
+            Files & f{Files_()};
+            std::lock_guard<std::mutex> g{f.m};
+            f.release(id);
+        }
+
+        /** Releases the file of given id. None of its tokens and locations may be used afterwards.
+         */
+        static void Close(uint32_t id) {
+            Files & f{Files_()};
+            std::lock_guard<std::mutex> g{f.m};
+            SourceFile * file = f.index.get(id).file.load(std::memory_order_relaxed);
+            f.index.store(id, Slot{nullptr});
+            delete file;
+            f.release(id);
+        }
+
+        static SourceFile const & Get(uint32_t id) {
+            return *Files_().index.get(id).file.load(std::memory_order_acquire);
+        }
+
+        SourceFile(SourceFile const &) = delete;
+        SourceFile & operator = (SourceFile const &) = delete;
+
+        uint32_t id() const { return id_; }
+
+        std::string const & filename() const { return filename_; }
+
+        char const * begin() const { return data_; }
+        char const * end() const { return data_ + size_; }
+        size_t size() const { return size_; }
+
+        std::string_view text() const { return std::string_view{data_, size_}; }
+
+        /** Returns the 1-based line and column of given offset.
+
+            The line offsets table is built on first use.
+         */
+        std::pair<size_t, size_t> lineAndCol(uint32_t offset) const {
+            std::call_once(linesBuilt_, [this]() {
+                lines_.push_back(0);
+                for (char const * p = data_, * e = data_ + size_; p != e; ++p) {
+                    p = static_cast<char const *>(std::memchr(p, '\n', static_cast<size_t>(e - p)));
+                    if (p == nullptr)
+                        break;
+                    lines_.push_back(static_cast<uint32_t>(p + 1 - data_));
+                }
+            });
+            auto i = std::upper_bound(lines_.begin(), lines_.end(), offset) - 1;
+            return std::make_pair(static_cast<size_t>(i - lines_.begin()) + 1, static_cast<size_t>(offset - *i) + 1);
+        }
+
+        /** \name Literal side tables
+
+            Values of numeric literals are stored with the file, their tokens only keep the index.
+         */
+        uint32_t addIntegerLiteral(int64_t value) {
+            integers_.push_back(value);
+            return static_cast<uint32_t>(integers_.size() - 1);
+        }
+
+        int64_t integerLiteral(uint32_t index) const {
+            return integers_[index];
+        }
+
+        uint32_t addDoubleLiteral(double value) {
+            doubles_.push_back(value);
+            return static_cast<uint32_t>(doubles_.size() - 1);
+        }
+
+        double doubleLiteral(uint32_t index) const {
+            return doubles_[index];
+        }
+
+        /** Literal values collected separately, e.g. by a lexer working on a chunk of the file in parallel with others.
+         */
+        struct Literals {
+            std::vector<int64_t> integers;
+            std::vector<double> doubles;
+        };
+
+        /** Appends the literals to the side tables and returns the indices of the first appended integer and double. The indices of the chunk's literals must be rebased by them.
+         */
+        std::pair<uint32_t, uint32_t> addLiterals(Literals const & literals) {
+            std::pair<uint32_t, uint32_t> result{static_cast<uint32_t>(integers_.size()), static_cast<uint32_t>(doubles_.size())};
+            integers_.insert(integers_.end(), literals.integers.begin(), literals.integers.end());
+            doubles_.insert(doubles_.end(), literals.doubles.begin(), literals.doubles.end());
+            return result;
+        }
+
+    private:
+
+        explicit SourceFile(std::string const & filename):
+            filename_{filename},
+            mapped_{filename} {
+            data_ = mapped_.data();
+            size_ = mapped_.size();
+        }
+
+        SourceFile(std::string text, std::string const & filename):
+            filename_{filename},
+            contents_{std::move(text)} {
+            data_ = contents_.data();
+            size_ = contents_.size();
+        }
+
+        static SourceFile & Register(std::unique_ptr<SourceFile> file) {
+            // offsets are 32-bit
+            if (file->size() > std::numeric_limits<uint32_t>::max())
+                throw std::runtime_error{STR("File " << file->filename() << " is too large")};
+            Files & f{Files_()};
+            std::lock_guard<std::mutex> g{f.m};
+            file->id_ = f.size++;
+            f.index.store(file->id_, Slot{file.get()});
+            return *file.release();
+        }
+
+        uint32_t id_ = 0;
+        std::string filename_;
+        char const * data_ = nullptr;
+        size_t size_ = 0;
+        MappedFile mapped_;
+        std::string contents_;
+
+        mutable std::once_flag linesBuilt_;
+        mutable std::vector<uint32_t> lines_;
+
+        std::vector<int64_t> integers_;
+        std::vector<double> doubles_;
+
+        /** Registry entry. The pointer is atomic so that it can be replaced while other threads read it, the copies are what ChunkedIndex stores with.
+         */
+        struct Slot {
+            std::atomic<SourceFile *> file{nullptr};
+
+            Slot() = default;
+
+            explicit Slot(SourceFile * f):
+                file{f} {
+            }
+
+            Slot(Slot const & other):
+                file{other.file.load(std::memory_order_acquire)} {
+            }
+
+            Slot & operator = (Slot const & other) {
+                file.store(other.file.load(std::memory_order_acquire), std::memory_order_release);
+                return *this;
+            }
+        };
+
+        /** Files indexed by id and their retired contents, owned by the registry. The mutex is only taken by writers.
+         */
+        struct Files {
+            std::mutex m;
+            uint32_t size = 0;
+            ChunkedIndex<Slot> index;
+            std::unordered_map<uint32_t, std::vector<SourceFile *>> retired;
+
+            ~Files() {
+                for (uint32_t i = 0; i < size; ++i)
+                    delete index.get(i).file.load(std::memory_order_relaxed);
+                for (auto & [id, files] : retired)
+                    for (SourceFile * file : files)
+                        delete file;
+            }
+
+            void release(uint32_t id) {
+                auto i = retired.find(id);
+                if (i == retired.end())
+                    return;
+                for (SourceFile * file : i->second)
+                    delete file;
+                retired.erase(i);
+            }
+        };
+
+        static Files & Files_() {
+            static Files singleton;
+            return singleton;
+        }
+
+    }; // tiny::SourceFile
+
+} // namespace tiny
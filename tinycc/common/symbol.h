@@ -1,12 +1,25 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
-#include <unordered_map>
+
+#include "arena.h"
+#include "chunked_index.h"
 
 
 namespace tiny {
 
+    /** Interned name.
+
+        Symbols are compared by their ids only. The table of names is shared by the whole process and can be used from multiple threads at once: interning locks one of the shards the lookup is striped across, reading the name of an existing symbol does not lock at all.
+     */
     class Symbol {
     public:
 
@@ -68,21 +81,35 @@ namespace tiny {
         static Symbol const KwVoid;
         static Symbol const KwWhile;
 
-        explicit Symbol(std::string const & name) {
+        /** Interns the name. Safe to call from multiple threads, only the shard the name hashes to is locked.
+         */
+        explicit Symbol(std::string_view name):
+            Symbol{name, Hash(name)} {
+        }
+
+        /** Interns the name whose hash has already been computed by Hash(). Names that are already interned are found without any allocation.
+         */
+        Symbol(std::string_view name, size_t hash) {
             Symbols & s{Symbols_()};
-            auto i = s.lookup.find(name);
-            if (i == s.lookup.end()) {
-                i = s.lookup.insert(std::make_pair(name, s.names.size())).first;
-                s.names.push_back(name);
-            }
-            id_ = i->second;
+            id_ = s.shards[hash % NumShards].intern(name, hash, s);
         }
 
         Symbol(Symbol const & other) = default;
 
-        std::string const & name() const {
-            Symbols & s{Symbols_()};
-            return s.names[id_];
+        /** Returns the symbol of given id. The id must come from an existing symbol.
+         */
+        static Symbol FromId(size_t id) {
+            return Symbol{id};
+        }
+
+        /** Returns the name of the symbol. Does not lock, names never move once stored.
+         */
+        std::string_view name() const {
+            return Symbols_().names.get(id_);
+        }
+
+        static size_t Hash(std::string_view name) {
+            return std::hash<std::string_view>{}(name);
         }
 
         bool operator == (Symbol const & other) const {
@@ -99,13 +126,81 @@ namespace tiny {
 
     private:
 
+        explicit Symbol(size_t id):
+            id_{id} {
+        }
+
         size_t id_;
 
+        static constexpr size_t NumShards = 16;
+
+        struct Symbols;
+
+        /** One stripe of the lookup. An open addressing table with linear probing whose entries keep the full hash, so that the name is only compared when the hashes match. The names themselves are views into the shard's arena.
+         */
+        class Shard {
+        public:
+            size_t intern(std::string_view name, size_t hash, Symbols & s) {
+                std::lock_guard<std::mutex> g{m_};
+                if ((size_ + 1) * 2 > slots_.size())
+                    grow();
+                size_t mask = slots_.size() - 1;
+                // the low bits select the shard, the slot is selected by the rest
+                for (size_t i = (hash / NumShards) & mask; ; i = (i + 1) & mask) {
+                    Entry & e = slots_[i];
+                    if (e.name == nullptr) {
+                        std::string_view stored = arena_.copy(name);
+                        e = Entry{hash, stored.data(), stored.size(), s.nextId.fetch_add(1, std::memory_order_relaxed)};
+                        ++size_;
+                        // the name must be in place before the id can be observed by anyone else
+                        s.names.store(e.id, stored);
+                        return e.id;
+                    }
+                    if (e.hash == hash && std::string_view{e.name, e.length} == name)
+                        return e.id;
+                }
+            }
+
+        private:
+            struct Entry {
+                size_t hash;
+                char const * name;
+                size_t length;
+                size_t id;
+            };
+
+            void grow() {
+                std::vector<Entry> slots(std::max(slots_.size() * 2, InitialSlots), Entry{0, nullptr, 0, 0});
+                size_t mask = slots.size() - 1;
+                for (Entry const & e : slots_) {
+                    if (e.name == nullptr)
+                        continue;
+                    size_t i = (e.hash / NumShards) & mask;
+                    while (slots[i].name != nullptr)
+                        i = (i + 1) & mask;
+                    slots[i] = e;
+                }
+                slots_ = std::move(slots);
+            }
+
+            static constexpr size_t InitialSlots = 256;
+
+            std::mutex m_;
+            std::vector<Entry> slots_;
+            size_t size_ = 0;
+            Arena arena_;
+        };
+
         struct Symbols {
-            std::vector<std::string> names;
-            std::unordered_map<std::string, size_t> lookup;
+            std::atomic<size_t> nextId{0};
+            Shard shards[NumShards];
+            /** Names by symbol id, reading a name does not lock.
+             */
+            ChunkedIndex<std::string_view> names;
         };
 
+        /** The singleton is initialized on first use, which C++ guarantees to be thread-safe.
+         */
         static Symbols & Symbols_() {
             static Symbols singleton;
             return singleton;
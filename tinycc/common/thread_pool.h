@@ -0,0 +1,90 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tiny {
+
+    /** A fixed set of worker threads executing tasks in the order they were submitted.
+
+        The compiler uses a single process-wide pool, see Default(), so that the parallel phases do not oversubscribe the machine when they are nested or run side by side.
+     */
+    class ThreadPool {
+    public:
+
+        explicit ThreadPool(size_t threads) {
+            for (size_t i = 0; i < threads; ++i)
+                workers_.emplace_back([this]() { work(); });
+        }
+
+        ThreadPool(ThreadPool const &) = delete;
+        ThreadPool & operator = (ThreadPool const &) = delete;
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> g{m_};
+                stop_ = true;
+            }
+            cv_.notify_all();
+            for (auto & w : workers_)
+                w.join();
+        }
+
+        /** The pool used by the compiler, one thread per hardware thread.
+         */
+        static ThreadPool & Default() {
+            static ThreadPool singleton{std::max(1u, std::thread::hardware_concurrency())};
+            return singleton;
+        }
+
+        size_t size() const {
+            return workers_.size();
+        }
+
+        /** Schedules the task and returns the future of its result. Exceptions thrown by the task are rethrown by the future's get().
+         */
+        template<typename FN>
+        auto submit(FN && fn) -> std::future<decltype(fn())> {
+            using Result = decltype(fn());
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<FN>(fn));
+            std::future<Result> result = task->get_future();
+            {
+                std::lock_guard<std::mutex> g{m_};
+                tasks_.emplace_back([task]() { (*task)(); });
+            }
+            cv_.notify_one();
+            return result;
+        }
+
+    private:
+
+        void work() {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> g{m_};
+                    cv_.wait(g, [this]() { return stop_ || ! tasks_.empty(); });
+                    if (tasks_.empty())
+                        return;
+                    task = std::move(tasks_.front());
+                    tasks_.pop_front();
+                }
+                task();
+            }
+        }
+
+        std::vector<std::thread> workers_;
+        std::deque<std::function<void()>> tasks_;
+        std::mutex m_;
+        std::condition_variable cv_;
+        bool stop_ = false;
+
+    }; // tiny::ThreadPool
+
+} // namespace tiny
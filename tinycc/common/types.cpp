@@ -4,56 +4,81 @@ namespace tiny {
 
 
     void Type::resetTypeInformation() {
-        // clear all named types and reinitialize them
-        auto & t = types();
-        for (auto & i : t)
-            delete i.second;
-        t = initializeTypes();
-        // clear all pointer types
-        auto & pt = pointerTypes();
-        for (auto & i : pt) 
-            delete i.second;
-        pt.clear();
-        // clear all function types
-        auto & ft = functionTypes();
-        for (auto & i : ft) 
-            delete i.second;
-        ft.clear();
+        // clear all types and reinitialize the builtin ones
+        Types & t = Types_();
+        clear(t);
+        initialize(t);
     }
 
-    std::unordered_map<Symbol, Type *> Type::initializeTypes() {
-        std::unordered_map<Symbol, Type *> result;
-        result[Symbol::KwVoid] = new SimpleType{Symbol::KwVoid, 0};
-        result[Symbol::KwInt] = new SimpleType{Symbol::KwInt, 8};
-        result[Symbol::KwDouble] = new SimpleType{Symbol::KwDouble, 8};
-        result[Symbol::KwChar] = new SimpleType{Symbol::KwChar, 1};
-        return result;
+    void Type::initialize(Types & t) {
+        // the order must match the builtin ids
+        Type * builtins[] = {
+            new SimpleType{Symbol::KwVoid, 0},
+            new SimpleType{Symbol::KwInt, 8},
+            new SimpleType{Symbol::KwDouble, 8},
+            new SimpleType{Symbol::KwChar, 1},
+        };
+        for (Type * type : builtins) {
+            add(t, type);
+            t.named[static_cast<SimpleType *>(type)->name()] = type;
+        }
+    }
+
+    void Type::clear(Types & t) {
+        for (uint32_t i = 0, e = t.size.load(); i < e; ++i) {
+            delete t.types.get(i);
+            t.types.store(i, nullptr);
+        }
+        t.size = 0;
+        t.named.clear();
+        for (FunctionShard & shard : t.functions)
+            shard.types.clear();
     }
 
     PointerType * Type::getPointerTo(Type * base) {
-        auto & t = pointerTypes();
-        auto i = t.find(base);
-        if (i == t.end()) 
-            i = t.insert(std::make_pair(base, new PointerType{base})).first;
-        return i->second;
+        PointerType * result = base->pointerTo_.load(std::memory_order_acquire);
+        if (result != nullptr)
+            return result;
+        Types & t = Types_();
+        std::lock_guard<std::mutex> g{t.pointersM};
+        result = base->pointerTo_.load(std::memory_order_relaxed);
+        if (result == nullptr) {
+            result = new PointerType{base};
+            add(t, result);
+            base->pointerTo_.store(result, std::memory_order_release);
+        }
+        return result;
     }
 
     FunctionType * Type::getFunction(std::vector<Type *> const & signature) {
-        auto & types = functionTypes();
-        auto i = types.find(signature);
-        if (i == types.end())
-            i = types.insert(std::make_pair(signature, new FunctionType{signature})).first;
+        std::vector<uint32_t> key;
+        key.reserve(signature.size());
+        for (Type * i : signature)
+            key.push_back(i->id());
+        Types & t = Types_();
+        FunctionShard & shard = t.functions[SignatureHash{}(key) % NumShards];
+        std::lock_guard<std::mutex> g{shard.m};
+        auto i = shard.types.find(key);
+        if (i == shard.types.end()) {
+            FunctionType * result = new FunctionType{signature};
+            add(t, result);
+            i = shard.types.insert(std::make_pair(std::move(key), result)).first;
+        }
         return i->second;
     }
 
     StructType * Type::getOrDeclareStruct(Symbol name) {
-        auto & ts = types();
-        auto i = ts.find(name);
-        if (i == ts.end()) 
-            i = ts.insert(std::make_pair(name, new StructType{name})).first;
+        Types & t = Types_();
+        std::unique_lock<std::shared_mutex> g{t.namedM};
+        auto i = t.named.find(name);
+        if (i == t.named.end()) {
+            StructType * result = new StructType{name};
+            add(t, result);
+            i = t.named.insert(std::make_pair(name, result)).first;
+        }
         return dynamic_cast<StructType*>(i->second);
     }
 
 
 
-} // namespace tiny
\ No newline at end of file
+} // namespace tiny
@@ -1,10 +1,19 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
+#include <vector>
 
 
 #include "helpers.h"
+#include "options.h"
 #include "symbol.h"
+#include "chunked_index.h"
+#include "backend/constants.h"
 
 
 namespace tiny {
@@ -16,27 +25,43 @@ namespace tiny {
     class FunctionType;
     class StructType;
 
-    struct TypeHash {
-        std::uint64_t operator () (std::vector<Type *> const & x) const {
-            std::hash<Type *> hasher{};
-            std::uint64_t result = 0;
-            for (auto i : x)
-                result += hasher(i);
-            return result;
-        }
-    }; // TypeHash
-
     /** Basic type class. 
+
+        Types are interned in a process-wide table and each has a dense 32-bit id, so that two types are the same iff their ids (and pointers) are. The table can be used from multiple threads at once: a type is found by its id without locking, pointer types are cached in their base types and function types are looked up in shards locked independently. Only resetTypeInformation() must not run concurrently with anything else.
      */
     class Type {
     public:
 
         virtual ~Type() = default;
 
+        /** Returns the id of the type, ids are dense and unique since the last resetTypeInformation().
+         */
+        uint32_t id() const { return id_; }
+
+        /** Returns the type of given id. Does not lock.
+         */
+        static Type * FromId(uint32_t id) {
+            return Types_().types.get(id);
+        }
+
+        /** Returns the number of types, all ids are smaller.
+         */
+        static uint32_t NumTypes() {
+            return Types_().size.load(std::memory_order_acquire);
+        }
+
         /** Returns the size of the type in bytes. 
          */
         virtual size_t size() const = 0;
 
+        /** Returns the alignment of the type in bytes, values of the type are stored at offsets that are multiples of it.
+         */
+        virtual size_t alignment() const { return std::max<size_t>(size(), 1); }
+
+        /** Returns the number of bytes a value of the type occupies in memory, i.e. its size rounded up to whole words. Memory is addressed by words and loads and stores move a whole word, so a char or a pointer still needs a word of its own.
+         */
+        size_t slotSize() const { return std::max<size_t>((size() + T86_WORD_SZ - 1) / T86_WORD_SZ, 1) * T86_WORD_SZ; }
+
         /** Returns whether the type is fully defined. This is by default true for all types, but we will override this behavior for structs to allow
          *  forward declarations. 
          */
@@ -58,13 +83,16 @@ namespace tiny {
         static void resetTypeInformation(); 
 
         static Type * getType(Symbol sym) {
-            auto ts = types();
-            auto i = ts.find(sym);
-            return i == ts.end() ? nullptr : i->second;
+            Types & t = Types_();
+            std::shared_lock<std::shared_mutex> g{t.namedM};
+            auto i = t.named.find(sym);
+            return i == t.named.end() ? nullptr : i->second;
         }
 
         static Type * createAlias(Symbol sym, Type * type) {
-            types()[sym] = type;
+            Types & t = Types_();
+            std::unique_lock<std::shared_mutex> g{t.namedM};
+            t.named[sym] = type;
             return type;
         }
 
@@ -74,13 +102,15 @@ namespace tiny {
 
         static StructType * getOrDeclareStruct(Symbol name);
 
-        static Type * getVoid() { return getType(Symbol::KwVoid); }
+        /** The builtin types are created first, their ids are fixed.
+         */
+        static Type * getVoid() { return FromId(VoidId); }
 
-        static Type * getInt() { return getType(Symbol::KwInt); }
+        static Type * getInt() { return FromId(IntId); }
 
-        static Type * getDouble() { return getType(Symbol::KwDouble); }
+        static Type * getDouble() { return FromId(DoubleId); }
 
-        static Type * getChar() { return getType(Symbol::KwChar); }
+        static Type * getChar() { return FromId(CharId); }
 
         virtual void format(std::ostream & s) const = 0;
 
@@ -91,22 +121,64 @@ namespace tiny {
             return s;
         }
 
-        static std::unordered_map<Symbol, Type *> & types() {
-            static std::unordered_map<Symbol, Type *> types = initializeTypes();
-            return types;
-        }
+        static constexpr uint32_t VoidId = 0;
+        static constexpr uint32_t IntId = 1;
+        static constexpr uint32_t DoubleId = 2;
+        static constexpr uint32_t CharId = 3;
+
+        static constexpr size_t NumShards = 16;
 
-        static std::unordered_map<Type *, PointerType *> & pointerTypes() {
-            static std::unordered_map<Type *, PointerType *> types;
-            return types;
+        struct SignatureHash {
+            size_t operator () (std::vector<uint32_t> const & x) const {
+                uint64_t result = 0xcbf29ce484222325;
+                for (uint32_t i : x)
+                    result = (result ^ i) * 0x100000001b3;
+                return static_cast<size_t>(result);
+            }
+        }; // Type::SignatureHash
+
+        struct FunctionShard {
+            std::mutex m;
+            std::unordered_map<std::vector<uint32_t>, FunctionType *, SignatureHash> types;
+        }; // Type::FunctionShard
+
+        struct Types {
+            std::atomic<uint32_t> size{0};
+            ChunkedIndex<Type *> types;
+            /** Serializes the creation of pointer types.
+             */
+            std::mutex pointersM;
+            std::shared_mutex namedM;
+            std::unordered_map<Symbol, Type *> named;
+            FunctionShard functions[NumShards];
+
+            Types() { initialize(*this); }
+            ~Types() { clear(*this); }
+        }; // Type::Types
+
+        /** The singleton is initialized on first use, which C++ guarantees to be thread-safe.
+         */
+        static Types & Types_() {
+            static Types singleton;
+            return singleton;
         }
 
-        static std::unordered_map<std::vector<Type *>, FunctionType*, TypeHash> & functionTypes() {
-            static std::unordered_map<std::vector<Type *>, FunctionType*, TypeHash> types;
-            return types;
+        static void initialize(Types & t);
+
+        static void clear(Types & t);
+
+        /** Assigns the next id to the type and publishes it in the table.
+         */
+        static void add(Types & t, Type * type) {
+            type->id_ = t.size.fetch_add(1, std::memory_order_acq_rel);
+            t.types.store(type->id_, type);
         }
 
-        static std::unordered_map<Symbol, Type *> initializeTypes();
+        uint32_t id_ = 0;
+
+        /** The pointer to this type, once created.
+         */
+        std::atomic<PointerType *> pointerTo_{nullptr};
 
     }; // tiny::Type
 
@@ -119,6 +191,8 @@ namespace tiny {
     class SimpleType : public Type {
     public:
 
+        Symbol name() const { return name_; }
+
         size_t size() const override { return size_; }
 
         /** All PODs convert to bool (!= 0), but void does not. */
@@ -206,6 +280,8 @@ namespace tiny {
 
         size_t size() const override { return 0; }
 
+        size_t alignment() const override { return 1; }
+
         void format(std::ostream & s) const override {  
             signature_[0]->format(s);
             s << "(";
@@ -228,9 +304,24 @@ namespace tiny {
 
     }; // tiny::FunctionType
 
+    /** Structure type.
+
+        The fields are kept in the order of their declaration. Their layout in memory, i.e. the offsets of the fields together with the size and alignment of the struct, is computed the first time it is needed and does not change afterwards. Each field takes a slot of whole words, see Type::slotSize(), and is aligned to its type's alignment. The size is padded to a multiple of the struct's alignment, which is the largest alignment of its fields.
+
+        With Options::packStructs the fields are laid out in a different order: fields that are accessed anywhere in the program go first so that they share cache lines, hotter fields first, followed by the fields that are never accessed. As every field already takes whole words this only groups the hot fields together, it does not remove any padding. The access counts are collected by the typechecker, see countAccess(), so the layout should not be requested before the whole program has been typechecked.
+     */
     class StructType : public Type {
     public:
 
+        /** A field placed in memory.
+         */
+        struct Field {
+            Symbol name;
+            Type * type;
+            size_t offset;
+            uint32_t accesses;
+        }; // StructType::Field
+
         /** Returns true if the struct type is fully defined.
          */
         bool isFullyDefined() const override {
@@ -241,19 +332,36 @@ namespace tiny {
         void markAsFullyDefined() {
             ASSERT(fullyDefined_ == false);
             fullyDefined_ = true;
-            // Emptry struct still needs to occupy some memory for various purposes
-            if (size_ == 0)
-                size_ = 1;
+            accesses_.reset(new std::atomic<uint32_t>[fields_.size()]());
         }
 
-        /** Calculates the size of the struct and returns it. 
+        /** Returns the size of the struct, including padding. Empty struct still needs to occupy some memory for various purposes.
          */
-        size_t size() const override { return size_; }
+        size_t size() const override { return computeLayout().size; }
+
+        size_t alignment() const override { return computeLayout().alignment; }
 
         void format(std::ostream & s) const override {
             s << "struct " << name_.name();
         }        
 
+        Symbol name() const { return name_; }
+
+        std::vector<std::pair<Symbol, Type *>> const & fields() const { return fields_; }
+
+        /** Returns the fields in the order they are laid out in memory.
+         */
+        std::vector<Field> const & layout() const { return computeLayout().fields; }
+
+        /** Returns the offset of given field in bytes.
+         */
+        size_t offsetOf(Symbol name) const {
+            for (Field const & f : layout())
+                if (f.name == name)
+                    return f.offset;
+            UNREACHABLE;
+        }
+
         /** Adds the field with given name and type to the structure. 
          
             Returns true if the field has been added correctly, false otherwise (if a field with same name already exists).
@@ -265,11 +373,33 @@ namespace tiny {
                 if (i.first == name)
                     return false;
             fields_.push_back(std::make_pair(name, type));     
-            // TODO should we do memory alignment & padding? 
-            size_ += type->size();
             return true;
         }
 
+        /** Records that the field has been accessed given number of times. Can be called from multiple threads at once.
+         */
+        void countAccess(Symbol name, uint32_t times = 1) {
+            ASSERT(isFullyDefined());
+            for (size_t i = 0, e = fields_.size(); i != e; ++i)
+                if (fields_[i].first == name)
+                    accesses_[i].fetch_add(times, std::memory_order_relaxed);
+        }
+
+        uint32_t accesses(Symbol name) const {
+            for (size_t i = 0, e = fields_.size(); i != e; ++i)
+                if (fields_[i].first == name)
+                    return accesses_[i].load(std::memory_order_relaxed);
+            return 0;
+        }
+
+        /** Prints the layout, one field per line.
+         */
+        void formatLayout(std::ostream & s) const {
+            s << "struct " << name_.name() << ": size " << size() << ", alignment " << alignment() << std::endl;
+            for (Field const & f : layout())
+                s << "    " << f.offset << ": " << f.name.name() << " " << *f.type << " (" << f.accesses << " accesses)" << std::endl;
+        }
+
         Type * operator[](Symbol name) const {
             for (auto & i : fields_)
                 if (i.first == name)
@@ -282,13 +412,46 @@ namespace tiny {
 
         StructType(Symbol name): name_{name} {}
 
+        struct Layout {
+            std::vector<Field> fields;
+            size_t size = 0;
+            size_t alignment = 1;
+        }; // StructType::Layout
+
+        Layout const & computeLayout() const {
+            ASSERT(isFullyDefined());
+            std::call_once(laidOut_, [this]() {
+                for (size_t i = 0, e = fields_.size(); i != e; ++i)
+                    layout_.fields.push_back(Field{fields_[i].first, fields_[i].second, 0, accesses_[i].load(std::memory_order_relaxed)});
+                if (Options::packStructs)
+                    std::stable_sort(layout_.fields.begin(), layout_.fields.end(), [](Field const & a, Field const & b) {
+                        return a.accesses > b.accesses;
+                    });
+                size_t offset = 0;
+                for (Field & f : layout_.fields) {
+                    size_t align = f.type->alignment();
+                    offset = (offset + align - 1) / align * align;
+                    f.offset = offset;
+                    offset += f.type->slotSize();
+                    layout_.alignment = std::max(layout_.alignment, align);
+                }
+                layout_.size = std::max<size_t>((offset + layout_.alignment - 1) / layout_.alignment * layout_.alignment, 1);
+            });
+            return layout_;
+        }
+
         Symbol name_;
 
         bool fullyDefined_ = false;
 
-        size_t size_ = 0;
+        std::vector<std::pair<Symbol, Type *>> fields_;
+
+        /** Access counts of the fields, in declaration order.
+         */
+        std::unique_ptr<std::atomic<uint32_t>[]> accesses_;
 
-        std::vector<std::pair<Symbol, Type *>> fields_;        
+        mutable std::once_flag laidOut_;
+        mutable Layout layout_;
 
     }; // tiny::StructType
 
@@ -3,6 +3,7 @@
 #include <unordered_map>
 #include <memory>
 
+#include "common/arena.h"
 #include "common/helpers.h"
 #include "common/colors.h"
 #include "common/options.h"
@@ -16,11 +17,61 @@ namespace tiny {
 
     class Type;
 
+    /** List of child nodes. Its storage lives in the arena of the program, just like the nodes themselves.
+     */
+    template<typename T>
+    using ASTList = std::vector<T, Arena::Allocator<T>>;
+
+    /** Kind of an AST node, one for each non-abstract node class. Allows checking the class of a node without a dynamic_cast.
+     */
+    enum class ASTKind : uint8_t {
+        Program,
+        Integer,
+        Double,
+        Char,
+        String,
+        Identifier,
+        PointerType,
+        ArrayType,
+        NamedType,
+        Sequence,
+        Block,
+        VarDecl,
+        FunDecl,
+        StructDecl,
+        FunPtrDecl,
+        If,
+        Switch,
+        While,
+        DoWhile,
+        For,
+        Break,
+        Continue,
+        Return,
+        BinaryOp,
+        Assignment,
+        UnaryOp,
+        UnaryPostOp,
+        Address,
+        Deref,
+        Index,
+        Member,
+        MemberPtr,
+        Call,
+        Cast,
+        Print,
+        Scan,
+    }; // tiny::ASTKind
+
     class AST {
     public:
 
         virtual ~AST() = default;
 
+        ASTKind kind() const {
+            return kind_;
+        }
+
         /** Returns the backend type of the AST expression.
 
             After a successful type checking this must never be nullptr.
@@ -33,6 +84,12 @@ namespace tiny {
             return l_;
         }
 
+        /** Moves the location of the node by given number of bytes. Used by the incremental parser when the text before the node has been edited.
+         */
+        void shiftLocation(int64_t delta) {
+            l_ = SourceLocation{l_.fileId(), static_cast<uint32_t>(l_.offset() + delta)};
+        }
+
         /** Sets the type for the expression in the AST node. 
          
             The type must *not* be nullptr. Setting type twice is an error unless the type is identical.
@@ -63,7 +120,8 @@ namespace tiny {
 
         friend class ASTVisitor;
 
-        AST(Token const & t):
+        AST(Token const & t, ASTKind kind):
+            kind_{kind},
             l_{t.location()} {
         }
 
@@ -72,6 +130,7 @@ namespace tiny {
         virtual void accept(ASTVisitor * v) = 0;
 
     private:
+        ASTKind kind_;
         SourceLocation l_;
 
     };
@@ -85,13 +144,17 @@ namespace tiny {
     /** Special AST node representing the whole program. 
      
         Comprises of a list of elements, which can be either variable or type declarations or functions. We could have used ASTBlock for those purposes, but having a dedicated AST simplifies the further steps such as typechecking and translation. 
+
+        The program is the only node allocated on its own, it owns the arena in which all other nodes of the tree, and their lists of children, are allocated. Nodes refer to their children by plain pointers and are never destroyed one by one, deleting the program releases the whole tree at once by freeing the arena's blocks.
     */
     class ASTProgram : public AST {
     public:
-        std::vector<std::unique_ptr<AST>> statements;
+        Arena arena;
+        ASTList<AST *> statements;
 
         ASTProgram(Token const & t):
-            AST{t} {
+            AST{t, ASTKind::Program},
+            statements{arena} {
         }
 
         void print(colors::ColorPrinter & p) const override {
@@ -120,10 +183,17 @@ namespace tiny {
         int64_t value;
 
         ASTInteger(Token const & t):
-            AST{t},
+            AST{t, ASTKind::Integer},
             value{t.valueInt()} {
         }
 
+        /** Creates the literal with given value, the token only provides the location. Used when the tree is loaded instead of parsed, see ASTReader.
+         */
+        ASTInteger(Token const & t, int64_t value):
+            AST{t, ASTKind::Integer},
+            value{value} {
+        }
+
         void print(colors::ColorPrinter & p) const override {
             using namespace colors;
             if (Options::rawAST)
@@ -143,10 +213,15 @@ namespace tiny {
         double value;
 
         ASTDouble(Token const & t):
-            AST{t},
+            AST{t, ASTKind::Double},
             value{t.valueDouble()} {
         }
 
+        ASTDouble(Token const & t, double value):
+            AST{t, ASTKind::Double},
+            value{value} {
+        }
+
         void print(colors::ColorPrinter & p) const override {
             p << value;
         }
@@ -162,7 +237,7 @@ namespace tiny {
         char value;
 
         ASTChar(Token const & t):
-            AST{t} {
+            AST{t, ASTKind::Char} {
             std::string const & s{t.valueString()};
             if (t == Token::Kind::StringDoubleQuoted)
                 throw ParserError{STR("Expected character (single quote), but string \"" << s << "\" (double quote) found"), t.location()};
@@ -171,6 +246,11 @@ namespace tiny {
             value = s[0];
         }
 
+        ASTChar(Token const & t, char value):
+            AST{t, ASTKind::Char},
+            value{value} {
+        }
+
         void print(colors::ColorPrinter & p) const override {
             p << value;
         }
@@ -184,14 +264,19 @@ namespace tiny {
 
     class ASTString : public AST {
     public:
-        std::string value;
+        std::string_view value;
 
-        ASTString(Token const & t):
-            AST{t} {
+        ASTString(Token const & t, Arena & arena):
+            AST{t, ASTKind::String} {
             std::string const & s{t.valueString()};
             if (t == Token::Kind::StringSingleQuoted)
                 throw ParserError{STR("Expected string (double quote), but character '" << s << "' (single quote) found"), t.location()};
-            value = s;
+            value = arena.copy(s);
+        }
+
+        ASTString(Token const & t, std::string_view value, Arena & arena):
+            AST{t, ASTKind::String},
+            value{arena.copy(value)} {
         }
 
         void print(colors::ColorPrinter & p) const override;
@@ -207,7 +292,7 @@ namespace tiny {
         Symbol name;
 
         ASTIdentifier(Token const & t):
-            AST{t},
+            AST{t, ASTKind::Identifier},
             name{t.valueSymbol()} {
         }
 
@@ -239,8 +324,8 @@ namespace tiny {
         }
 
     protected:
-        ASTType(Token const & t):
-            AST{t} {
+        ASTType(Token const & t, ASTKind kind):
+            AST{t, kind} {
         }
 
     protected:
@@ -257,11 +342,11 @@ namespace tiny {
 
     class ASTPointerType : public ASTType {
     public:
-        std::unique_ptr<ASTType> base;
+        ASTType * base = nullptr;
 
-        ASTPointerType(Token const & t, std::unique_ptr<ASTType> base):
-            ASTType{t},
-            base{std::move(base)} {
+        ASTPointerType(Token const & t, ASTType * base):
+            ASTType{t, ASTKind::PointerType},
+            base{base} {
         }
 
         void print(colors::ColorPrinter & p) const override;
@@ -269,7 +354,7 @@ namespace tiny {
     protected:
 
         void buildStringRepresentation(std::ostream & s) const override {
-            toString(base.get(), s);
+            toString(base, s);
             s << "*";
         };
 
@@ -279,13 +364,13 @@ namespace tiny {
 
     class ASTArrayType : public ASTType {
     public:
-        std::unique_ptr<ASTType> base;
-        std::unique_ptr<AST> size;
+        ASTType * base = nullptr;
+        AST * size = nullptr;
 
-        ASTArrayType(Token const & t, std::unique_ptr<ASTType> base, std::unique_ptr<AST> size):
-            ASTType{t},
-            base{std::move(base)},
-            size{std::move(size)} {
+        ASTArrayType(Token const & t, ASTType * base, AST * size):
+            ASTType{t, ASTKind::ArrayType},
+            base{base},
+            size{size} {
         }
 
         void print(colors::ColorPrinter & p) const override;
@@ -293,7 +378,7 @@ namespace tiny {
     protected:
 
         void buildStringRepresentation(std::ostream & s) const override {
-            toString(base.get(), s);
+            toString(base, s);
             s << "[]";
         };
 
@@ -306,7 +391,7 @@ namespace tiny {
         Symbol name;
 
         ASTNamedType(Token const & t) :
-            ASTType{t},
+            ASTType{t, ASTKind::NamedType},
             name{t.valueSymbol()} {
         }
 
@@ -325,10 +410,11 @@ namespace tiny {
     // comma separated, single line
     class ASTSequence : public AST {
     public:
-        std::vector<std::unique_ptr<AST>> body;
+        ASTList<AST *> body;
 
-        ASTSequence(Token const & t):
-            AST{t} {
+        ASTSequence(Token const & t, Arena & arena):
+            AST{t, ASTKind::Sequence},
+            body{arena} {
         }
 
         /** The result of sequence has address if its last element has address as the last element is what is returned.
@@ -343,6 +429,11 @@ namespace tiny {
 
     protected:
 
+        ASTSequence(Token const & t, Arena & arena, ASTKind kind):
+            AST{t, kind},
+            body{arena} {
+        }
+
         void accept(ASTVisitor * v) override;
 
     };
@@ -350,8 +441,8 @@ namespace tiny {
     // new line separated with {}
     class ASTBlock : public ASTSequence {
     public:
-        ASTBlock(Token const & t):
-            ASTSequence{t} {
+        ASTBlock(Token const & t, Arena & arena):
+            ASTSequence{t, arena, ASTKind::Block} {
         }
 
         void print(colors::ColorPrinter & p) const override;
@@ -364,18 +455,18 @@ namespace tiny {
 
     class ASTVarDecl : public AST {
     public:
-        std::unique_ptr<ASTType> varType;
-        std::unique_ptr<ASTIdentifier> name;
-        std::unique_ptr<AST> value;
+        ASTType * varType = nullptr;
+        ASTIdentifier * name = nullptr;
+        AST * value = nullptr;
 
-        ASTVarDecl(Token const & t, std::unique_ptr<ASTType> varType):
-            AST{t},
-            varType{std::move(varType)} {
+        ASTVarDecl(Token const & t, ASTType * varType):
+            AST{t, ASTKind::VarDecl},
+            varType{varType} {
         }
 
         void print(colors::ColorPrinter & p) const override {
             p << (*varType) << " " << (*name);
-            if (value.get() != nullptr)
+            if (value != nullptr)
                 p << p.symbol << " = " << (*value);
         }
 
@@ -388,22 +479,26 @@ namespace tiny {
 
     class ASTFunDecl : public AST {
     public:
-        std::unique_ptr<ASTType> returnType;
+        ASTType * returnType = nullptr;
         Symbol name;
-        std::vector<std::pair<std::unique_ptr<ASTType>, std::unique_ptr<ASTIdentifier>>> args;
-        std::unique_ptr<AST> body;
+        ASTList<std::pair<ASTType *, ASTIdentifier *>> args;
+        AST * body = nullptr;
+        /** Index of the token that starts the body if the parser skipped it, see LazyParser. 0 once the body is parsed, or if there is none.
+         */
+        size_t lazyBody = 0;
 
-        ASTFunDecl(Token const & t, std::unique_ptr<ASTType> type):
-            AST{t},
-            returnType{std::move(type)},
-            name{t.valueSymbol()} {
+        ASTFunDecl(Token const & t, ASTType * type, Arena & arena):
+            AST{t, ASTKind::FunDecl},
+            returnType{type},
+            name{t.valueSymbol()},
+            args{arena} {
         }
 
         void print(colors::ColorPrinter & p) const override {
             using namespace colors;
             if (Options::rawAST) {
                 p << SYMBOL("(") << KEYWORD("ASTBlock") << INDENT;
-                p << NEWLINE << "name" << SYMBOL(": ") << IDENT(name.name());
+                p << NEWLINE << "name" << SYMBOL(": ") << name;
                 p << NEWLINE << "returnType" << SYMBOL(": ") << (*returnType);
                 p << NEWLINE << "args" << SYMBOL(": ") << INDENT;
                 p << DEDENT;
@@ -416,7 +511,11 @@ namespace tiny {
                     while (++i != args.end())
                         p << p.symbol << ", " << *(i->first) << " " << *(i->second);
                 }
-                p << p.symbol << ")" << (*body);
+                p << p.symbol << ")";
+                if (body != nullptr)
+                    p << (*body);
+                else
+                    p << p.symbol << ";";
             }
         }
 
@@ -430,15 +529,16 @@ namespace tiny {
     class ASTStructDecl : public AST {
     public:
         Symbol name;
-        std::vector<std::pair<std::unique_ptr<ASTIdentifier>, std::unique_ptr<ASTType>>> fields;
+        ASTList<std::pair<ASTIdentifier *, ASTType *>> fields;
 
         /** If true the struct has also field definitions. Extra flag is necessary because empty fields can also mean an empty struct.
          */
         bool isDefinition = false;
 
-        ASTStructDecl(Token const & t, Symbol name):
-            AST{t},
-            name{name} {
+        ASTStructDecl(Token const & t, Symbol name, Arena & arena):
+            AST{t, ASTKind::StructDecl},
+            name{name},
+            fields{arena} {
         }
 
         void print(colors::ColorPrinter & p) const override;
@@ -451,14 +551,15 @@ namespace tiny {
 
     class ASTFunPtrDecl : public AST {
     public:
-        std::unique_ptr<ASTIdentifier> name;
-        std::vector<std::unique_ptr<ASTType>> args;
-        std::unique_ptr<ASTType> returnType;
+        ASTIdentifier * name = nullptr;
+        ASTList<ASTType *> args;
+        ASTType * returnType = nullptr;
 
-        ASTFunPtrDecl(Token const & t, std::unique_ptr<ASTIdentifier> name, std::unique_ptr<ASTType> returnType):
-            AST{t},
-            name{std::move(name)},
-            returnType{std::move(returnType)} {
+        ASTFunPtrDecl(Token const & t, ASTIdentifier * name, ASTType * returnType, Arena & arena):
+            AST{t, ASTKind::FunPtrDecl},
+            name{name},
+            args{arena},
+            returnType{returnType} {
         }
 
         void print(colors::ColorPrinter & p) const override {
@@ -480,17 +581,17 @@ namespace tiny {
 
     class ASTIf : public AST {
     public:
-        std::unique_ptr<AST> cond;
-        std::unique_ptr<AST> trueCase;
-        std::unique_ptr<AST> falseCase;
+        AST * cond = nullptr;
+        AST * trueCase = nullptr;
+        AST * falseCase = nullptr;
 
         ASTIf(Token const & t):
-            AST{t} {
+            AST{t, ASTKind::If} {
         }
 
         void print(colors::ColorPrinter & p) const override {
             p << p.keyword << "if " << p.symbol << "(" << *cond << p.symbol << ")" << *trueCase;
-            if (falseCase.get() != nullptr)
+            if (falseCase != nullptr)
                 p << p.keyword << "else" << *falseCase;
         }
 
@@ -502,13 +603,14 @@ namespace tiny {
 
     class ASTSwitch : public AST {
     public:
-        std::unique_ptr<AST> cond;
+        AST * cond = nullptr;
         // shorthand for the default case in the list of cases so that we keep order
-        AST * defaultCase;
-        std::vector<std::pair<int, std::unique_ptr<AST>>> cases;
+        AST * defaultCase = nullptr;
+        ASTList<std::pair<int64_t, AST *>> cases;
 
-        ASTSwitch(Token const & t):
-            AST{t} {
+        ASTSwitch(Token const & t, Arena & arena):
+            AST{t, ASTKind::Switch},
+            cases{arena} {
         }
 
         void print(colors::ColorPrinter & p) const override;
@@ -521,11 +623,11 @@ namespace tiny {
 
     class ASTWhile : public AST {
     public:
-        std::unique_ptr<AST> cond;
-        std::unique_ptr<AST> body;
+        AST * cond = nullptr;
+        AST * body = nullptr;
 
         ASTWhile(Token const & t):
-            AST{t} {
+            AST{t, ASTKind::While} {
         }
 
         void print(colors::ColorPrinter & p) const override {
@@ -540,11 +642,11 @@ namespace tiny {
 
     class ASTDoWhile : public AST {
     public:
-        std::unique_ptr<AST> body;
-        std::unique_ptr<AST> cond;
+        AST * body = nullptr;
+        AST * cond = nullptr;
 
         ASTDoWhile(Token const & t):
-            AST{t} {
+            AST{t, ASTKind::DoWhile} {
         }
 
         void print(colors::ColorPrinter & p) const override {
@@ -559,24 +661,24 @@ namespace tiny {
 
     class ASTFor : public AST {
     public:
-        std::unique_ptr<AST> init;
-        std::unique_ptr<AST> cond;
-        std::unique_ptr<AST> increment;
-        std::unique_ptr<AST> body;
+        AST * init = nullptr;
+        AST * cond = nullptr;
+        AST * increment = nullptr;
+        AST * body = nullptr;
 
         ASTFor(Token const & t):
-            AST{t} {
+            AST{t, ASTKind::For} {
         }
 
         void print(colors::ColorPrinter & p) const override {
             p << p.keyword << "for " << p.symbol << "(";
-            if (init.get() != nullptr)
+            if (init != nullptr)
                 p << *init;
             p << p.symbol << ";";
-            if (cond.get() != nullptr)
+            if (cond != nullptr)
                 p << *cond;
             p << p.symbol << ";";
-            if (increment.get() != nullptr)
+            if (increment != nullptr)
                 p << *increment;
             p << p.symbol << ")";
             p << *body;
@@ -591,7 +693,7 @@ namespace tiny {
     class ASTBreak : public AST {
     public:
         ASTBreak(Token const & t):
-            AST{t} {
+            AST{t, ASTKind::Break} {
         }
 
         void print(colors::ColorPrinter & p) const override {
@@ -608,7 +710,7 @@ namespace tiny {
     class ASTContinue : public AST {
     public:
         ASTContinue(Token const & t):
-            AST{t} {
+            AST{t, ASTKind::Continue} {
         }
 
         void print(colors::ColorPrinter & p) const override {
@@ -623,14 +725,14 @@ namespace tiny {
 
     class ASTReturn : public AST {
     public:
-        std::unique_ptr<AST> value;
+        AST * value = nullptr;
         ASTReturn(Token const & t):
-            AST{t} {
+            AST{t, ASTKind::Return} {
         }
 
         void print(colors::ColorPrinter & p) const override {
             p << p.keyword << "return";
-            if (value.get() != nullptr)
+            if (value != nullptr)
                 p << " " << *value;
         }
 
@@ -643,14 +745,14 @@ namespace tiny {
     class ASTBinaryOp : public AST {
     public:
         Symbol op;
-        std::unique_ptr<AST> left;
-        std::unique_ptr<AST> right;
+        AST * left = nullptr;
+        AST * right = nullptr;
 
-        ASTBinaryOp(Token const & t, std::unique_ptr<AST> left, std::unique_ptr<AST> right):
-            AST{t},
+        ASTBinaryOp(Token const & t, AST * left, AST * right):
+            AST{t, ASTKind::BinaryOp},
             op{t.valueSymbol()},
-            left{std::move(left)},
-            right{std::move(right)} {
+            left{left},
+            right{right} {
         }
 
         /** Whether a result of binary operator has an address depends on the operation and operands.
@@ -670,14 +772,14 @@ namespace tiny {
     class ASTAssignment : public AST {
     public:
         Symbol op;
-        std::unique_ptr<AST> lvalue;
-        std::unique_ptr<AST> value;
+        AST * lvalue = nullptr;
+        AST * value = nullptr;
 
-        ASTAssignment(Token const & t, std::unique_ptr<AST> lvalue, std::unique_ptr<AST> value):
-            AST{t},
+        ASTAssignment(Token const & t, AST * lvalue, AST * value):
+            AST{t, ASTKind::Assignment},
             op{t.valueSymbol()},
-            lvalue{std::move(lvalue)},
-            value{std::move(value)} {
+            lvalue{lvalue},
+            value{value} {
         }
 
         /** Assignment result always has address of the lvalue it assigns to.
@@ -697,12 +799,12 @@ namespace tiny {
     class ASTUnaryOp : public AST {
     public:
         Symbol op;
-        std::unique_ptr<AST> arg;
+        AST * arg = nullptr;
 
-        ASTUnaryOp(Token const & t, std::unique_ptr<AST> arg):
-            AST{t},
+        ASTUnaryOp(Token const & t, AST * arg):
+            AST{t, ASTKind::UnaryOp},
             op{t.valueSymbol()},
-            arg{std::move(arg)} {
+            arg{arg} {
         }
 
         /** Whether a result of unary operator has an address depends on the operation and operands.
@@ -726,12 +828,12 @@ namespace tiny {
     class ASTUnaryPostOp : public AST {
     public:
         Symbol op;
-        std::unique_ptr<AST> arg;
+        AST * arg = nullptr;
 
-        ASTUnaryPostOp(Token const & t, std::unique_ptr<AST> arg):
-            AST{t},
+        ASTUnaryPostOp(Token const & t, AST * arg):
+            AST{t, ASTKind::UnaryPostOp},
             op{t.valueSymbol()},
-            arg{std::move(arg)} {
+            arg{arg} {
         }
 
         /** As the result of post-increment or decrement is the previous value, it is now a temporary and therefore does not have an address.
@@ -752,11 +854,11 @@ namespace tiny {
 
     class ASTAddress : public AST {
     public:
-        std::unique_ptr<AST> target;
+        AST * target = nullptr;
 
-        ASTAddress(Token const & t, std::unique_ptr<AST> target):
-            AST{t},
-            target{std::move(target)} {
+        ASTAddress(Token const & t, AST * target):
+            AST{t, ASTKind::Address},
+            target{target} {
         }
 
         void print(colors::ColorPrinter & p) const override {
@@ -771,11 +873,11 @@ namespace tiny {
 
     class ASTDeref : public AST {
     public:
-        std::unique_ptr<AST> target;
+        AST * target = nullptr;
 
-        ASTDeref(Token const & t, std::unique_ptr<AST> target):
-            AST{t},
-            target{std::move(target)} {
+        ASTDeref(Token const & t, AST * target):
+            AST{t, ASTKind::Deref},
+            target{target} {
         }
 
         /** The dereferenced item always has address as it was obtained by following a pointer in the first place.
@@ -796,13 +898,13 @@ namespace tiny {
 
     class ASTIndex : public AST {
     public:
-        std::unique_ptr<AST> base;
-        std::unique_ptr<AST> index;
+        AST * base = nullptr;
+        AST * index = nullptr;
 
-        ASTIndex(Token const & t, std::unique_ptr<AST> base, std::unique_ptr<AST> index):
-            AST{t},
-            base{std::move(base)},
-            index{std::move(index)} {
+        ASTIndex(Token const & t, AST * base, AST * index):
+            AST{t, ASTKind::Index},
+            base{base},
+            index{index} {
         }
 
         /** If the base has address, then its element must have address too.
@@ -823,12 +925,12 @@ namespace tiny {
 
     class ASTMember : public AST {
     public:
-        std::unique_ptr<AST> base;
+        AST * base = nullptr;
         Symbol member;
 
-        ASTMember(Token const & t, std::unique_ptr<AST> base, Symbol member):
-            AST{t},
-            base{std::move(base)},
+        ASTMember(Token const & t, AST * base, Symbol member):
+            AST{t, ASTKind::Member},
+            base{base},
             member(member) {
         }
 
@@ -850,12 +952,12 @@ namespace tiny {
 
     class ASTMemberPtr : public AST {
     public:
-        std::unique_ptr<AST> base;
+        AST * base = nullptr;
         Symbol member;
 
-        ASTMemberPtr(Token const & t, std::unique_ptr<AST> base, Symbol member):
-            AST{t},
-            base{std::move(base)},
+        ASTMemberPtr(Token const & t, AST * base, Symbol member):
+            AST{t, ASTKind::MemberPtr},
+            base{base},
             member(member) {
         }
 
@@ -875,12 +977,13 @@ namespace tiny {
 
     class ASTCall : public AST {
     public:
-        std::unique_ptr<AST> function;
-        std::vector<std::unique_ptr<AST>> args;
+        AST * function = nullptr;
+        ASTList<AST *> args;
 
-        ASTCall(Token const & t, std::unique_ptr<AST> function):
-            AST{t},
-            function{std::move(function)} {
+        ASTCall(Token const & t, AST * function, Arena & arena):
+            AST{t, ASTKind::Call},
+            function{function},
+            args{arena} {
         }
 
         void print(colors::ColorPrinter & p) const override {
@@ -902,13 +1005,13 @@ namespace tiny {
 
     class ASTCast : public AST {
     public:
-        std::unique_ptr<AST> value;
-        std::unique_ptr<ASTType> type;
+        AST * value = nullptr;
+        ASTType * type = nullptr;
 
-        ASTCast(Token const & t, std::unique_ptr<AST> value, std::unique_ptr<ASTType> type):
-            AST{t},
-            value{std::move(value)},
-            type{std::move(type)} {
+        ASTCast(Token const & t, AST * value, ASTType * type):
+            AST{t, ASTKind::Cast},
+            value{value},
+            type{type} {
         }
 
         /** Casts can only appear on right hand side of assignments.
@@ -927,11 +1030,11 @@ namespace tiny {
 
     class ASTPrint : public AST {
     public:
-        std::unique_ptr<AST> value;
+        AST * value = nullptr;
 
-        ASTPrint(Token const & t, std::unique_ptr<AST> value):
-            AST{t},
-            value{std::move(value)}{
+        ASTPrint(Token const & t, AST * value):
+            AST{t, ASTKind::Print},
+            value{value}{
         }
 
         /** Writes can only appear on right hand side of assignments.
@@ -951,7 +1054,7 @@ namespace tiny {
     class ASTScan : public AST {
     public:
         ASTScan(Token const & t):
-            AST{t}{
+            AST{t, ASTKind::Scan}{
         }
 
         /** Reads can only appear on right hand side of assignments.
@@ -1016,10 +1119,6 @@ namespace tiny {
             child->accept(this);
         }
 
-        void visitChild(std::unique_ptr<AST> const & child) {
-            child->accept(this);
-        }
-
     }; // tinyc::ASTVisitor
 
     inline void AST::accept(ASTVisitor * v) { v->visit(this); }
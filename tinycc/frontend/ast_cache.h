@@ -0,0 +1,836 @@
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <unordered_map>
+
+#include "common/mapped_file.h"
+#include "common/source_file.h"
+#include "common/types.h"
+#include "ast.h"
+
+namespace tiny {
+
+    /** Binary format of a parsed and typechecked program.
+
+        The format caches the work of the front end, so that an unchanged file is neither lexed, nor parsed, nor typechecked again. A cache file consists of
+
+            header          magic, version, flags and the size and hash of the source
+            symbols         names of all symbols used by the tree
+            types           all types of the nodes, a type's components always precede it
+            struct fields   fields of the struct types and their access counts
+            nodes           the tree in pre-order
+
+        Symbols and types are referred to by their index in the tables. Every node starts with its kind, its offset in the source and its type, followed by its own fields and its children. Numbers are stored in the byte order of the machine, a cache is not meant to be moved to a different one.
+     */
+    namespace ast_cache {
+
+        constexpr char Magic[4] = {'t', 'A', 'S', 'T'};
+        constexpr uint32_t Version = 2;
+
+        /** Kind byte of an absent child.
+         */
+        constexpr uint8_t NoNode = 0xff;
+
+        /** Type index of nodes without a type, all other indices are shifted by one.
+         */
+        constexpr uint32_t NoType = 0;
+
+        enum class TypeTag : uint8_t {
+            Simple,
+            Struct,
+            Pointer,
+            Function,
+        };
+
+        struct Header {
+            char magic[4];
+            uint32_t version;
+            uint32_t flags;
+            uint32_t reserved;
+            uint64_t sourceSize;
+            uint64_t sourceHash;
+        };
+
+        /** 64-bit FNV-1a hash of the source. Unlike std::hash its value is specified, so it does not change between standard libraries or their versions.
+         */
+        inline uint64_t HashSource(std::string_view source) {
+            uint64_t hash = 0xcbf29ce484222325;
+            for (char c : source)
+                hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3;
+            return hash;
+        }
+
+    } // namespace tiny::ast_cache
+
+    /** Serializes a typechecked program into the cache format.
+     */
+    class ASTWriter : public ASTVisitor {
+    public:
+
+        /** Returns the serialized program. Flags are stored in the header, a cache is only loaded with the flags it was written with.
+         */
+        static std::string Write(ASTProgram * program, std::string_view source, uint32_t flags) {
+            ASTWriter w;
+            w.node(program);
+            std::string result;
+            ast_cache::Header h{};
+            std::memcpy(h.magic, ast_cache::Magic, sizeof(h.magic));
+            h.version = ast_cache::Version;
+            h.flags = flags;
+            h.sourceSize = source.size();
+            h.sourceHash = ast_cache::HashSource(source);
+            Append(result, h);
+            Append(result, static_cast<uint32_t>(w.symbols_.size()));
+            for (Symbol s : w.symbols_) {
+                Append(result, static_cast<uint32_t>(s.name().size()));
+                result.append(s.name());
+            }
+            Append(result, static_cast<uint32_t>(w.typeIndex_.size()));
+            result.append(w.types_);
+            Append(result, static_cast<uint32_t>(w.structs_.size()));
+            for (StructType * st : w.structs_) {
+                Append(result, w.typeIndex_[st]);
+                Append(result, static_cast<uint32_t>(st->fields().size()));
+                for (auto & [name, type] : st->fields()) {
+                    Append(result, w.symbol(name));
+                    Append(result, w.type(type));
+                    Append(result, st->isFullyDefined() ? st->accesses(name) : 0);
+                }
+            }
+            result.append(w.nodes_);
+            return result;
+        }
+
+        void visit(ASTProgram * ast) override {
+            list(ast->statements);
+        }
+
+        void visit(ASTInteger * ast) override {
+            Append(nodes_, ast->value);
+        }
+
+        void visit(ASTDouble * ast) override {
+            Append(nodes_, ast->value);
+        }
+
+        void visit(ASTChar * ast) override {
+            Append(nodes_, ast->value);
+        }
+
+        void visit(ASTString * ast) override {
+            Append(nodes_, static_cast<uint32_t>(ast->value.size()));
+            nodes_.append(ast->value);
+        }
+
+        void visit(ASTIdentifier * ast) override {
+            Append(nodes_, symbol(ast->name));
+        }
+
+        void visit(ASTPointerType * ast) override {
+            node(ast->base);
+        }
+
+        void visit(ASTArrayType * ast) override {
+            node(ast->base);
+            node(ast->size);
+        }
+
+        void visit(ASTNamedType * ast) override {
+            Append(nodes_, symbol(ast->name));
+        }
+
+        void visit(ASTSequence * ast) override {
+            list(ast->body);
+        }
+
+        void visit(ASTBlock * ast) override {
+            list(ast->body);
+        }
+
+        void visit(ASTVarDecl * ast) override {
+            node(ast->varType);
+            node(ast->name);
+            node(ast->value);
+        }
+
+        void visit(ASTFunDecl * ast) override {
+            Append(nodes_, symbol(ast->name));
+            node(ast->returnType);
+            Append(nodes_, static_cast<uint32_t>(ast->args.size()));
+            for (auto & [type, name] : ast->args) {
+                node(type);
+                node(name);
+            }
+            node(ast->body);
+        }
+
+        void visit(ASTStructDecl * ast) override {
+            Append(nodes_, symbol(ast->name));
+            Append(nodes_, static_cast<uint8_t>(ast->isDefinition));
+            Append(nodes_, static_cast<uint32_t>(ast->fields.size()));
+            for (auto & [name, type] : ast->fields) {
+                node(name);
+                node(type);
+            }
+        }
+
+        void visit(ASTFunPtrDecl * ast) override {
+            node(ast->name);
+            node(ast->returnType);
+            list(ast->args);
+        }
+
+        void visit(ASTIf * ast) override {
+            node(ast->cond);
+            node(ast->trueCase);
+            node(ast->falseCase);
+        }
+
+        /** The default case is one of the cases, only its index is stored.
+         */
+        void visit(ASTSwitch * ast) override {
+            node(ast->cond);
+            uint32_t defaultCase = static_cast<uint32_t>(ast->cases.size());
+            Append(nodes_, static_cast<uint32_t>(ast->cases.size()));
+            for (size_t i = 0, e = ast->cases.size(); i != e; ++i) {
+                if (ast->cases[i].second == ast->defaultCase)
+                    defaultCase = static_cast<uint32_t>(i);
+                Append(nodes_, ast->cases[i].first);
+                node(ast->cases[i].second);
+            }
+            Append(nodes_, defaultCase);
+        }
+
+        void visit(ASTWhile * ast) override {
+            node(ast->cond);
+            node(ast->body);
+        }
+
+        void visit(ASTDoWhile * ast) override {
+            node(ast->body);
+            node(ast->cond);
+        }
+
+        void visit(ASTFor * ast) override {
+            node(ast->init);
+            node(ast->cond);
+            node(ast->increment);
+            node(ast->body);
+        }
+
+        void visit(ASTBreak *) override { }
+
+        void visit(ASTContinue *) override { }
+
+        void visit(ASTReturn * ast) override {
+            node(ast->value);
+        }
+
+        void visit(ASTBinaryOp * ast) override {
+            Append(nodes_, symbol(ast->op));
+            node(ast->left);
+            node(ast->right);
+        }
+
+        void visit(ASTAssignment * ast) override {
+            Append(nodes_, symbol(ast->op));
+            node(ast->lvalue);
+            node(ast->value);
+        }
+
+        void visit(ASTUnaryOp * ast) override {
+            Append(nodes_, symbol(ast->op));
+            node(ast->arg);
+        }
+
+        void visit(ASTUnaryPostOp * ast) override {
+            Append(nodes_, symbol(ast->op));
+            node(ast->arg);
+        }
+
+        void visit(ASTAddress * ast) override {
+            node(ast->target);
+        }
+
+        void visit(ASTDeref * ast) override {
+            node(ast->target);
+        }
+
+        void visit(ASTIndex * ast) override {
+            node(ast->base);
+            node(ast->index);
+        }
+
+        void visit(ASTMember * ast) override {
+            node(ast->base);
+            Append(nodes_, symbol(ast->member));
+        }
+
+        void visit(ASTMemberPtr * ast) override {
+            node(ast->base);
+            Append(nodes_, symbol(ast->member));
+        }
+
+        void visit(ASTCall * ast) override {
+            node(ast->function);
+            list(ast->args);
+        }
+
+        void visit(ASTCast * ast) override {
+            node(ast->value);
+            node(ast->type);
+        }
+
+        void visit(ASTPrint * ast) override {
+            node(ast->value);
+        }
+
+        void visit(ASTScan *) override { }
+
+    private:
+
+        template<typename T>
+        static void Append(std::string & buffer, T value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            buffer.append(reinterpret_cast<char const *>(& value), sizeof(T));
+        }
+
+        void node(AST * ast) {
+            if (ast == nullptr) {
+                Append(nodes_, ast_cache::NoNode);
+                return;
+            }
+            Append(nodes_, static_cast<uint8_t>(ast->kind()));
+            Append(nodes_, ast->location().offset());
+            Append(nodes_, type(ast->type()));
+            visitChild(ast);
+        }
+
+        template<typename T>
+        void list(ASTList<T *> const & nodes) {
+            Append(nodes_, static_cast<uint32_t>(nodes.size()));
+            for (T * i : nodes)
+                node(i);
+        }
+
+        uint32_t symbol(Symbol s) {
+            auto i = symbolIndex_.find(s);
+            if (i != symbolIndex_.end())
+                return i->second;
+            symbols_.push_back(s);
+            return symbolIndex_[s] = static_cast<uint32_t>(symbols_.size() - 1);
+        }
+
+        /** Returns the index of the type, appending it and its components to the table if not there yet. Struct types are appended before their fields so that recursive structs terminate.
+         */
+        uint32_t type(Type * t) {
+            if (t == nullptr)
+                return ast_cache::NoType;
+            auto i = typeIndex_.find(t);
+            if (i != typeIndex_.end())
+                return i->second;
+            std::string record;
+            if (auto st = dynamic_cast<StructType *>(t)) {
+                Append(record, ast_cache::TypeTag::Struct);
+                Append(record, symbol(st->name()));
+                Append(record, static_cast<uint8_t>(st->isFullyDefined()));
+                uint32_t result = add(t, record);
+                structs_.push_back(st);
+                for (auto & [name, type] : st->fields()) {
+                    symbol(name);
+                    this->type(type);
+                }
+                return result;
+            } else if (auto pt = dynamic_cast<PointerType *>(t)) {
+                uint32_t base = type(pt->base());
+                Append(record, ast_cache::TypeTag::Pointer);
+                Append(record, base);
+            } else if (auto ft = dynamic_cast<FunctionType *>(t)) {
+                std::vector<uint32_t> signature{type(ft->returnType())};
+                for (size_t i = 0, e = ft->numArgs(); i != e; ++i)
+                    signature.push_back(type(ft->arg(i)));
+                Append(record, ast_cache::TypeTag::Function);
+                Append(record, static_cast<uint32_t>(signature.size()));
+                for (uint32_t i : signature)
+                    Append(record, i);
+            } else {
+                Append(record, ast_cache::TypeTag::Simple);
+                Append(record, symbol(dynamic_cast<SimpleType *>(t)->name()));
+            }
+            return add(t, record);
+        }
+
+        uint32_t add(Type * t, std::string const & record) {
+            types_.append(record);
+            return typeIndex_[t] = static_cast<uint32_t>(typeIndex_.size()) + 1;
+        }
+
+        std::vector<Symbol> symbols_;
+        std::unordered_map<Symbol, uint32_t> symbolIndex_;
+        std::unordered_map<Type *, uint32_t> typeIndex_;
+        std::vector<StructType *> structs_;
+        std::string types_;
+        std::string nodes_;
+
+    }; // tiny::ASTWriter
+
+    /** Rebuilds a program from its serialized form.
+
+        Symbols are interned and types created again in the global type tables, which are reset first, just as the typechecker would leave them. The nodes are allocated in the arena of a new program and get their types without being typechecked. Throws std::runtime_error if the data is malformed.
+     */
+    class ASTReader {
+    public:
+
+        /** Returns the program, or nullptr if the data was written for a different source, or with different flags.
+         */
+        static std::unique_ptr<ASTProgram> Read(std::string_view data, SourceFile const & source, uint32_t flags) {
+            ASTReader r{data, source.id()};
+            ast_cache::Header h = r.read<ast_cache::Header>();
+            if (std::memcmp(h.magic, ast_cache::Magic, sizeof(h.magic)) != 0 || h.version != ast_cache::Version || h.flags != flags)
+                return nullptr;
+            if (h.sourceSize != source.size() || h.sourceHash != ast_cache::HashSource(source.text()))
+                return nullptr;
+            r.readSymbols();
+            r.readTypes();
+            if (r.read<uint8_t>() != static_cast<uint8_t>(ASTKind::Program))
+                r.error();
+            Token start = r.token(r.read<uint32_t>());
+            std::unique_ptr<ASTProgram> result{new ASTProgram{start}};
+            r.arena_ = & result->arena;
+            r.setType(result.get(), r.read<uint32_t>());
+            r.list(result->statements);
+            if (r.pos_ != data.size())
+                r.error();
+            return result;
+        }
+
+    private:
+
+        ASTReader(std::string_view data, uint32_t fileId):
+            data_{data},
+            fileId_{fileId} {
+        }
+
+        [[noreturn]] void error() {
+            throw std::runtime_error{"Malformed AST cache"};
+        }
+
+        template<typename T>
+        T read() {
+            static_assert(std::is_trivially_copyable_v<T>);
+            if (data_.size() - pos_ < sizeof(T))
+                error();
+            T result;
+            std::memcpy(& result, data_.data() + pos_, sizeof(T));
+            pos_ += sizeof(T);
+            return result;
+        }
+
+        std::string_view readString() {
+            uint32_t size = read<uint32_t>();
+            if (data_.size() - pos_ < size)
+                error();
+            std::string_view result = data_.substr(pos_, size);
+            pos_ += size;
+            return result;
+        }
+
+        void readSymbols() {
+            uint32_t n = read<uint32_t>();
+            symbols_.reserve(n);
+            for (uint32_t i = 0; i < n; ++i)
+                symbols_.push_back(Symbol{readString()});
+        }
+
+        Symbol symbol() {
+            uint32_t i = read<uint32_t>();
+            if (i >= symbols_.size())
+                error();
+            return symbols_[i];
+        }
+
+        Type * type(uint32_t index) {
+            if (index == ast_cache::NoType || index > types_.size())
+                error();
+            return types_[index - 1];
+        }
+
+        /** Creates the types in the order of the table. Struct types are only declared there, their fields are added once all types exist.
+         */
+        void readTypes() {
+            Type::resetTypeInformation();
+            uint32_t n = read<uint32_t>();
+            types_.reserve(n);
+            std::unordered_map<StructType *, bool> fullyDefined;
+            for (uint32_t i = 0; i < n; ++i) {
+                switch (static_cast<ast_cache::TypeTag>(read<uint8_t>())) {
+                    case ast_cache::TypeTag::Simple: {
+                        Type * t = Type::getType(symbol());
+                        if (t == nullptr)
+                            error();
+                        types_.push_back(t);
+                        break;
+                    }
+                    case ast_cache::TypeTag::Struct: {
+                        StructType * st = Type::getOrDeclareStruct(symbol());
+                        if (st == nullptr)
+                            error();
+                        fullyDefined[st] = read<uint8_t>() != 0;
+                        types_.push_back(st);
+                        break;
+                    }
+                    case ast_cache::TypeTag::Pointer:
+                        types_.push_back(Type::getPointerTo(type(read<uint32_t>())));
+                        break;
+                    case ast_cache::TypeTag::Function: {
+                        std::vector<Type *> signature(read<uint32_t>());
+                        if (signature.empty())
+                            error();
+                        for (Type * & t : signature)
+                            t = type(read<uint32_t>());
+                        types_.push_back(Type::getFunction(signature));
+                        break;
+                    }
+                    default:
+                        error();
+                }
+            }
+            struct FieldRecord {
+                Symbol name;
+                Type * type;
+                uint32_t accesses;
+            };
+            std::unordered_map<StructType *, std::vector<FieldRecord>> fields;
+            for (uint32_t i = 0, e = read<uint32_t>(); i < e; ++i) {
+                auto st = dynamic_cast<StructType *>(type(read<uint32_t>()));
+                if (st == nullptr)
+                    error();
+                auto & f = fields[st];
+                for (uint32_t j = 0, je = read<uint32_t>(); j < je; ++j) {
+                    Symbol name = symbol();
+                    Type * t = type(read<uint32_t>());
+                    f.push_back(FieldRecord{name, t, read<uint32_t>()});
+                }
+            }
+            // a struct must be defined before the structs that contain it
+            std::function<void(StructType *)> define = [&](StructType * st) {
+                auto i = fullyDefined.find(st);
+                if (i == fullyDefined.end())
+                    return;
+                bool defined = i->second;
+                fullyDefined.erase(i);
+                for (FieldRecord & f : fields[st]) {
+                    if (auto fst = dynamic_cast<StructType *>(f.type))
+                        define(fst);
+                    if (! f.type->isFullyDefined() || ! st->addField(f.name, f.type))
+                        error();
+                }
+                if (defined) {
+                    st->markAsFullyDefined();
+                    for (FieldRecord & f : fields[st])
+                        st->countAccess(f.name, f.accesses);
+                }
+            };
+            for (Type * t : types_)
+                if (auto st = dynamic_cast<StructType *>(t))
+                    define(st);
+        }
+
+        /** Location only token for constructing the nodes.
+         */
+        Token token(uint32_t offset) {
+            return Token{Token::Kind::Identifier, SourceLocation{fileId_, offset}, 0};
+        }
+
+        Token token(uint32_t offset, Symbol symbol) {
+            return Token{symbol, SourceLocation{fileId_, offset}};
+        }
+
+        void setType(AST * ast, uint32_t index) {
+            if (index != ast_cache::NoType)
+                ast->setType(type(index));
+        }
+
+        template<typename T>
+        T * node() {
+            AST * result = node();
+            if (result == nullptr)
+                return nullptr;
+            T * t = dynamic_cast<T *>(result);
+            if (t == nullptr)
+                error();
+            return t;
+        }
+
+        template<typename T>
+        void list(ASTList<T *> & nodes) {
+            uint32_t n = read<uint32_t>();
+            for (uint32_t i = 0; i < n; ++i)
+                nodes.push_back(node<T>());
+        }
+
+        AST * node();
+
+        std::string_view data_;
+        size_t pos_ = 0;
+        uint32_t fileId_;
+        Arena * arena_ = nullptr;
+        std::vector<Symbol> symbols_;
+        std::vector<Type *> types_;
+
+    }; // tiny::ASTReader
+
+    inline AST * ASTReader::node() {
+        uint8_t kind = read<uint8_t>();
+        if (kind == ast_cache::NoNode)
+            return nullptr;
+        uint32_t offset = read<uint32_t>();
+        uint32_t type = read<uint32_t>();
+        Arena & arena = *arena_;
+        AST * result = nullptr;
+        switch (static_cast<ASTKind>(kind)) {
+            case ASTKind::Integer:
+                result = arena.make<ASTInteger>(token(offset), read<int64_t>());
+                break;
+            case ASTKind::Double:
+                result = arena.make<ASTDouble>(token(offset), read<double>());
+                break;
+            case ASTKind::Char:
+                result = arena.make<ASTChar>(token(offset), read<char>());
+                break;
+            case ASTKind::String:
+                result = arena.make<ASTString>(token(offset), readString(), arena);
+                break;
+            case ASTKind::Identifier:
+                result = arena.make<ASTIdentifier>(token(offset, symbol()));
+                break;
+            case ASTKind::PointerType:
+                result = arena.make<ASTPointerType>(token(offset), node<ASTType>());
+                break;
+            case ASTKind::ArrayType: {
+                ASTType * base = node<ASTType>();
+                result = arena.make<ASTArrayType>(token(offset), base, node());
+                break;
+            }
+            case ASTKind::NamedType:
+                result = arena.make<ASTNamedType>(token(offset, symbol()));
+                break;
+            case ASTKind::Sequence: {
+                auto n = arena.make<ASTSequence>(token(offset), arena);
+                list(n->body);
+                result = n;
+                break;
+            }
+            case ASTKind::Block: {
+                auto n = arena.make<ASTBlock>(token(offset), arena);
+                list(n->body);
+                result = n;
+                break;
+            }
+            case ASTKind::VarDecl: {
+                auto n = arena.make<ASTVarDecl>(token(offset), node<ASTType>());
+                n->name = node<ASTIdentifier>();
+                n->value = node();
+                result = n;
+                break;
+            }
+            case ASTKind::FunDecl: {
+                Token t = token(offset, symbol());
+                auto n = arena.make<ASTFunDecl>(t, node<ASTType>(), arena);
+                for (uint32_t i = 0, e = read<uint32_t>(); i < e; ++i) {
+                    ASTType * argType = node<ASTType>();
+                    n->args.push_back(std::make_pair(argType, node<ASTIdentifier>()));
+                }
+                n->body = node();
+                result = n;
+                break;
+            }
+            case ASTKind::StructDecl: {
+                auto n = arena.make<ASTStructDecl>(token(offset), symbol(), arena);
+                n->isDefinition = read<uint8_t>() != 0;
+                for (uint32_t i = 0, e = read<uint32_t>(); i < e; ++i) {
+                    ASTIdentifier * name = node<ASTIdentifier>();
+                    n->fields.push_back(std::make_pair(name, node<ASTType>()));
+                }
+                result = n;
+                break;
+            }
+            case ASTKind::FunPtrDecl: {
+                ASTIdentifier * name = node<ASTIdentifier>();
+                auto n = arena.make<ASTFunPtrDecl>(token(offset), name, node<ASTType>(), arena);
+                list(n->args);
+                // the typechecker registers the name as an alias of the function pointer type
+                if (type != ast_cache::NoType)
+                    Type::createAlias(name->name, this->type(type));
+                result = n;
+                break;
+            }
+            case ASTKind::If: {
+                auto n = arena.make<ASTIf>(token(offset));
+                n->cond = node();
+                n->trueCase = node();
+                n->falseCase = node();
+                result = n;
+                break;
+            }
+            case ASTKind::Switch: {
+                auto n = arena.make<ASTSwitch>(token(offset), arena);
+                n->cond = node();
+                for (uint32_t i = 0, e = read<uint32_t>(); i < e; ++i) {
+                    int64_t value = read<int64_t>();
+                    n->cases.push_back(std::make_pair(value, node()));
+                }
+                uint32_t defaultCase = read<uint32_t>();
+                if (defaultCase < n->cases.size())
+                    n->defaultCase = n->cases[defaultCase].second;
+                result = n;
+                break;
+            }
+            case ASTKind::While: {
+                auto n = arena.make<ASTWhile>(token(offset));
+                n->cond = node();
+                n->body = node();
+                result = n;
+                break;
+            }
+            case ASTKind::DoWhile: {
+                auto n = arena.make<ASTDoWhile>(token(offset));
+                n->body = node();
+                n->cond = node();
+                result = n;
+                break;
+            }
+            case ASTKind::For: {
+                auto n = arena.make<ASTFor>(token(offset));
+                n->init = node();
+                n->cond = node();
+                n->increment = node();
+                n->body = node();
+                result = n;
+                break;
+            }
+            case ASTKind::Break:
+                result = arena.make<ASTBreak>(token(offset));
+                break;
+            case ASTKind::Continue:
+                result = arena.make<ASTContinue>(token(offset));
+                break;
+            case ASTKind::Return: {
+                auto n = arena.make<ASTReturn>(token(offset));
+                n->value = node();
+                result = n;
+                break;
+            }
+            case ASTKind::BinaryOp: {
+                Token t = token(offset, symbol());
+                AST * left = node();
+                result = arena.make<ASTBinaryOp>(t, left, node());
+                break;
+            }
+            case ASTKind::Assignment: {
+                Token t = token(offset, symbol());
+                AST * lvalue = node();
+                result = arena.make<ASTAssignment>(t, lvalue, node());
+                break;
+            }
+            case ASTKind::UnaryOp: {
+                Token t = token(offset, symbol());
+                result = arena.make<ASTUnaryOp>(t, node());
+                break;
+            }
+            case ASTKind::UnaryPostOp: {
+                Token t = token(offset, symbol());
+                result = arena.make<ASTUnaryPostOp>(t, node());
+                break;
+            }
+            case ASTKind::Address:
+                result = arena.make<ASTAddress>(token(offset), node());
+                break;
+            case ASTKind::Deref:
+                result = arena.make<ASTDeref>(token(offset), node());
+                break;
+            case ASTKind::Index: {
+                AST * base = node();
+                result = arena.make<ASTIndex>(token(offset), base, node());
+                break;
+            }
+            case ASTKind::Member: {
+                AST * base = node();
+                result = arena.make<ASTMember>(token(offset), base, symbol());
+                break;
+            }
+            case ASTKind::MemberPtr: {
+                AST * base = node();
+                result = arena.make<ASTMemberPtr>(token(offset), base, symbol());
+                break;
+            }
+            case ASTKind::Call: {
+                auto n = arena.make<ASTCall>(token(offset), node(), arena);
+                list(n->args);
+                result = n;
+                break;
+            }
+            case ASTKind::Cast: {
+                AST * value = node();
+                result = arena.make<ASTCast>(token(offset), value, node<ASTType>());
+                break;
+            }
+            case ASTKind::Print:
+                result = arena.make<ASTPrint>(token(offset), node());
+                break;
+            case ASTKind::Scan:
+                result = arena.make<ASTScan>(token(offset));
+                break;
+            default:
+                error();
+        }
+        setType(result, type);
+        return result;
+    }
+
+    /** Cache of typechecked programs stored next to their source files.
+
+        The cache of file foo.c is foo.c.ast. It is only used if it was written for the same contents of the file and the same flags, otherwise the file must be compiled and the cache stored again.
+     */
+    class ASTCache {
+    public:
+
+        static std::string CacheFilename(SourceFile const & source) {
+            return source.filename() + ".ast";
+        }
+
+        /** Returns the cached program of the file, or nullptr if there is no usable cache.
+         */
+        static std::unique_ptr<ASTProgram> Load(SourceFile const & source, uint32_t flags) {
+            try {
+                MappedFile cache{CacheFilename(source)};
+                return ASTReader::Read(cache.text(), source, flags);
+            } catch (std::runtime_error const &) {
+                return nullptr;
+            }
+        }
+
+        /** Stores the typechecked program as the cache of the file. The cache is written to a temporary file first and then renamed so that a concurrent compilation never sees it half written. Returns false if the cache could not be written.
+         */
+        static bool Store(ASTProgram * program, SourceFile const & source, uint32_t flags) {
+            std::string data = ASTWriter::Write(program, source.text(), flags);
+            std::string filename = CacheFilename(source);
+            std::string tmp = filename + ".tmp";
+            {
+                std::ofstream f{tmp, std::ios::binary | std::ios::trunc};
+                if (! f.write(data.data(), data.size()))
+                    return false;
+            }
+            if (std::rename(tmp.c_str(), filename.c_str()) != 0) {
+                std::remove(tmp.c_str());
+                return false;
+            }
+            return true;
+        }
+
+    }; // tiny::ASTCache
+
+} // namespace tiny
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <functional>
+
+#include "ast.h"
+
+namespace tiny {
+
+    /** Calls given function on every node of a subtree, parents before their children.
+
+        Unlike the other visitors the walker knows nothing about the semantics of the nodes, it is meant for bulk updates of all nodes, such as moving their locations.
+     */
+    class ASTWalker : public ASTVisitor {
+    public:
+
+        explicit ASTWalker(std::function<void(AST *)> f):
+            f_{std::move(f)} {
+        }
+
+        void walk(AST * ast) {
+            if (ast != nullptr)
+                visitChild(ast);
+        }
+
+        void visit(AST * ast) override { f_(ast); }
+        void visit(ASTProgram * ast) override {
+            f_(ast);
+            for (auto & i : ast->statements)
+                walk(i);
+        }
+        void visit(ASTInteger * ast) override { f_(ast); }
+        void visit(ASTDouble * ast) override { f_(ast); }
+        void visit(ASTChar * ast) override { f_(ast); }
+        void visit(ASTString * ast) override { f_(ast); }
+        void visit(ASTIdentifier * ast) override { f_(ast); }
+        void visit(ASTType * ast) override { f_(ast); }
+        void visit(ASTPointerType * ast) override {
+            f_(ast);
+            walk(ast->base);
+        }
+        void visit(ASTArrayType * ast) override {
+            f_(ast);
+            walk(ast->base);
+            walk(ast->size);
+        }
+        void visit(ASTNamedType * ast) override { f_(ast); }
+        void visit(ASTSequence * ast) override {
+            f_(ast);
+            for (auto & i : ast->body)
+                walk(i);
+        }
+        void visit(ASTBlock * ast) override {
+            f_(ast);
+            for (auto & i : ast->body)
+                walk(i);
+        }
+        void visit(ASTVarDecl * ast) override {
+            f_(ast);
+            walk(ast->varType);
+            walk(ast->name);
+            walk(ast->value);
+        }
+        void visit(ASTFunDecl * ast) override {
+            f_(ast);
+            walk(ast->returnType);
+            for (auto & [type, name] : ast->args) {
+                walk(type);
+                walk(name);
+            }
+            walk(ast->body);
+        }
+        void visit(ASTStructDecl * ast) override {
+            f_(ast);
+            for (auto & [name, type] : ast->fields) {
+                walk(name);
+                walk(type);
+            }
+        }
+        void visit(ASTFunPtrDecl * ast) override {
+            f_(ast);
+            walk(ast->name);
+            for (auto & i : ast->args)
+                walk(i);
+            walk(ast->returnType);
+        }
+        void visit(ASTIf * ast) override {
+            f_(ast);
+            walk(ast->cond);
+            walk(ast->trueCase);
+            walk(ast->falseCase);
+        }
+        void visit(ASTSwitch * ast) override {
+            f_(ast);
+            walk(ast->cond);
+            // the default case is one of the cases
+            for (auto & [value, body] : ast->cases)
+                walk(body);
+        }
+        void visit(ASTWhile * ast) override {
+            f_(ast);
+            walk(ast->cond);
+            walk(ast->body);
+        }
+        void visit(ASTDoWhile * ast) override {
+            f_(ast);
+            walk(ast->body);
+            walk(ast->cond);
+        }
+        void visit(ASTFor * ast) override {
+            f_(ast);
+            walk(ast->init);
+            walk(ast->cond);
+            walk(ast->increment);
+            walk(ast->body);
+        }
+        void visit(ASTBreak * ast) override { f_(ast); }
+        void visit(ASTContinue * ast) override { f_(ast); }
+        void visit(ASTReturn * ast) override {
+            f_(ast);
+            walk(ast->value);
+        }
+        void visit(ASTBinaryOp * ast) override {
+            f_(ast);
+            walk(ast->left);
+            walk(ast->right);
+        }
+        void visit(ASTAssignment * ast) override {
+            f_(ast);
+            walk(ast->lvalue);
+            walk(ast->value);
+        }
+        void visit(ASTUnaryOp * ast) override {
+            f_(ast);
+            walk(ast->arg);
+        }
+        void visit(ASTUnaryPostOp * ast) override {
+            f_(ast);
+            walk(ast->arg);
+        }
+        void visit(ASTAddress * ast) override {
+            f_(ast);
+            walk(ast->target);
+        }
+        void visit(ASTDeref * ast) override {
+            f_(ast);
+            walk(ast->target);
+        }
+        void visit(ASTIndex * ast) override {
+            f_(ast);
+            walk(ast->base);
+            walk(ast->index);
+        }
+        void visit(ASTMember * ast) override {
+            f_(ast);
+            walk(ast->base);
+        }
+        void visit(ASTMemberPtr * ast) override {
+            f_(ast);
+            walk(ast->base);
+        }
+        void visit(ASTCall * ast) override {
+            f_(ast);
+            walk(ast->function);
+            for (auto & i : ast->args)
+                walk(i);
+        }
+        void visit(ASTCast * ast) override {
+            f_(ast);
+            walk(ast->value);
+            walk(ast->type);
+        }
+        void visit(ASTPrint * ast) override {
+            f_(ast);
+            walk(ast->value);
+        }
+        void visit(ASTScan * ast) override { f_(ast); }
+
+    private:
+        std::function<void(AST *)> f_;
+
+    }; // tiny::ASTWalker
+
+} // namespace tiny
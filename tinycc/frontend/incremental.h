@@ -0,0 +1,263 @@
+#pragma once
+
+#include <algorithm>
+#include <optional>
+#include <set>
+
+#include "ast_walker.h"
+#include "parser.h"
+
+namespace tiny {
+
+    /** Incremental front end for edited files.
+
+        Keeps the tokens of the file and the AST of its last successful parse together with the token index at which each top-level declaration starts. An edit then only re-lexes the text from the start of the declaration the edit begins in up to the first unchanged declaration boundary after the edit, and re-parses only the declarations in that region. All other declarations are reused as they are, those after the edit only have their locations moved.
+
+        The re-lexing stops as soon as the lexer produces a token at the (moved) start of an old declaration past the end of the edit. Since the lexer carries no state from one token to the next and the text from there on did not change, all remaining tokens would be identical to the old ones. If the re-parsed declarations do not end at such a boundary, the parser simply continues with the next declarations until they do. The parser needs to know the type names declared before the region, which it gets from the reused struct and function pointer declarations. If the region declares different type names than before, all declarations after it are re-parsed as well as they might now parse differently.
+
+        The source file keeps its id across edits and its contents are replaced, see SourceFile::Replace(). The literal side tables of the new contents are rebuilt from the kept and re-lexed tokens, the previous contents are released once the edit is done. Only parsing is incremental, the typechecker must be run on the whole program again.
+     */
+    class IncrementalParser {
+    public:
+
+        /** Parses the text from scratch. Throws ParserError if the text does not parse.
+         */
+        IncrementalParser(std::string const & text, std::string const & filename):
+            file_{& SourceFile::FromText(text, filename)} {
+            parseAll();
+        }
+
+        IncrementalParser(IncrementalParser const &) = delete;
+        IncrementalParser & operator = (IncrementalParser const &) = delete;
+
+        /** The file is owned by the parser and closed with it.
+         */
+        ~IncrementalParser() {
+            program_.reset();
+            SourceFile::Close(file_->id());
+        }
+
+        /** The program, or nullptr if the last edit did not parse.
+         */
+        ASTProgram * program() const {
+            return program_.get();
+        }
+
+        std::vector<Token> const & tokens() const {
+            return tokens_;
+        }
+
+        SourceFile const & file() const {
+            return *file_;
+        }
+
+        /** Number of top-level declarations parsed by the last edit.
+         */
+        size_t reparsedDeclarations() const {
+            return reparsed_;
+        }
+
+        /** Number of tokens lexed by the last edit.
+         */
+        size_t relexedTokens() const {
+            return relexed_;
+        }
+
+        /** Replaces length bytes at given offset with the text and updates the tokens and the AST.
+
+            If the edited text does not lex or parse, the error is rethrown and the program becomes nullptr. The next edit then parses the whole file again.
+         */
+        void edit(size_t offset, size_t length, std::string const & text) {
+            std::string_view old{file_->text()};
+            assert(offset + length <= old.size());
+            std::string updated;
+            updated.reserve(old.size() - length + text.size());
+            updated.append(old.substr(0, offset));
+            updated.append(text);
+            updated.append(old.substr(offset + length));
+            SourceFile const & previous = *file_;
+            file_ = & SourceFile::Replace(file_->id(), std::move(updated));
+            try {
+                // replaced declarations stay in the program's arena, once they take most of it the file is parsed from scratch into a new one
+                if (program_ == nullptr || decls_.empty() || program_->arena.size() > parsedSize_ * MaxArenaGrowth)
+                    parseAll();
+                else
+                    reparse(previous, offset, length, text.size());
+            } catch (...) {
+                program_.reset();
+                tokens_.clear();
+                decls_.clear();
+                SourceFile::Release(file_->id());
+                throw;
+            }
+            // all tokens now refer to the new contents
+            SourceFile::Release(file_->id());
+        }
+
+    private:
+
+        static constexpr size_t MaxArenaGrowth = 4;
+
+        /** Parser of top-level declarations that starts at given token index.
+         */
+        class DeclParser : public Parser {
+        public:
+            DeclParser(std::vector<Token> && tokens, size_t start, Arena & arena):
+                Parser{std::move(tokens), start} {
+                arena_ = & arena;
+            }
+
+            using Parser::eof;
+            using Parser::index;
+            using Parser::takeTokens;
+            using Parser::addTypeName;
+            using Parser::TOP_LEVEL_DECL;
+        };
+
+        /** Returns the type name introduced by given top-level declaration, if any.
+         */
+        static std::optional<Symbol> DeclaredTypeName(AST * decl) {
+            if (auto s = dynamic_cast<ASTStructDecl *>(decl))
+                return s->name;
+            if (auto f = dynamic_cast<ASTFunPtrDecl *>(decl))
+                return f->name->name;
+            return std::nullopt;
+        }
+
+        template<typename IT>
+        static std::multiset<size_t> DeclaredTypeNames(IT begin, IT end) {
+            std::multiset<size_t> result;
+            for (; begin != end; ++begin)
+                if (auto name = DeclaredTypeName(*begin))
+                    result.insert(name->id());
+            return result;
+        }
+
+        void parseAll() {
+            program_.reset();
+            decls_.clear();
+            tokens_ = Lexer::TokenizeFile(*file_);
+            relexed_ = tokens_.size();
+            std::unique_ptr<ASTProgram> program{new ASTProgram{tokens_.front()}};
+            DeclParser p{std::move(tokens_), 0, program->arena};
+            while (! p.eof()) {
+                decls_.push_back(p.index());
+                program->statements.push_back(p.TOP_LEVEL_DECL());
+            }
+            tokens_ = p.takeTokens();
+            program_ = std::move(program);
+            reparsed_ = decls_.size();
+            parsedSize_ = program_->arena.size();
+        }
+
+        /** Returns the token moved by given number of bytes. The value of a numeric literal is moved from the side tables of the previous contents of the file to those of the current ones.
+         */
+        Token moved(Token const & t, SourceFile const & previous, int64_t delta) {
+            switch (t.kind()) {
+                case Token::Kind::Integer:
+                    return Token{Token::Kind::Integer, t.location(), file_->addIntegerLiteral(previous.integerLiteral(t.literalIndex()))}.shifted(delta);
+                case Token::Kind::Double:
+                    return Token{Token::Kind::Double, t.location(), file_->addDoubleLiteral(previous.doubleLiteral(t.literalIndex()))}.shifted(delta);
+                default:
+                    return t.shifted(delta);
+            }
+        }
+
+        void reparse(SourceFile const & previous, size_t offset, size_t oldLength, size_t newLength) {
+            int64_t delta = static_cast<int64_t>(newLength) - static_cast<int64_t>(oldLength);
+            size_t n = decls_.size();
+            // old offset of the k-th declaration
+            auto declOffset = [&](size_t k) { return tokens_[decls_[k]].location().offset(); };
+            // the edit belongs to the last declaration that starts before it, edits in front of the first declaration belong to it. An edit right at the start of a declaration belongs to the previous one as it may touch its last token
+            size_t a = 0;
+            while (a + 1 < n && declOffset(a + 1) < offset)
+                ++a;
+            size_t relexFirst = a == 0 ? 0 : decls_[a];
+            uint32_t relexFrom = a == 0 ? 0 : declOffset(a);
+            // re-lex until a token lines up with an old declaration start past the edit
+            Lexer l{*file_, file_->begin() + relexFrom};
+            std::vector<Token> fresh;
+            size_t b = a + 1;
+            while (true) {
+                Token t = l.next();
+                if (t.location().offset() >= offset + newLength && t != Token::Kind::EoF) {
+                    int64_t oldOffset = t.location().offset() - delta;
+                    while (b < n && declOffset(b) < oldOffset)
+                        ++b;
+                    if (b < n && declOffset(b) == oldOffset)
+                        break;
+                }
+                fresh.push_back(t);
+                if (t == Token::Kind::EoF) {
+                    b = n;
+                    break;
+                }
+            }
+            relexed_ = fresh.size();
+            // splice the new tokens in, the unchanged tail is moved by the edit's length
+            size_t oldSync = b < n ? decls_[b] : tokens_.size();
+            int64_t tokenDelta = static_cast<int64_t>(fresh.size()) - static_cast<int64_t>(oldSync - relexFirst);
+            std::vector<Token> tokens;
+            tokens.reserve(tokens_.size() + std::max<int64_t>(tokenDelta, 0));
+            for (size_t i = 0; i != relexFirst; ++i)
+                tokens.push_back(moved(tokens_[i], previous, 0));
+            tokens.insert(tokens.end(), fresh.begin(), fresh.end());
+            for (size_t i = oldSync, e = tokens_.size(); i != e; ++i)
+                tokens.push_back(moved(tokens_[i], previous, delta));
+            tokens_ = std::move(tokens);
+            // parse the declarations of the region, the parser needs to know the type names declared before it
+            auto & statements = program_->statements;
+            DeclParser p{std::move(tokens_), relexFirst, program_->arena};
+            for (size_t k = 0; k < a; ++k)
+                if (auto name = DeclaredTypeName(statements[k]))
+                    p.addTypeName(*name);
+            std::vector<AST *> decls;
+            std::vector<size_t> starts;
+            auto parseDecls = [&](bool toEnd) {
+                while (! p.eof()) {
+                    if (! toEnd) {
+                        while (b < n && decls_[b] + tokenDelta < p.index())
+                            ++b;
+                        if (b < n && decls_[b] + tokenDelta == p.index())
+                            return;
+                    }
+                    starts.push_back(p.index());
+                    decls.push_back(p.TOP_LEVEL_DECL());
+                }
+                b = n;
+            };
+            parseDecls(false);
+            if (DeclaredTypeNames(decls.begin(), decls.end()) != DeclaredTypeNames(statements.begin() + a, statements.begin() + b))
+                parseDecls(true);
+            tokens_ = p.takeTokens();
+            // declarations after the region are reused, only moved
+            ASTWalker move{[delta](AST * ast) { ast->shiftLocation(delta); }};
+            for (size_t k = b; k < n; ++k)
+                move.walk(statements[k]);
+            program_->shiftLocation(static_cast<int64_t>(tokens_.front().location().offset()) - program_->location().offset());
+            statements.erase(statements.begin() + a, statements.begin() + b);
+            statements.insert(statements.begin() + a, decls.begin(), decls.end());
+            std::vector<size_t> declStarts{decls_.begin(), decls_.begin() + a};
+            declStarts.insert(declStarts.end(), starts.begin(), starts.end());
+            for (size_t k = b; k < n; ++k)
+                declStarts.push_back(decls_[k] + tokenDelta);
+            decls_ = std::move(declStarts);
+            reparsed_ = decls.size();
+        }
+
+        SourceFile * file_;
+        std::vector<Token> tokens_;
+        std::unique_ptr<ASTProgram> program_;
+        /** Index of the first token of each top-level declaration.
+         */
+        std::vector<size_t> decls_;
+
+        /** Size of the arena right after the last full parse.
+         */
+        size_t parsedSize_ = 0;
+        size_t reparsed_ = 0;
+        size_t relexed_ = 0;
+
+    }; // tiny::IncrementalParser
+
+} // namespace tiny
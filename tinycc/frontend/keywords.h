@@ -0,0 +1,165 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#include "common/symbol.h"
+
+namespace tiny {
+
+    /** Keywords, operators and punctuators of tinyC.
+
+        Tokens carry their keyword so that the parser can switch on it instead of comparing symbols one by one. Identifiers that are not keywords have None.
+     */
+    enum class Keyword : uint8_t {
+        None,
+        // keywords
+        Break,
+        Case,
+        Cast,
+        Char,
+        Continue,
+        Default,
+        Do,
+        Double,
+        Else,
+        For,
+        If,
+        Int,
+        Return,
+        Struct,
+        Switch,
+        Typedef,
+        Void,
+        While,
+        // operators
+        Inc,
+        Dec,
+        AddAssign,
+        SubAssign,
+        MulAssign,
+        DivAssign,
+        Add,
+        Sub,
+        Mul,
+        Div,
+        Mod,
+        ShiftLeft,
+        ShiftRight,
+        Eq,
+        NEq,
+        Lt,
+        Gt,
+        Lte,
+        Gte,
+        BitAnd,
+        BitOr,
+        And,
+        Or,
+        Not,
+        Neg,
+        Assign,
+        ArrowR,
+        // punctuators
+        Dot,
+        Comma,
+        Semicolon,
+        Colon,
+        Question,
+        SquareOpen,
+        SquareClose,
+        ParOpen,
+        ParClose,
+        CurlyOpen,
+        CurlyClose,
+        Backtick,
+    }; // tiny::Keyword
+
+    namespace keywords {
+
+        /** Spellings, indexed by the keyword.
+         */
+        inline constexpr std::array<std::string_view, static_cast<size_t>(Keyword::Backtick) + 1> Spellings = {
+            "",
+            "break", "case", "cast", "char", "continue", "default", "do", "double", "else", "for", "if", "int", "return", "struct", "switch", "typedef", "void", "while",
+            "++", "--", "+=", "-=", "*=", "/=", "+", "-", "*", "/", "%", "<<", ">>", "==", "!=", "<", ">", "<=", ">=", "&", "|", "&&", "||", "!", "~", "=", "->",
+            ".", ",", ";", ":", "?", "[", "]", "(", ")", "{", "}", "`",
+        };
+
+        static_assert(Spellings[static_cast<size_t>(Keyword::Backtick)] == "`" && Spellings[static_cast<size_t>(Keyword::ArrowR)] == "->", "Spellings must match the keyword enum");
+
+        constexpr size_t TableSize = 512;
+        constexpr size_t MaxLength = 8;
+
+        /** Hash of a spelling. Only looks at the length and three of the characters so that it is cheap, the seed is chosen at compile time so that there are no collisions among the spellings.
+         */
+        constexpr uint32_t Hash(std::string_view s, uint32_t seed) {
+            uint32_t h = seed ^ static_cast<uint32_t>(s.size());
+            h = h * 31 + static_cast<uint8_t>(s[0]);
+            h = h * 31 + static_cast<uint8_t>(s[s.size() - 1]);
+            h = h * 31 + static_cast<uint8_t>(s[s.size() / 2]);
+            h ^= h >> 9;
+            return h & (TableSize - 1);
+        }
+
+        struct PerfectHash {
+            uint32_t seed;
+            std::array<uint8_t, TableSize> slots;
+        };
+
+        /** Finds the first seed for which the hash has no collisions. The slots contain the keyword whose spelling hashes to them, or None.
+         */
+        constexpr PerfectHash Build() {
+            for (uint32_t seed = 0; seed < 10000; ++seed) {
+                PerfectHash result{seed, {}};
+                bool collision = false;
+                for (size_t i = 1; i < Spellings.size() && ! collision; ++i) {
+                    uint8_t & slot = result.slots[Hash(Spellings[i], seed)];
+                    collision = slot != 0;
+                    slot = static_cast<uint8_t>(i);
+                }
+                if (! collision)
+                    return result;
+            }
+            return PerfectHash{~0u, {}};
+        }
+
+        inline constexpr PerfectHash Table = Build();
+
+        static_assert(Table.seed != ~0u, "No perfect hash seed found for the keywords");
+
+    } // namespace tiny::keywords
+
+    /** Returns the keyword of given spelling, or None. A single hash computation and string compare.
+     */
+    inline Keyword LookupKeyword(std::string_view s) {
+        if (s.empty() || s.size() > keywords::MaxLength)
+            return Keyword::None;
+        uint8_t i = keywords::Table.slots[keywords::Hash(s, keywords::Table.seed)];
+        return keywords::Spellings[i] == s ? static_cast<Keyword>(i) : Keyword::None;
+    }
+
+    /** Returns true if the keyword is one of the reserved words, i.e. not an operator.
+     */
+    inline bool IsReservedWord(Keyword k) {
+        return k >= Keyword::Break && k <= Keyword::While;
+    }
+
+    inline std::string_view Spelling(Keyword k) {
+        return keywords::Spellings[static_cast<size_t>(k)];
+    }
+
+    /** Returns the symbol of given keyword. The symbols are interned once, on first use.
+     */
+    inline Symbol KeywordSymbol(Keyword k) {
+        static std::array<size_t, keywords::Spellings.size()> const ids = []() {
+            std::array<size_t, keywords::Spellings.size()> result{};
+            for (size_t i = 0; i < result.size(); ++i)
+                result[i] = Symbol{keywords::Spellings[i]}.id();
+            return result;
+        }();
+        return Symbol::FromId(ids[static_cast<size_t>(k)]);
+    }
+
+} // namespace tiny
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "parser.h"
+#include "typechecker.h"
+
+namespace tiny {
+
+    /** Front end that only parses and typechecks the functions reachable from main.
+
+        The whole file is lexed up front and the parser skips function bodies, matching their braces only. The typechecker then walks the call graph from main and has the bodies it reaches parsed from their recorded token ranges, see Typechecker::checkReachable(). Programs that define many functions but use few of them thus never pay for the rest.
+
+        Errors in unreachable functions are not reported. The bodies are parsed once all type names are known, so a body may use a struct declared after it.
+     */
+    class LazyParser : public Parser {
+    public:
+
+        /** Returns the typechecked program.
+         */
+        static std::unique_ptr<AST> parseFile(std::string const & filename) {
+            return parseFile(SourceFile::Open(filename));
+        }
+
+        static std::unique_ptr<AST> parseFile(SourceFile & file) {
+            return LazyParser{file}.parseAndCheck();
+        }
+
+        static std::unique_ptr<AST> parse(std::string const & source) {
+            return LazyParser{SourceFile::FromText(source, "")}.parseAndCheck();
+        }
+
+    private:
+
+        LazyParser(SourceFile & file):
+            Parser{Lexer::TokenizeFile(file)} {
+            lazyBodies_ = true;
+        }
+
+        std::unique_ptr<AST> parseAndCheck() {
+            std::unique_ptr<AST> result{PROGRAM()};
+            pop(Token::Kind::EoF);
+            Typechecker::checkReachable(result, [this](ASTFunDecl * f) {
+                restart(f->lazyBody);
+                f->body = BLOCK_STMT();
+                f->lazyBody = 0;
+            });
+            return result;
+        }
+
+    }; // tiny::LazyParser
+
+} // namespace tiny
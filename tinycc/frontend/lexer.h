@@ -2,15 +2,22 @@
 
 #include <cassert>
 
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
-#include <sstream>
-#include <fstream>
-#include <variant>
+#include <type_traits>
 
 #include "common/symbol.h"
 #include "common/source_error.h"
+#include "common/source_file.h"
+#include "common/thread_pool.h"
+
+#include "keywords.h"
+#include "scan.h"
 
 namespace tiny {
 
@@ -21,9 +28,13 @@ namespace tiny {
         }
     };
 
+    /** A single token.
+
+        Tokens are small trivially copyable records: the kind, the keyword, the file id and offset of the token in the file and a payload whose meaning depends on the kind. For identifiers and operators it is the symbol id, for numeric literals an index into the literal side tables of the file and for string literals the length of the literal. Everything else, including the line and column of the token, is looked up in the source file when needed.
+     */
     class Token {
     public:
-        enum class Kind {
+        enum class Kind : uint8_t {
             EoF,
             Identifier,
             Operator,
@@ -34,65 +45,114 @@ namespace tiny {
         }; // tiny::Token::Kind
 
         static Token EoF(SourceLocation const & l) {
-            return Token{Token::Kind::EoF, l};
+            return Token{Token::Kind::EoF, l, 0};
         }
 
-        Token(std::string const & symbol, SourceLocation const & l, bool isOperator = false):
-            kind_{isOperator ? Kind::Operator : Kind::Identifier},
-            location_{l},
-            contents_{Symbol{symbol}} {
+        Token() = default;
+
+        Token(Symbol symbol, SourceLocation const & l, bool isOperator = false):
+            Token{isOperator ? Kind::Operator : Kind::Identifier, l, static_cast<uint32_t>(symbol.id())} {
         }
 
-        Token(char symbol, SourceLocation const & l):
-            kind_{Kind::Identifier},
-            location_{l},
-            contents_{Symbol{std::string{symbol}}} {
+        /** Creates token for a keyword, operator or punctuator. The symbol is also available so that the token compares equal to the keyword's symbol.
+         */
+        Token(Keyword keyword, SourceLocation const & l, bool isOperator = false):
+            Token{isOperator ? Kind::Operator : Kind::Identifier, l, static_cast<uint32_t>(KeywordSymbol(keyword).id())} {
+            keyword_ = keyword;
         }
 
-        Token(int value, SourceLocation const & l):
-            kind_{Kind::Integer},
-            location_{l},
-            contents_{value} {
+        /** Creates a token of given kind with raw payload.
+         */
+        Token(Kind kind, SourceLocation const & l, uint32_t payload):
+            kind_{kind},
+            file_{l.fileId()},
+            offset_{l.offset()},
+            payload_{payload} {
         }
 
-        Token(double value, SourceLocation const & l):
-            kind_{Kind::Double},
-            location_{l},
-            contents_{value} {
+        Kind kind() const {
+            return kind_;
         }
 
-        Token(std::string const & literal, char quote, SourceLocation const & l):
-            kind_{quote == '"' ? Kind::StringDoubleQuoted : Kind::StringSingleQuoted },
-            location_{l},
-            contents_{literal} {
+        Keyword keyword() const {
+            return keyword_;
         }
 
-        Kind kind() const {
-            return kind_;
+        /** Returns copy of the token moved by given number of bytes in its file.
+         */
+        Token shifted(int64_t delta) const {
+            Token result{*this};
+            result.offset_ = static_cast<uint32_t>(offset_ + delta);
+            return result;
+        }
+
+        /** Returns copy of the numeric literal token whose side table index is moved by given base. Used when side tables of separately lexed chunks are merged.
+         */
+        Token rebased(uint32_t base) const {
+            assert(kind_ == Kind::Integer || kind_ == Kind::Double);
+            Token result{*this};
+            result.payload_ += base;
+            return result;
         }
 
-        SourceLocation const & location() const {
-            return location_;
+        SourceLocation location() const {
+            return SourceLocation{file_, offset_};
+        }
+
+        /** Index of a numeric literal's value in the side tables of its file.
+         */
+        uint32_t literalIndex() const {
+            assert(kind_ == Kind::Integer || kind_ == Kind::Double);
+            return payload_;
         }
 
         Symbol valueSymbol() const {
             assert(kind_ == Kind::Identifier || kind_ == Kind::Operator);
-            return std::get<Symbol>(contents_);
+            return Symbol::FromId(payload_);
         }
 
-        int valueInt() const {
+        int64_t valueInt() const {
             assert(kind_ == Kind::Integer);
-            return std::get<int>(contents_);
+            return SourceFile::Get(file_).integerLiteral(payload_);
         }
 
         double valueDouble() const {
             assert(kind_ == Kind::Double);
-            return std::get<double>(contents_);
+            return SourceFile::Get(file_).doubleLiteral(payload_);
         }
 
-        std::string const & valueString() const {
+        /** Returns the value of a string literal.
+
+            The literal is kept in the source buffer with its escape sequences intact, they are only decoded here. The lexer has already validated the escapes.
+         */
+        std::string valueString() const {
             assert(kind_ == Kind::StringSingleQuoted || kind_ == Kind::StringDoubleQuoted);
-            return std::get<std::string>(contents_);
+            // skip the opening quote
+            std::string_view raw = SourceFile::Get(file_).text().substr(offset_ + 1, payload_);
+            std::string result;
+            result.reserve(raw.size());
+            for (size_t i = 0, e = raw.size(); i < e; ++i) {
+                if (raw[i] != '\\') {
+                    result += raw[i];
+                    continue;
+                }
+                switch (raw[++i]) {
+                    case 'n':
+                        result += '\n';
+                        break;
+                    case 'r':
+                        result += '\r';
+                        break;
+                    case 't':
+                        result += '\t';
+                        break;
+                    case '\n':
+                        break;
+                    default:
+                        result += raw[i];
+                }
+            }
+            return result;
         }
 
         bool operator == (Kind kind) const {
@@ -104,24 +164,20 @@ namespace tiny {
         }
 
         bool operator == (Symbol symbol) const {
-            return (kind_ == Kind::Identifier || kind_ == Kind::Operator) && valueSymbol() == symbol;
+            return (kind_ == Kind::Identifier || kind_ == Kind::Operator) && payload_ == symbol.id();
         }
 
         bool operator != (Symbol symbol) const {
-            return (kind_ != Kind::Identifier && kind_ != Kind::Operator) || valueSymbol() != symbol;
+            return (kind_ != Kind::Identifier && kind_ != Kind::Operator) || payload_ != symbol.id();
         }
 
     private:
 
-        Token(Kind kind, SourceLocation const & l):
-            kind_{kind},
-            location_{l} {
-        }
-
         Kind kind_;
-        SourceLocation location_;
-
-        std::variant<int, double, Symbol, std::string> contents_;
+        Keyword keyword_ = Keyword::None;
+        uint32_t file_;
+        uint32_t offset_;
+        uint32_t payload_;
 
         friend std::ostream & operator << (std::ostream & s, Token::Kind kind) {
             switch (kind) {
@@ -194,25 +250,139 @@ namespace tiny {
 
     }; // tiny::Token
 
+    static_assert(sizeof(Token) == 16 && std::is_trivially_copyable_v<Token>);
+
     /** Lexical Analyzer.
+
+        Scans a contiguous source buffer in place. Identifiers are interned directly from views into the buffer, string literals keep referring to it and values of numeric literals are stored in the side tables of the source file.
+
+        The lexer can either tokenize the whole input at once, or produce the tokens one by one via next(), which is what the parser uses. Large files are tokenized in parallel, see TokenizeParallel().
      */
     class Lexer {
     public:
 
-        static std::vector<Token> TokenizeFile(std::string const & filename) {
-            std::ifstream f;
-            f.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-            f.open(filename);
-            Lexer l(f, filename);
-            l.tokenize();
-            return std::move(l.tokens_);
+        /** Files at least this large are split into chunks lexed in parallel.
+         */
+        static constexpr size_t ParallelThreshold = 4 * 1024 * 1024;
+
+        /** No chunk is made smaller than this so that the per-chunk overhead stays negligible.
+         */
+        static constexpr size_t MinChunkSize = 1024 * 1024;
+
+        static std::vector<Token> TokenizeFile(SourceFile & file) {
+            size_t chunks = std::min(ThreadPool::Default().size(), file.size() / MinChunkSize);
+            if (file.size() >= ParallelThreshold && chunks > 1)
+                return TokenizeParallel(file, chunks);
+            return Tokenize(file);
+        }
+
+        /** Splits the file into (up to) given number of chunks at safe boundaries and lexes them on the thread pool.
+
+            The tokens are identical to those of the single-threaded lexer: every chunk starts in the state the lexer would be in at that point anyway, the literals are collected per chunk and appended to the side tables of the file in order. If lexing fails, the error of the first failing chunk is rethrown, which is the error the single-threaded lexer would report.
+         */
+        static std::vector<Token> TokenizeParallel(SourceFile & file, size_t chunks) {
+            std::vector<char const *> bounds = SafeBoundaries(file.begin(), file.end(), chunks);
+            size_t n = bounds.size() - 1;
+            std::vector<std::vector<Token>> tokens(n);
+            std::vector<SourceFile::Literals> literals(n);
+            std::vector<std::future<void>> results;
+            for (size_t i = 0; i < n; ++i) {
+                results.push_back(ThreadPool::Default().submit([&, i]() {
+                    Lexer l{file, bounds[i], bounds[i + 1], literals[i]};
+                    tokens[i] = l.tokenize();
+                    // only the last chunk ends the file
+                    if (i + 1 != n)
+                        tokens[i].pop_back();
+                }));
+            }
+            // all chunks must finish before anything is rethrown as they refer to the local state
+            for (auto & r : results)
+                r.wait();
+            for (auto & r : results)
+                r.get();
+            size_t total = 0;
+            for (auto & t : tokens)
+                total += t.size();
+            std::vector<Token> result;
+            result.reserve(total);
+            for (size_t i = 0; i < n; ++i) {
+                auto [integersBase, doublesBase] = file.addLiterals(literals[i]);
+                for (Token const & t : tokens[i]) {
+                    if (t == Token::Kind::Integer)
+                        result.push_back(t.rebased(integersBase));
+                    else if (t == Token::Kind::Double)
+                        result.push_back(t.rebased(doublesBase));
+                    else
+                        result.push_back(t);
+                }
+            }
+            return result;
         }
 
-        static std::vector<Token> Tokenize(std::string const & text, std::string const & filename) {
-            std::stringstream s{text};
-            Lexer l{s, filename};
-            l.tokenize();
-            return std::move(l.tokens_);
+        /** Returns boundaries of (up to) given number of chunks of roughly the same size, including the beginning and end of the buffer.
+
+            A chunk may only start right after a newline that is not part of a comment or a string literal. The pre-scan that finds such newlines mirrors the lexer's handling of comments and literals, but otherwise only jumps from one comment or literal start to the next. Input that does not lex is not an issue, the chunks are then still split where the lexer would be in the same state and the lexer reports the error.
+         */
+        static std::vector<char const *> SafeBoundaries(char const * begin, char const * end, size_t chunks) {
+            std::vector<char const *> result{begin};
+            size_t chunkSize = static_cast<size_t>(end - begin) / std::max(chunks, size_t{1});
+            char const * p = begin;
+            while (p != end && result.size() < chunks) {
+                char const * special = scan::Default::FindAny(p, end, '/', '"', '\'');
+                // everything up to the next comment or literal start is outside of them, look for a newline past the desired chunk end
+                char const * target = result.back() + chunkSize;
+                if (special > target) {
+                    char const * nl = scan::Default::Find(std::max(p, target), special, '\n');
+                    if (nl != special) {
+                        p = nl + 1;
+                        result.push_back(p);
+                        continue;
+                    }
+                }
+                if (special == end)
+                    break;
+                p = special + 1;
+                switch (*special) {
+                    case '/':
+                        if (p != end && *p == '/') {
+                            // the newline ending the comment is itself safe, so it is left to be found
+                            p = scan::Default::Find(p, end, '\n');
+                        } else if (p != end && *p == '*') {
+                            ++p;
+                            while (true) {
+                                p = scan::Default::Find(p, end, '*');
+                                if (p == end)
+                                    break;
+                                if (++p != end && *p == '/') {
+                                    ++p;
+                                    break;
+                                }
+                            }
+                        }
+                        break;
+                    default:
+                        while (true) {
+                            p = scan::Default::FindEither(p, end, *special, '\\');
+                            if (p == end)
+                                break;
+                            if (*p == *special) {
+                                ++p;
+                                break;
+                            }
+                            // skip the escaped character
+                            p = (end - p > 2) ? p + 2 : end;
+                        }
+                }
+            }
+            result.push_back(end);
+            return result;
+        }
+
+        /** Lexes the whole file on the current thread regardless of its size, see TokenizeFile().
+         */
+        static std::vector<Token> Tokenize(SourceFile & file) {
+            Lexer l{file};
+            return l.tokenize();
         }
 
         static bool IsLetter(char c) {
@@ -239,101 +409,110 @@ namespace tiny {
             return IsIdentifierStart(c) || IsDigit(c) >= 0;
         }
 
-    private:
+        explicit Lexer(SourceFile & file):
+            file_{file},
+            cur_{file.begin()},
+            end_{file.end()} {
+        }
+
+        /** Creates lexer of the file that starts at given position.
+         */
+        Lexer(SourceFile & file, char const * begin):
+            file_{file},
+            cur_{begin},
+            end_{file.end()} {
+        }
 
-        Lexer(std::istream & input, std::string const & filename):
-            i_{input},
-            l_{filename, 1, 1} {
+        /** Creates lexer of the [begin, end) part of the file that stores the literal values into the given tables instead of the file's ones.
+         */
+        Lexer(SourceFile & file, char const * begin, char const * end, SourceFile::Literals & literals):
+            file_{file},
+            cur_{begin},
+            end_{end},
+            literals_{&literals} {
         }
 
-        /** Actually does the tokenization.
+        /** Returns the next token from the input. Once the input is exhausted, returns end of file token on every call.
          */
-        void tokenize() {
+        Token next() {
             while (! eof()) {
                 char c = top();
                 // skip whitespace
-                if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
-                    pop();
+                if (scan::Scalar::IsWhitespace(c)) {
+                    cur_ = scan::Default::SkipWhitespace(cur_, end_);
                     continue;
                 }
-                SourceLocation start{l_};
+                SourceLocation start{location()};
                 // determine what we have here
                 c = pop();
                 switch (c) {
                     case '/':
-                        if (condPop('/'))
+                        if (condPop('/')) {
                             singleLineComment();
-                        else if (condPop('*'))
+                            continue;
+                        } else if (condPop('*')) {
                             multiLineComment(start);
-                        else if (condPop('='))
-                            tokens_.push_back(Token{"/=", start, true});
-                        else
-                            tokens_.push_back(Token{"/", start, true});
-                        break;
+                            continue;
+                        } else if (condPop('=')) {
+                            return Token{Keyword::DivAssign, start, true};
+                        } else {
+                            return Token{Keyword::Div, start, true};
+                        }
                     case '+':
                         if (condPop('+'))
-                            tokens_.push_back(Token{"++", start, true});
+                            return Token{Keyword::Inc, start, true};
                         else if (condPop('='))
-                            tokens_.push_back(Token{"+=", start, true});
+                            return Token{Keyword::AddAssign, start, true};
                         else
-                            tokens_.push_back(Token{"+", start, true});
-                        break;
+                            return Token{Keyword::Add, start, true};
                     case '-':
                         if (condPop('-'))
-                            tokens_.push_back(Token{"--", start, true});
+                            return Token{Keyword::Dec, start, true};
                         else if (condPop('='))
-                            tokens_.push_back(Token{"-=", start, true});
+                            return Token{Keyword::SubAssign, start, true};
                         else if (condPop('>'))
-                            tokens_.push_back(Token{"->", start, true});
+                            return Token{Keyword::ArrowR, start, true};
                         else
-                            tokens_.push_back(Token{"-", start, true});
-                        break;
+                            return Token{Keyword::Sub, start, true};
                     case '*':
                         if (condPop('='))
-                            tokens_.push_back(Token{"*=", start, true});
+                            return Token{Keyword::MulAssign, start, true};
                         else
-                            tokens_.push_back(Token{"*", start, true});
-                        break;
+                            return Token{Keyword::Mul, start, true};
                     case '!':
                         if (condPop('='))
-                            tokens_.push_back(Token{"!=", start, true});
+                            return Token{Keyword::NEq, start, true};
                         else
-                            tokens_.push_back(Token{"!", start, true});
-                        break;
+                            return Token{Keyword::Not, start, true};
                     case '=':
                         if (condPop('='))
-                            tokens_.push_back(Token{"==", start, true});
+                            return Token{Keyword::Eq, start, true};
                         else
-                            tokens_.push_back(Token{"=", start, true});
-                        break;
+                            return Token{Keyword::Assign, start, true};
                     case '<':
                         if (condPop('<'))
-                            tokens_.push_back(Token{"<<", start, true});
+                            return Token{Keyword::ShiftLeft, start, true};
                         else if (condPop('='))
-                            tokens_.push_back(Token{"<=", start, true});
+                            return Token{Keyword::Lte, start, true};
                         else
-                            tokens_.push_back(Token{"<", start, true});
-                        break;
+                            return Token{Keyword::Lt, start, true};
                     case '>':
                         if (condPop('>'))
-                            tokens_.push_back(Token{">>", start, true});
+                            return Token{Keyword::ShiftRight, start, true};
                         else if (condPop('='))
-                            tokens_.push_back(Token{">=", start, true});
+                            return Token{Keyword::Gte, start, true};
                         else
-                            tokens_.push_back(Token{">", start, true});
-                        break;
+                            return Token{Keyword::Gt, start, true};
                     case '|':
                         if (condPop('|'))
-                            tokens_.push_back(Token{"||", start, true});
+                            return Token{Keyword::Or, start, true};
                         else
-                            tokens_.push_back(Token{"|", start, true});
-                        break;
+                            return Token{Keyword::BitOr, start, true};
                     case '&':
                         if (condPop('&'))
-                            tokens_.push_back(Token{"&&", start, true});
+                            return Token{Keyword::And, start, true};
                         else
-                            tokens_.push_back(Token{"&", start, true});
-                        break;
+                            return Token{Keyword::BitAnd, start, true};
                     case '%':
                     case '.':
                     case ',':
@@ -348,12 +527,10 @@ namespace tiny {
                     case '}':
                     case '~':
                     case '`':
-                        tokens_.push_back(Token{c, start});
-                        break;
+                        return Token{LookupKeyword(std::string_view{&c, 1}), start};
                     case '\'':
                     case '"':
-                        stringLiteral(start, c);
-                        break;
+                        return stringLiteral(start, c);
                     case '0':
                     case '1':
                     case '2':
@@ -364,128 +541,145 @@ namespace tiny {
                     case '7':
                     case '8':
                     case '9':
-                        numericLiteral(start, c);
-                        break;
+                        return numericLiteral(start);
                     default:
                         if (IsIdentifierStart(c))
-                            identifier(start, c);
+                            return identifier(start);
                         else
-                            throw ParserError{"Undefined character", l_};
+                            throw ParserError{"Undefined character", location()};
                 }
             }
-            // make sure that last token is always end of file
-            tokens_.push_back(Token::EoF(l_));
+            return Token::EoF(location());
+        }
+
+    private:
+
+        /** Tokenizes the whole input. The last token is always end of file.
+         */
+        std::vector<Token> tokenize() {
+            std::vector<Token> tokens;
+            do {
+                tokens.push_back(next());
+            } while (tokens.back() != Token::Kind::EoF);
+            return tokens;
         }
 
         void singleLineComment() {
-            while (!eof() && top() != '\n')
-                pop();
+            cur_ = scan::Default::Find(cur_, end_, '\n');
         }
 
         void multiLineComment(SourceLocation start) {
             while (true) {
+                cur_ = scan::Default::Find(cur_, end_, '*');
                 if (eof())
                     throw ParserError("Unterminated multi-line comment", start);
-                if (condPop('*') && !eof() && condPop('/'))
+                pop();
+                if (condPop('/'))
                     return;
-                if (!eof())
-                    pop();
             }
         }
 
-        void stringLiteral(SourceLocation start, char quote) {
-            std::string literal;
-            while (!condPop(quote)) {
+        /** Validates the escape sequences of the literal, but leaves their decoding to the token so that the literal itself can be a view into the buffer.
+         */
+        Token stringLiteral(SourceLocation start, char quote) {
+            char const * literalStart = cur_;
+            char const * literalEnd;
+            while (true) {
+                cur_ = scan::Default::FindEither(cur_, end_, quote, '\\');
+                literalEnd = cur_;
+                if (condPop(quote))
+                    break;
                 if (eof())
                     throw ParserError{"Unterminated string literal", start};
                 if (condPop('\\')) {
                     if (eof())
-                        throw ParserError{"Unterminated escape sequence", l_};
+                        throw ParserError{"Unterminated escape sequence", location()};
                     char c = pop();
                     switch (c) {
                         case '\'':
                         case '\\':
                         case '"':
-                            literal += c;
-                            break;
                         case '\n':
-                            break;
                         case 'n':
-                            literal += '\n';
-                            break;
                         case 'r':
-                            literal += '\r';
-                            break;
                         case 't':
-                            literal += '\t';
                             break;
                         default:
-                            throw (ParserError{"Unsupported escape character", l_});
+                            throw (ParserError{"Unsupported escape character", location()});
                     }
-                } else {
-                    literal += pop();
                 }
             }
-            tokens_.push_back(Token{literal, quote, start});
+            return Token{quote == '"' ? Token::Kind::StringDoubleQuoted : Token::Kind::StringSingleQuoted, start, static_cast<uint32_t>(literalEnd - literalStart)};
         }
 
-        // TODO support more bases
-        void numericLiteral(SourceLocation start, char firstDigit) {
-            int number = IsDigit(firstDigit, 10);
-            assert(number >= 0);
-            while (!eof()) {
-                int next = IsDigit(top());
-                if (next < 0)
-                    break;
-                number = (number * 10) + next;
-                pop();
-            }
+        /** The first digit has already been popped. The extent of the literal is found first and then its value is parsed exactly once by std::from_chars, which gives full 64-bit integers and correctly rounded doubles. The value is stored in the side table of the file so that nothing has to reparse it later.
+
+            TODO support more bases
+         */
+        Token numericLiteral(SourceLocation start) {
+            char const * literalStart = cur_ - 1;
+            cur_ = scan::Default::DigitsEnd(cur_, end_);
             // see if we are dealing with a floating point number
             if (condPop('.')) {
                 if (eof() || IsDigit(top()) == -1)
-                    throw ParserError{"Digit must follow after decimal dot", l_};
-                double fraction = number;
-                double divider = 10;
-                while (! eof()) {
-                    int next = IsDigit(top());
-                    if (next < 0)
-                        break;
-                    fraction = fraction + (next / divider);
-                    divider *= 10;
-                    pop();
-                }
-                tokens_.push_back(Token{fraction, start});
+                    throw ParserError{"Digit must follow after decimal dot", location()};
+                cur_ = scan::Default::DigitsEnd(cur_, end_);
+                double value;
+                auto [end, ec] = std::from_chars(literalStart, cur_, value);
+                if (ec != std::errc{} || end != cur_)
+                    throw ParserError{"Double literal out of range", start};
+                return Token{Token::Kind::Double, start, addDoubleLiteral(value)};
             } else {
-                tokens_.push_back(Token{number, start});
+                int64_t value;
+                auto [end, ec] = std::from_chars(literalStart, cur_, value);
+                if (ec != std::errc{} || end != cur_)
+                    throw ParserError{"Integer literal out of range", start};
+                return Token{Token::Kind::Integer, start, addIntegerLiteral(value)};
             }
         }
 
-        void identifier(SourceLocation start, char firstLetter) {
-            std::string ident{firstLetter};
-            while (!eof() && IsIdentifier(top()))
-                ident += pop();
-            tokens_.push_back(Token{ident, start});
+        /** The first letter has already been popped. Keywords are recognized by the perfect hash, other identifiers are interned directly from the buffer.
+         */
+        Token identifier(SourceLocation start) {
+            char const * identStart = cur_ - 1;
+            cur_ = scan::Default::IdentifierEnd(cur_, end_);
+            std::string_view ident{identStart, static_cast<size_t>(cur_ - identStart)};
+            Keyword keyword = LookupKeyword(ident);
+            if (keyword != Keyword::None)
+                return Token{keyword, start};
+            return Token{Symbol{ident}, start};
         }
 
         bool eof() const {
-            return i_.peek() == EOF;
+            return cur_ == end_;
         }
 
-        char top() {
+        char top() const {
             assert(! eof());
-            return static_cast<char>(i_.peek());
+            return *cur_;
         }
 
         char pop() {
             assert(! eof());
-            char c = static_cast<char>(i_.get());
-            if (c == '\n') {
-                l_.col_ = 1;
-                ++l_.line_;
-            } else {
-                ++l_.col_;
-            }
-            return c;
+            return *cur_++;
+        }
+
+        SourceLocation location() const {
+            return SourceLocation{file_.id(), static_cast<uint32_t>(cur_ - file_.begin())};
+        }
+
+        uint32_t addIntegerLiteral(int64_t value) {
+            if (literals_ == nullptr)
+                return file_.addIntegerLiteral(value);
+            literals_->integers.push_back(value);
+            return static_cast<uint32_t>(literals_->integers.size() - 1);
+        }
+
+        uint32_t addDoubleLiteral(double value) {
+            if (literals_ == nullptr)
+                return file_.addDoubleLiteral(value);
+            literals_->doubles.push_back(value);
+            return static_cast<uint32_t>(literals_->doubles.size() - 1);
         }
 
         bool condPop(char c) {
@@ -495,11 +689,13 @@ namespace tiny {
             return true;
         }
 
-        std::istream & i_;
-        SourceLocation l_;
-
-        std::vector<Token> tokens_;
+        SourceFile & file_;
+        char const * cur_;
+        char const * end_;
+        /** Literal tables of the chunk when lexing in parallel, nullptr if the literals go directly to the file.
+         */
+        SourceFile::Literals * literals_ = nullptr;
 
     }; // tiny::Lexer
 
-} // namespace tiny
\ No newline at end of file
+} // namespace tiny
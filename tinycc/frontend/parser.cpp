@@ -2,64 +2,142 @@
 
 namespace tiny {
 
+    namespace {
+
+        constexpr uint8_t PrefixPrecedence = 11;
+
+        /** Precedence of binary operators indexed by their keyword, higher binds tighter. Tokens that are not binary operators have 0.
+         */
+        constexpr std::array<uint8_t, static_cast<size_t>(Keyword::Backtick) + 1> BinaryPrecedence = []() {
+            std::array<uint8_t, static_cast<size_t>(Keyword::Backtick) + 1> result{};
+            auto set = [&](Keyword k, uint8_t precedence) { result[static_cast<size_t>(k)] = precedence; };
+            set(Keyword::Or, 1);
+            set(Keyword::And, 2);
+            set(Keyword::BitOr, 3);
+            set(Keyword::BitAnd, 4);
+            set(Keyword::Eq, 5);
+            set(Keyword::NEq, 5);
+            set(Keyword::Lt, 6);
+            set(Keyword::Lte, 6);
+            set(Keyword::Gt, 6);
+            set(Keyword::Gte, 6);
+            set(Keyword::ShiftLeft, 7);
+            set(Keyword::ShiftRight, 7);
+            set(Keyword::Add, 8);
+            set(Keyword::Sub, 8);
+            set(Keyword::Mul, 9);
+            set(Keyword::Div, 9);
+            set(Keyword::Mod, 9);
+            return result;
+        }();
+
+        constexpr bool IsPrefixOperator(Keyword k) {
+            switch (k) {
+                case Keyword::Add:
+                case Keyword::Sub:
+                case Keyword::Not:
+                case Keyword::Neg:
+                case Keyword::Inc:
+                case Keyword::Dec:
+                case Keyword::Mul:
+                case Keyword::BitAnd:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+    }
+
     bool Parser::isTypeName(Symbol name) const {
         return possibleTypes_.find(name) != possibleTypes_.end();
     }
 
-    /* PROGRAM := { FUN_DECL | VAR_DECLS ';' | STRUCT_DECL | FUNPTR_DECL }
+    /* PROGRAM := { TOP_LEVEL_DECL }
+     */
+    std::unique_ptr<ASTProgram> Parser::PROGRAM() {
+        std::unique_ptr<ASTProgram> result{new ASTProgram{top()}};
+        arena_ = & result->arena;
+        while (! eof())
+            result->statements.push_back(TOP_LEVEL_DECL());
+        return result;
+    }
 
-        TODO the simple try & fail & try something else produces ugly error messages.
+    /* TOP_LEVEL_DECL := FUN_DECL | VAR_DECLS ';' | STRUCT_DECL | FUNPTR_DECL
+
+        Function and variable declarations both start with TYPE identifier, they are told apart by the '(' that follows in function declarations. The type itself is a single token followed by any number of '*', so the parser only needs to look ahead past them.
         */
-    std::unique_ptr<AST> Parser::PROGRAM() {
-        std::unique_ptr<ASTProgram> result{new ASTProgram{top()}};
-        while (! eof()) {
-            if (top() == Symbol::KwStruct) {
-                result->statements.push_back(STRUCT_DECL());
-            } else if (top() == Symbol::KwTypedef) {
-                result->statements.push_back(FUNPTR_DECL());
-            } else {
-                // it can be either function or variable declaration now, we just do the dirty trick by first parsing the type and identifier to determine whether we re dealing with a function or variable declaration, then revert the parser and parser the proper nonterminal this time
-                Position x = position();
-                TYPE(true);
-                IDENT();
-                if (top() == Symbol::ParOpen) {
-                    revertTo(x);
-                    result->statements.push_back(FUN_DECL());
-                } else {
-                    revertTo(x);
-                    result->statements.push_back(VAR_DECLS());
-                    pop(Symbol::Semicolon);
-                }
-            }
+    AST * Parser::TOP_LEVEL_DECL() {
+        switch (top().keyword()) {
+            case Keyword::Struct:
+                return STRUCT_DECL();
+            case Keyword::Typedef:
+                return FUNPTR_DECL();
+            default:
+                break;
         }
+        size_t i = 1;
+        while (peek(i) == Symbol::Mul)
+            ++i;
+        if (isTypeStart(top()) && isIdentifier(peek(i)) && peek(i + 1) == Symbol::ParOpen)
+            return FUN_DECL();
+        // if it is not a valid variable declaration either, VAR_DECLS reports the error
+        AST * result = VAR_DECLS();
+        pop(Symbol::Semicolon);
         return result;
     }
 
     /* FUN_DECL := TYPE_FUN_RET identifier '(' [ FUN_ARG { ',' FUN_ARG } ] ')' [ BLOCK_STMT ]
         FUN_ARG := TYPE identifier
         */
-    std::unique_ptr<AST> Parser::FUN_DECL() {
-        std::unique_ptr<ASTType> type{TYPE_FUN_RET()};
+    AST * Parser::FUN_DECL() {
+        ASTType * type = TYPE_FUN_RET();
         if (!isIdentifier(top()))
             throw ParserError{STR("Expected identifier, but " << top() << " found"), top().location()};
-        std::unique_ptr<ASTFunDecl> result{new ASTFunDecl{pop(), std::move(type)}};
+        ASTFunDecl * result = make<ASTFunDecl>(pop(), type, *arena_);
         pop(Symbol::ParOpen);
         if (top() != Symbol::ParClose) {
             do {
-                std::unique_ptr<ASTType> argType{TYPE()};
-                std::unique_ptr<ASTIdentifier> argName{IDENT()};
+                ASTType * argType = TYPE();
+                ASTIdentifier * argName = IDENT();
                 // check that the name is unique
                 for (auto & i : result->args)
                     if (i.second->name == argName->name)
                         throw ParserError{STR("Function argument " << argName->name << " altready defined"), argName->location()};
-                result->args.push_back(std::make_pair(std::move(argType), std::move(argName)));
+                result->args.push_back(std::make_pair(argType, argName));
 
             } while (condPop(Symbol::Comma));
         }
         pop(Symbol::ParClose);
         // if there is body, parse it, otherwise leave empty as it is just a declaration
-        if (top() == Symbol::CurlyOpen)
-            result->body = BLOCK_STMT();
+        if (top() == Symbol::CurlyOpen) {
+            if (lazyBodies_)
+                result->lazyBody = skipBlock();
+            else
+                result->body = BLOCK_STMT();
+        }
+        return result;
+    }
+
+    size_t Parser::skipBlock() {
+        size_t result = index();
+        pop(Symbol::CurlyOpen);
+        size_t depth = 1;
+        while (depth > 0) {
+            switch (top().keyword()) {
+                case Keyword::CurlyOpen:
+                    ++depth;
+                    break;
+                case Keyword::CurlyClose:
+                    --depth;
+                    break;
+                default:
+                    if (eof())
+                        throw ParserError{STR("Expected " << Symbol::CurlyClose << ", but " << top() << " found"), top().location()};
+                    break;
+            }
+            pop();
+        }
         return result;
     }
 
@@ -67,34 +145,36 @@ namespace tiny {
 
     /* STATEMENT := BLOCK_STMT | IF_STMT | SWITCH_STMT | WHILE_STMT | DO_WHILE_STMT | FOR_STMT | BREAK_STMT | CONTINUE_STMT | RETURN_STMT | EXPR_STMT
         */
-    std::unique_ptr<AST> Parser::STATEMENT() {
-        if (top() == Symbol::CurlyOpen)
-            return BLOCK_STMT();
-        else if (top() == Symbol::KwIf)
-            return IF_STMT();
-        else if (top() == Symbol::KwSwitch)
-            return SWITCH_STMT();
-        else if (top() == Symbol::KwWhile)
-            return WHILE_STMT();
-        else if (top() == Symbol::KwDo)
-            return DO_WHILE_STMT();
-        else if (top() == Symbol::KwFor)
-            return FOR_STMT();
-        else if (top() == Symbol::KwBreak)
-            return BREAK_STMT();
-        else if (top() == Symbol::KwContinue)
-            return CONTINUE_STMT();
-        else if (top() == Symbol::KwReturn)
-            return RETURN_STMT();
-        else 
-            // TODO this would produce not especially nice error as we are happy with statements too
-            return EXPR_STMT();
+    AST * Parser::STATEMENT() {
+        switch (top().keyword()) {
+            case Keyword::CurlyOpen:
+                return BLOCK_STMT();
+            case Keyword::If:
+                return IF_STMT();
+            case Keyword::Switch:
+                return SWITCH_STMT();
+            case Keyword::While:
+                return WHILE_STMT();
+            case Keyword::Do:
+                return DO_WHILE_STMT();
+            case Keyword::For:
+                return FOR_STMT();
+            case Keyword::Break:
+                return BREAK_STMT();
+            case Keyword::Continue:
+                return CONTINUE_STMT();
+            case Keyword::Return:
+                return RETURN_STMT();
+            default:
+                // TODO this would produce not especially nice error as we are happy with statements too
+                return EXPR_STMT();
+        }
     }
 
     /* BLOCK_STMT := '{' { STATEMENT } '}'
         */
-    std::unique_ptr<AST> Parser::BLOCK_STMT() {
-        std::unique_ptr<ASTBlock> result{new ASTBlock{pop(Symbol::CurlyOpen)}};
+    AST * Parser::BLOCK_STMT() {
+        ASTBlock * result = make<ASTBlock>(pop(Symbol::CurlyOpen), *arena_);
         while (!condPop(Symbol::CurlyClose))
             result->body.push_back(STATEMENT());
         return result;
@@ -102,8 +182,8 @@ namespace tiny {
 
     /* IF_STMT := if '(' EXPR ')' STATEMENT [ else STATEMENT ]
         */
-    std::unique_ptr<ASTIf> Parser::IF_STMT() {
-        std::unique_ptr<ASTIf> result{new ASTIf{pop(Symbol::KwIf)}};
+    ASTIf * Parser::IF_STMT() {
+        ASTIf * result = make<ASTIf>(pop(Symbol::KwIf));
         pop(Symbol::ParOpen);
         result->cond = EXPR();
         pop(Symbol::ParClose);
@@ -116,8 +196,8 @@ namespace tiny {
     /* SWITCH_STMT := switch '(' EXPR ')' '{' { CASE_STMT } [ default ':' CASE_BODY ] { CASE_STMT } '}'
         CASE_STMT := case integer_literal ':' CASE_BODY
         */
-    std::unique_ptr<AST> Parser::SWITCH_STMT() {
-        std::unique_ptr<ASTSwitch> result{new ASTSwitch{pop(Symbol::KwSwitch)}};
+    AST * Parser::SWITCH_STMT() {
+        ASTSwitch * result = make<ASTSwitch>(pop(Symbol::KwSwitch), *arena_);
         pop(Symbol::ParOpen);
         result->cond = EXPR();
         pop(Symbol::ParClose);
@@ -129,13 +209,14 @@ namespace tiny {
                 pop();
                 pop(Symbol::Colon);
                 auto tmp = CASE_BODY();
-                result->defaultCase = tmp.get();
-                result->cases.emplace_back(0, std::move(tmp));
+                result->defaultCase = tmp;
+                result->cases.emplace_back(0, tmp);
             } else if (condPop(Symbol::KwCase)) {
                 Token const & t = top();
-                int value = pop(Token::Kind::Integer).valueInt();
+                int64_t value = pop(Token::Kind::Integer).valueInt();
+                // the default case is in the list too, but has no value
                 auto it = result->cases.begin();
-                while(it != result->cases.end() && it->first != value ){
+                while(it != result->cases.end() && (it->first != value || it->second == result->defaultCase)){
                     it++;
                 }
 //                if (result->cases.find(value) != result->cases.end())
@@ -154,8 +235,8 @@ namespace tiny {
 
         Can be empty if followed by case, default, ot `}`.
         */
-    std::unique_ptr<AST> Parser::CASE_BODY() {
-        std::unique_ptr<ASTBlock> result{ new ASTBlock{top()}};
+    AST * Parser::CASE_BODY() {
+        ASTBlock * result = make<ASTBlock>(top(), *arena_);
         while (top() != Symbol::KwCase && top() != Symbol::KwDefault && top() != Symbol::CurlyClose) {
             result->body.push_back(STATEMENT());
         }
@@ -164,8 +245,8 @@ namespace tiny {
 
     /* WHILE_STMT := while '(' EXPR ')' STATEMENT
         */
-    std::unique_ptr<AST> Parser::WHILE_STMT() {
-        std::unique_ptr<ASTWhile> result{new ASTWhile{pop(Symbol::KwWhile)}};
+    AST * Parser::WHILE_STMT() {
+        ASTWhile * result = make<ASTWhile>(pop(Symbol::KwWhile));
         pop(Symbol::ParOpen);
         result->cond = EXPR();
         pop(Symbol::ParClose);
@@ -175,8 +256,8 @@ namespace tiny {
 
     /* DO_WHILE_STMT := do STATEMENT while '(' EXPR ')' ';'
         */
-    std::unique_ptr<AST> Parser::DO_WHILE_STMT() {
-        std::unique_ptr<ASTDoWhile> result{new ASTDoWhile{pop(Symbol::KwDo)}};
+    AST * Parser::DO_WHILE_STMT() {
+        ASTDoWhile * result = make<ASTDoWhile>(pop(Symbol::KwDo));
         result->body = STATEMENT();
         pop(Symbol::KwWhile);
         pop(Symbol::ParOpen);
@@ -188,8 +269,8 @@ namespace tiny {
 
     /* FOR_STMT := for '(' [ EXPR_OR_VAR_DECL ] ';' [ EXPR ] ';' [ EXPR ] ')' STATEMENT
         */
-    std::unique_ptr<AST> Parser::FOR_STMT() {
-        std::unique_ptr<ASTFor> result{new ASTFor{pop(Symbol::KwFor)}};
+    AST * Parser::FOR_STMT() {
+        ASTFor * result = make<ASTFor>(pop(Symbol::KwFor));
         pop(Symbol::ParOpen);
         if (top() != Symbol::Semicolon)
             result->init = EXPR_OR_VAR_DECL();
@@ -208,8 +289,8 @@ namespace tiny {
 
         The parser allows break statement even when there is no loop or switch around it. This has to be fixed in the translator.
         */
-    std::unique_ptr<AST> Parser::BREAK_STMT() {
-        std::unique_ptr<AST> result{new ASTBreak{pop(Symbol::KwBreak)}};
+    AST * Parser::BREAK_STMT() {
+        AST * result = make<ASTBreak>(pop(Symbol::KwBreak));
         pop(Symbol::Semicolon);
         return result;
     }
@@ -218,16 +299,16 @@ namespace tiny {
 
         The parser allows continue statement even when there is no loop around it. This has to be fixed in the translator.
         */
-    std::unique_ptr<AST> Parser::CONTINUE_STMT() {
-        std::unique_ptr<AST> result{new ASTContinue{pop(Symbol::KwContinue)}};
+    AST * Parser::CONTINUE_STMT() {
+        AST * result = make<ASTContinue>(pop(Symbol::KwContinue));
         pop(Symbol::Semicolon);
         return result;
     }
 
     /* RETURN_STMT := return [ EXPR ] ';'
         */
-    std::unique_ptr<ASTReturn> Parser::RETURN_STMT() {
-        std::unique_ptr<ASTReturn> result{new ASTReturn{pop(Symbol::KwReturn)}};
+    ASTReturn * Parser::RETURN_STMT() {
+        ASTReturn * result = make<ASTReturn>(pop(Symbol::KwReturn));
         if (top() != Symbol::Semicolon)
             result->value = EXPR();
         pop(Symbol::Semicolon);
@@ -236,8 +317,8 @@ namespace tiny {
 
     /* EXPR_STMT := EXPR_OR_VAR_DECL ';'
 '         */
-    std::unique_ptr<AST> Parser::EXPR_STMT() {
-        std::unique_ptr<AST> result{EXPR_OR_VAR_DECL()};
+    AST * Parser::EXPR_STMT() {
+        AST * result = EXPR_OR_VAR_DECL();
         pop(Symbol::Semicolon);
         return result;
     }
@@ -249,30 +330,35 @@ namespace tiny {
 
         The identifier must be a typename.
         */
-    std::unique_ptr<ASTType> Parser::TYPE(bool canBeVoid) {
-        std::unique_ptr<ASTType> result;
-        if (top() == Symbol::KwVoid) {
-            result.reset(new ASTNamedType{pop()});
-            // if it can't be void, it must be void*
-            if (!canBeVoid)
-                result.reset(new ASTPointerType{pop(Symbol::Mul), std::move(result)});
-        } else {
-            if (top() == Symbol::KwInt || top() == Symbol::KwChar || top() == Symbol::KwDouble)
-                result.reset(new ASTNamedType{pop()});
-            else if (isIdentifier(top()) && isTypeName(top().valueSymbol()))
-                result.reset(new ASTNamedType{pop()});
-            else
-                throw ParserError{STR("Expected type, but " << top() << " found"), top().location()};
+    ASTType * Parser::TYPE(bool canBeVoid) {
+        ASTType * result = nullptr;
+        switch (top().keyword()) {
+            case Keyword::Void:
+                result = make<ASTNamedType>(pop());
+                // if it can't be void, it must be void*
+                if (!canBeVoid)
+                    result = make<ASTPointerType>(pop(Symbol::Mul), result);
+                break;
+            case Keyword::Int:
+            case Keyword::Char:
+            case Keyword::Double:
+                result = make<ASTNamedType>(pop());
+                break;
+            default:
+                if (isIdentifier(top()) && isTypeName(top().valueSymbol()))
+                    result = make<ASTNamedType>(pop());
+                else
+                    throw ParserError{STR("Expected type, but " << top() << " found"), top().location()};
         }
         // deal with pointers to pointers
         while (top() == Symbol::Mul)
-            result.reset(new ASTPointerType{pop(Symbol::Mul), std::move(result)});
+            result = make<ASTPointerType>(pop(Symbol::Mul), result);
         return result;
     }
 
     /* TYPE_FUN_RET := void | TYPE
         */
-    std::unique_ptr<ASTType> Parser::TYPE_FUN_RET() {
+    ASTType * Parser::TYPE_FUN_RET() {
         return TYPE(true);
     }
 
@@ -280,19 +366,19 @@ namespace tiny {
 
     /* STRUCT_TYPE_DECL := struct identifier [ '{' { TYPE identifier ';' } '}' ] ';'
         */
-    std::unique_ptr<ASTStructDecl> Parser::STRUCT_DECL() {
+    ASTStructDecl * Parser::STRUCT_DECL() {
         Token const & start = pop(Symbol::KwStruct);
-        std::unique_ptr<ASTStructDecl> decl{new ASTStructDecl{start, pop(Token::Kind::Identifier).valueSymbol()}};
+        ASTStructDecl * decl = make<ASTStructDecl>(start, pop(Token::Kind::Identifier).valueSymbol(), *arena_);
         addTypeName(decl->name);
         if (condPop(Symbol::CurlyOpen)) {
             while (! condPop(Symbol::CurlyClose)) {
-                std::unique_ptr<ASTType> type{TYPE()};
-                decl->fields.push_back(std::make_pair(IDENT(), std::move(type)));
+                ASTType * type = TYPE();
+                decl->fields.push_back(std::make_pair(IDENT(), type));
                 if (condPop(Symbol::SquareOpen)) {
-                    std::unique_ptr<AST> index{E9()};
+                    AST * index = E9();
                     pop(Symbol::SquareClose);
                     // now we have to update the type
-                    decl->fields.back().second.reset(new ASTArrayType{start, std::move(decl->fields.back().second), std::move(index) });
+                    decl->fields.back().second = make<ASTArrayType>(start, decl->fields.back().second, index);
                 }
                 pop(Symbol::Semicolon);
             }
@@ -305,16 +391,16 @@ namespace tiny {
     /* FUNPTR_TYPE_DECL := typedef TYPE_FUN_RET '(' '*' identifier ')' '(' [ TYPE { ',' TYPE } ] ')' ';'
         */
 
-    std::unique_ptr<ASTFunPtrDecl> Parser::FUNPTR_DECL() {
+    ASTFunPtrDecl * Parser::FUNPTR_DECL() {
         Token const & start = pop(Symbol::KwTypedef);
-        std::unique_ptr<ASTType> returnType{TYPE_FUN_RET()};
+        ASTType * returnType = TYPE_FUN_RET();
         pop(Symbol::ParOpen);
         pop(Symbol::Mul);
-        std::unique_ptr<ASTIdentifier> name{IDENT()};
+        ASTIdentifier * name = IDENT();
         addTypeName(name->name);
         pop(Symbol::ParClose);
         pop(Symbol::ParOpen);
-        std::unique_ptr<ASTFunPtrDecl> result{new ASTFunPtrDecl{start, std::move(name), std::move(returnType)}};
+        ASTFunPtrDecl * result = make<ASTFunPtrDecl>(start, name, returnType, *arena_);
         if (top() != Symbol::ParClose) {
             result->args.push_back(TYPE());
             while (condPop(Symbol::Comma))
@@ -329,33 +415,25 @@ namespace tiny {
 
     /* EXPR_OR_VAR_DECL := ( EXPR | VAR_DECL)  { ',' ( EXPR | VAR_DECL ) }
 
-        We can either be smart and play with FIRST and FOLLOW sets, or we can be lazy and just do the simple thing - try TYPE first and if it fails, try EXPR.
-
-        I am lazy.
+        No expression can start with a type, so the first token decides.
         */
-    std::unique_ptr<AST> Parser::EXPR_OR_VAR_DECL() {
-        Position x = position();
-        try {
-            TYPE();
-        } catch (...) {
-            revertTo(x);
-            return EXPRS();
-        }
-        revertTo(x);
-        return VAR_DECLS();
+    AST * Parser::EXPR_OR_VAR_DECL() {
+        if (isTypeStart(top()))
+            return VAR_DECLS();
+        return EXPRS();
     }
 
     /* VAR_DECL := TYPE identifier [ '[' E9 ']' ] [ '=' EXPR ]
         */
-    std::unique_ptr<ASTVarDecl> Parser::VAR_DECL() {
+    ASTVarDecl * Parser::VAR_DECL() {
         Token const & start = top();
-        std::unique_ptr<ASTVarDecl> decl{new ASTVarDecl{start, TYPE()}};
+        ASTVarDecl * decl = make<ASTVarDecl>(start, TYPE());
         decl->name = IDENT();
         if (condPop(Symbol::SquareOpen)) {
-            std::unique_ptr<AST> index{E9()};
+            AST * index = E9();
             pop(Symbol::SquareClose);
             // now we have to update the type
-            decl->varType.reset(new ASTArrayType{start, std::move(decl->varType), std::move(index) });
+            decl->varType = make<ASTArrayType>(start, decl->varType, index);
         }
         if (condPop(Symbol::Assign))
             decl->value = EXPR();
@@ -364,8 +442,8 @@ namespace tiny {
 
     /* VAR_DECLS := VAR_DECL { ',' VAR_DECL }
         */
-    std::unique_ptr<AST> Parser::VAR_DECLS() {
-        std::unique_ptr<ASTSequence> result{new ASTSequence{top()}};
+    AST * Parser::VAR_DECLS() {
+        ASTSequence * result = make<ASTSequence>(top(), *arena_);
         result->body.push_back(VAR_DECL());
         while (condPop(Symbol::Comma))
             result->body.push_back(VAR_DECL());
@@ -376,147 +454,72 @@ namespace tiny {
 
         Note that assignment is right associative.
         */
-    std::unique_ptr<AST> Parser::EXPR() {
-        std::unique_ptr<AST> result{E9()};
+    AST * Parser::EXPR() {
+        AST * result = E9();
         if (top() == Symbol::Assign) {
             Token const & op = pop();
-            result.reset(new ASTAssignment{op, std::move(result), EXPR()});
+            result = make<ASTAssignment>(op, result, EXPR());
         }
         return result;
     }
 
     /* EXPRS := EXPR { ',' EXPR }
         */
-    std::unique_ptr<AST> Parser::EXPRS() {
-        std::unique_ptr<ASTSequence> result{new ASTSequence{top()}};
+    AST * Parser::EXPRS() {
+        ASTSequence * result = make<ASTSequence>(top(), *arena_);
         result->body.push_back(EXPR());
         while (condPop(Symbol::Comma))
             result->body.push_back(EXPR());
         if (result->body.size() == 1)
-            return std::move(result->body[0]);
+            return result->body[0];
         else
             return result;
     }
 
 
-    /* E9 := E8 { '||' E8 }
-        */
-    std::unique_ptr<AST> Parser::E9() {
-        std::unique_ptr<AST> result{E8()};
-        while (top() == Symbol::Or) {
-            Token const & op = pop();
-            result.reset(new ASTBinaryOp{op, std::move(result), E8()});
-        }
-        return result;
-    }
-
-    /* E8 := E7 { '&&' E7 }
-        */
-    std::unique_ptr<AST> Parser::E8() {
-        std::unique_ptr<AST> result{E7()};
-        while (top() == Symbol::And) {
-            Token const & op = pop();
-            result.reset(new ASTBinaryOp{op, std::move(result), E7()});
-        }
-        return result;
-    }
-
-    /* E7 := E6 { '|' E6 }
-        */
-    std::unique_ptr<AST> Parser::E7() {
-        std::unique_ptr<AST> result{E6()};
-        while (top() == Symbol::BitOr) {
-            Token const & op = pop();
-            result.reset(new ASTBinaryOp{op, std::move(result), E6()});
-        }
-        return result;
-    }
-
-    /* E6 := E5 { '&' E5 }
-        */
-    std::unique_ptr<AST> Parser::E6() {
-        std::unique_ptr<AST> result{E5()};
-        while (top() == Symbol::BitAnd) {
-            Token const & op = pop();
-            result.reset(new ASTBinaryOp{op, std::move(result), E5()});
-        }
-        return result;
-    }
-
-    /* E5 := E4 { ('==' | '!=') E4 }
-        */
-    std::unique_ptr<AST> Parser::E5() {
-        std::unique_ptr<AST> result{E4()};
-        while (top() == Symbol::Eq || top() == Symbol::NEq) {
-            Token const & op = pop();
-            result.reset(new ASTBinaryOp{op, std::move(result), E4()});
-        }
-        return result;
-    }
-
-    /* E4 := E3 { ('<' | '<=' | '>' | '>=') E3 }
-        */
-    std::unique_ptr<AST> Parser::E4() {
-        std::unique_ptr<AST> result{E3()};
-        while (top() == Symbol::Lt || top() == Symbol::Lte || top() == Symbol::Gt || top() == Symbol::Gte) {
-            Token const & op = pop();
-            result.reset(new ASTBinaryOp{op, std::move(result), E3()});
-        }
-        return result;
-    }
-
-    /* E3 := E2 { ('<<' | '>>') E2 }
-        */
-    std::unique_ptr<AST> Parser::E3() {
-        std::unique_ptr<AST> result{E2()};
-        while (top() == Symbol::ShiftLeft || top() == Symbol::ShiftRight) {
-            Token const & op = pop();
-            result.reset(new ASTBinaryOp{op, std::move(result), E2()});
-        }
-        return result;
-    }
-
-    /* E2 := E1 { ('+' | '-') E1 }
-        */
-    std::unique_ptr<AST> Parser::E2() {
-        std::unique_ptr<AST> result{E1()};
-        while (top() == Symbol::Add || top() == Symbol::Sub) {
-            Token const & op = pop();
-            result.reset(new ASTBinaryOp{op, std::move(result), E1()});
-        }
-        return result;
-    }
-
-    /* E1 := E_UNARY_PRE { ('*' | '/' | '%' ) E_UNARY_PRE }
-        */
-    std::unique_ptr<AST> Parser::E1() {
-        std::unique_ptr<AST> result{E_UNARY_PRE()};
-        while (top() == Symbol::Mul || top() == Symbol::Div || top() == Symbol::Mod) {
-            Token const & op = pop();
-            result.reset(new ASTBinaryOp{op, std::move(result), E_UNARY_PRE()});
-        }
-        return result;
-    }
-
-    /* E_UNARY_PRE := { '+' | '-' | '!' | '~' | '++' | '--' | '*' | '&' } E_CALL_INDEX_MEMBER_POST
-        */
-    std::unique_ptr<AST> Parser::E_UNARY_PRE() {
-        if (top() == Symbol::Add || top() == Symbol::Sub
-                || top() == Symbol::Not
-                || top() == Symbol::Neg
-                || top() == Symbol::Inc
-                || top() == Symbol::Dec) {
-            Token const & op = pop();
-            return std::unique_ptr<AST>{new ASTUnaryOp{op, E_UNARY_PRE()}};
-        } else if (top() == Symbol::Mul) {
-            Token const & op = pop();
-            return std::unique_ptr<AST>{new ASTDeref{op, E_UNARY_PRE()}};
-        } else if (top() == Symbol::BitAnd) {
-            Token const & op = pop();
-            return std::unique_ptr<AST>{new ASTAddress{op, E_UNARY_PRE()}};
-        } else {
-            return E_CALL_INDEX_MEMBER_POST();
+    /* E9 := E_UNARY_PRE { BINARY_OP E_UNARY_PRE }
+        E_UNARY_PRE := { '+' | '-' | '!' | '~' | '++' | '--' | '*' | '&' } E_CALL_INDEX_MEMBER_POST
+        BINARY_OP := '||' | '&&' | '|' | '&' | '==' | '!=' | '<' | '<=' | '>' | '>=' | '<<' | '>>' | '+' | '-' | '*' | '/' | '%'
+
+        Binary operators are left associative, their precedence is given by the BinaryPrecedence table, prefix operators bind tighter than any binary operator.
+
+        Instead of a function per precedence level, the expression is parsed by precedence climbing with explicit stacks of pending operators and operands. Each operator is thus handled by a single iteration and the depth of the expression does not consume the C++ stack. An operator is reduced when an operator of the same or lower precedence follows it, so the operator stack always holds operators of increasing precedence.
+        */
+    AST * Parser::E9() {
+        struct Pending {
+            Token op;
+            uint8_t precedence;
+        };
+        std::vector<Pending> ops;
+        std::vector<AST *> operands;
+        auto reduce = [&](uint8_t precedence) {
+            while (! ops.empty() && ops.back().precedence >= precedence) {
+                Token op = ops.back().op;
+                bool prefix = ops.back().precedence == PrefixPrecedence;
+                ops.pop_back();
+                AST * arg = operands.back();
+                operands.pop_back();
+                if (! prefix)
+                    operands.back() = make<ASTBinaryOp>(op, operands.back(), arg);
+                else if (op == Symbol::Mul)
+                    operands.push_back(make<ASTDeref>(op, arg));
+                else if (op == Symbol::BitAnd)
+                    operands.push_back(make<ASTAddress>(op, arg));
+                else
+                    operands.push_back(make<ASTUnaryOp>(op, arg));
+            }
+        };
+        while (true) {
+            while (IsPrefixOperator(top().keyword()))
+                ops.push_back(Pending{pop(), PrefixPrecedence});
+            operands.push_back(E_CALL_INDEX_MEMBER_POST());
+            uint8_t precedence = BinaryPrecedence[static_cast<size_t>(top().keyword())];
+            reduce(precedence);
+            if (precedence == 0)
+                break;
+            ops.push_back(Pending{pop(), precedence});
         }
+        return operands.back();
     }
 
     /* E_CALL_INDEX_MEMBER_POST := F { E_CALL | E_INDEX | E_MEMBER | E_POST }
@@ -525,31 +528,31 @@ namespace tiny {
         E_MEMBER := ('.' | '->') identifier
         E_POST := '++' | '--'
         */
-    std::unique_ptr<AST> Parser::E_CALL_INDEX_MEMBER_POST() {
-        std::unique_ptr<AST> result{F()};
+    AST * Parser::E_CALL_INDEX_MEMBER_POST() {
+        AST * result = F();
         while (true) {
             if (top() == Symbol::ParOpen) {
-                std::unique_ptr<ASTCall> call{new ASTCall{pop(), std::move(result)}};
+                ASTCall * call = make<ASTCall>(pop(), result, *arena_);
                 if (top() != Symbol::ParClose) {
                     call->args.push_back(EXPR());
                     while (condPop(Symbol::Comma))
                         call->args.push_back(EXPR());
                 }
                 pop(Symbol::ParClose);
-                result.reset(call.release());
+                result = call;
             } else if (top() == Symbol::SquareOpen) {
                 Token const & op = pop();
-                result.reset(new ASTIndex{op, std::move(result), EXPR()});
+                result = make<ASTIndex>(op, result, EXPR());
                 pop(Symbol::SquareClose);
             } else if (top() == Symbol::Dot) {
                 Token const & op = pop();
-                result.reset(new ASTMember{op, std::move(result), pop(Token::Kind::Identifier).valueSymbol()});
+                result = make<ASTMember>(op, result, pop(Token::Kind::Identifier).valueSymbol());
             } else if (top() == Symbol::ArrowR) {
                 Token const & op = pop();
-                result.reset(new ASTMemberPtr{op, std::move(result), pop(Token::Kind::Identifier).valueSymbol()});
+                result = make<ASTMemberPtr>(op, result, pop(Token::Kind::Identifier).valueSymbol());
             } else if (top() == Symbol::Inc || top() == Symbol::Dec) {
                 Token const & op = pop();
-                result.reset(new ASTUnaryPostOp{op, std::move(result)});
+                result = make<ASTUnaryPostOp>(op, result);
             } else {
                 break;
             }
@@ -560,24 +563,24 @@ namespace tiny {
     /* F := integer | double | char | string | identifier | '(' EXPR ')' | E_CAST
         E_CAST := cast '<' TYPE '>' '(' EXPR ')'
         */
-    std::unique_ptr<AST> Parser::F() {
+    AST * Parser::F() {
         if (top() == Token::Kind::Integer) {
-            return std::unique_ptr<AST>{new ASTInteger{pop()}};
+            return make<ASTInteger>(pop());
         } else if (top() == Token::Kind::Double) {
-            return std::unique_ptr<AST>{new ASTDouble{pop()}};
+            return make<ASTDouble>(pop());
         } else if (top() == Token::Kind::StringSingleQuoted) {
-            return std::unique_ptr<AST>{new ASTChar{pop()}};
+            return make<ASTChar>(pop());
         } else if (top() == Token::Kind::StringDoubleQuoted) {
-            return std::unique_ptr<AST>{new ASTString{pop()}};
+            return make<ASTString>(pop(), *arena_);
         } else if (top() == Symbol::KwCast) {
             Token op = pop();
             pop(Symbol::Lt);
-            std::unique_ptr<ASTType> type{TYPE()};
+            ASTType * type = TYPE();
             pop(Symbol::Gt);
             pop(Symbol::ParOpen);
-            std::unique_ptr<AST> expr(EXPR());
+            AST * expr = EXPR();
             pop(Symbol::ParClose);
-            return std::unique_ptr<AST>{new ASTCast{op, std::move(expr), std::move(type)}};
+            return make<ASTCast>(op, expr, type);
         }
         else if (top() == Token::Kind::Identifier) {
             return IDENT();
@@ -586,10 +589,10 @@ namespace tiny {
         }
     }
 
-    std::unique_ptr<ASTIdentifier> Parser::IDENT() {
+    ASTIdentifier * Parser::IDENT() {
         if (!isIdentifier(top()) || isTypeName(top().valueSymbol()))
             throw ParserError{STR("Expected identifier, but " << top() << " found"), top().location()};
-        return std::unique_ptr<ASTIdentifier>{new ASTIdentifier{pop()}};
+        return make<ASTIdentifier>(pop());
     }
 
 }
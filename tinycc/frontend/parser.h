@@ -4,21 +4,28 @@
 
 #include "common/symbol.h"
 #include "ast.h"
+#include "token_stream.h"
 
 namespace tiny {
 
     class Parser {
     public:
 
+        /** Large files are lexed in parallel up front, the rest is lexed on demand while parsing.
+         */
         static std::unique_ptr<AST> parseFile(std::string const &filename) {
-            Parser p{Lexer::TokenizeFile(filename)};
+            return parseFile(SourceFile::Open(filename));
+        }
+
+        static std::unique_ptr<AST> parseFile(SourceFile & file) {
+            Parser p = file.size() >= Lexer::ParallelThreshold ? Parser{Lexer::TokenizeFile(file)} : Parser{Lexer{file}};
             std::unique_ptr<AST> result{p.PROGRAM()};
             p.pop(Token::Kind::EoF);
             return result;
         }
 
         static std::unique_ptr<AST> parse(std::string const &source) {
-            Parser p{Lexer::Tokenize(source, "")};
+            Parser p{Lexer{SourceFile::FromText(source, "")}};
             std::unique_ptr<AST> result{p.PROGRAM()};
             p.pop(Token::Kind::EoF);
             return result;
@@ -26,56 +33,55 @@ namespace tiny {
 
     protected:
 
-        /** We need new position because when reverting, the tentative types names that were created *after* the savepoint must be unrolled as well.
-         */
-        class Position {
-        private:
-            friend class Parser;
-
-            Position(size_t i, size_t typesSize) : i_{i}, typesSize_{typesSize} {
-            }
+        Parser(Lexer && lexer) : tokens_{std::move(lexer)} {
+        }
 
-            size_t i_;
-            size_t typesSize_;
-        };
+        /** Parses already lexed tokens, starting at given index.
+         */
+        Parser(std::vector<Token> && tokens, size_t start = 0) : tokens_{std::move(tokens), start} {
+        }
 
-        Parser(std::vector<Token> &&tokens) : tokens_{std::move(tokens)} {
+        /** Index of the current token.
+         */
+        size_t index() const {
+            return tokens_.index();
         }
 
-        Position position() const {
-            return Position{i_, possibleTypesStack_.size()};
+        /** Returns the tokens the parser was created from, see TokenStream::takeTokens().
+         */
+        std::vector<Token> takeTokens() {
+            return tokens_.takeTokens();
         }
 
-        void revertTo(Position const &p) {
-            i_ = p.i_;
-            while (possibleTypesStack_.size() > p.typesSize_) {
-                possibleTypes_.erase(possibleTypesStack_.back());
-                possibleTypesStack_.pop_back();
-            }
+        /** Moves to given token, which may be anywhere in the input. Only for parsers of already lexed tokens.
+         */
+        void restart(size_t index) {
+            tokens_.restart(index);
         }
 
         bool eof() const {
-            return i_ == tokens_.size() - 1;
+            return tokens_.top() == Token::Kind::EoF;
         }
 
-        Token const &top() const {
-            return tokens_[i_];
+        /** Tokens are returned by value as the stream only holds on to them while they may still be needed.
+         */
+        Token top() const {
+            return tokens_.top();
         }
 
-        Token const &pop() {
-            Token const &result = top();
-            if (i_ != tokens_.size() - 1)
-                ++i_;
+        Token pop() {
+            Token result = top();
+            tokens_.advance();
             return result;
         }
 
-        Token const &pop(Token::Kind kind) {
+        Token pop(Token::Kind kind) {
             if (top().kind() != kind)
                 throw ParserError{STR("Expected " << kind << ", but " << top() << " found"), top().location()};
             return pop();
         }
 
-        Token const &pop(Symbol symbol) {
+        Token pop(Symbol symbol) {
             if ((top().kind() != Token::Kind::Identifier && top().kind() != Token::Kind::Operator) || top().valueSymbol() != symbol)
                 throw ParserError{STR("Expected " << symbol << ", but " << top() << " found"), top().location()};
             return pop();
@@ -95,21 +101,16 @@ namespace tiny {
             return true;
         }
 
-        Token const &peek(int offset) {
-            int index = static_cast<int>(i_) + offset;
-            if (index < 0 || index >= static_cast<int>(tokens_.size()))
-                index = static_cast<int>(tokens_.size()) - 1;
-            return tokens_[index];
+        /** Returns the token offset tokens ahead of the current one.
+         */
+        Token peek(size_t offset) {
+            return tokens_.lookahead(offset);
         }
 
         /** Determines if given token is a valid user identifier.
          */
         bool isIdentifier(Token const & t) {
-            if (t != Token::Kind::Identifier)
-                return false;
-            if (t == Symbol::KwBreak || t == Symbol::KwCase || t == Symbol::KwCast || t == Symbol::KwChar || t == Symbol::KwContinue || t == Symbol::KwDefault || t == Symbol::KwDo || t == Symbol::KwDouble || t == Symbol::KwElse || t == Symbol::KwFor || t == Symbol::KwIf || t == Symbol::KwInt || t == Symbol::KwReturn || t == Symbol::KwStruct || t == Symbol::KwSwitch || t == Symbol::KwTypedef || t == Symbol::KwVoid || t == Symbol::KwWhile)
-                return false;
-            return true;
+            return t == Token::Kind::Identifier && ! IsReservedWord(t.keyword());
         }
 
         /** \name Types Ambiguity
@@ -120,71 +121,91 @@ namespace tiny {
 
             Is this declaration of variable of name `a` with type `foo*`, or is this multiplication of two variables `foo` and `a`. Ideally this ambiguity should be solved at the grammar level such as introducing `var` keyword, or some such, but for educational purposes we have decided to keep this "feature" in the language.
 
-            The way to fix this is to make the parser track all possible type names so that an identifier can be resolved as being either variable, or a type, thus removing the ambiguity.
+            The way to fix this is to make the parser track all possible type names so that an identifier can be resolved as being either variable, or a type, thus removing the ambiguity. With the type names known, the first token of a statement decides whether it is a declaration, so the parser never has to backtrack.
          */
 
         std::unordered_set<Symbol> possibleTypes_;
-        std::vector<Symbol> possibleTypesStack_;
 
         /** Returns true if given symbol is a type.
-
-            Checks both own tentative records and the frontend's valid records.
          */
         bool isTypeName(Symbol name) const;
 
-        /** Adds given symbol as a tentative typename.
+        /** Returns true if given token starts a type, i.e. it is either a builtin type, or a type name.
+         */
+        bool isTypeStart(Token const & t) {
+            switch (t.keyword()) {
+                case Keyword::Void:
+                case Keyword::Int:
+                case Keyword::Char:
+                case Keyword::Double:
+                    return true;
+                default:
+                    return isIdentifier(t) && isTypeName(t.valueSymbol());
+            }
+        }
+
+        /** Adds given symbol as a typename.
 
             Note that same typename can be added multiple times for forward declared structs.
          */
         void addTypeName(Symbol name) {
             possibleTypes_.insert(name);
-            possibleTypesStack_.push_back(name);
         }
 
+        /** Creates a node in the arena of the program being parsed.
+         */
+        template<typename T, typename... ARGS>
+        T * make(ARGS &&... args) {
+            return arena_->make<T>(std::forward<ARGS>(args)...);
+        }
+
+        /** Arena of the program being parsed, set by PROGRAM().
+         */
+        Arena * arena_ = nullptr;
+
+        /** When set, FUN_DECL skips function bodies and only records where they start, see ASTFunDecl::lazyBody.
+         */
+        bool lazyBodies_ = false;
+
+        /** Skips a block by matching its braces without parsing it and returns the index of its opening brace.
+         */
+        size_t skipBlock();
+
         /*  Parsing
 
             Nothing fancy here, just a very simple recursive descent parser built on the basic framework.
          */
-        std::unique_ptr<AST> PROGRAM();
-        std::unique_ptr<AST> FUN_DECL();
-        std::unique_ptr<AST> STATEMENT();
-        std::unique_ptr<AST> BLOCK_STMT();
-        std::unique_ptr<ASTIf> IF_STMT();
-        std::unique_ptr<AST> SWITCH_STMT();
-        std::unique_ptr<AST> CASE_BODY();
-        std::unique_ptr<AST> WHILE_STMT();
-        std::unique_ptr<AST> DO_WHILE_STMT();
-        std::unique_ptr<AST> FOR_STMT();
-        std::unique_ptr<AST> BREAK_STMT();
-        std::unique_ptr<AST> CONTINUE_STMT();
-        std::unique_ptr<ASTReturn> RETURN_STMT();
-        std::unique_ptr<AST> EXPR_STMT();
-        std::unique_ptr<ASTType> TYPE(bool canBeVoid = false);
-        std::unique_ptr<ASTType> TYPE_FUN_RET();
-        std::unique_ptr<ASTStructDecl> STRUCT_DECL();
-        std::unique_ptr<ASTFunPtrDecl> FUNPTR_DECL();
-        std::unique_ptr<AST> EXPR_OR_VAR_DECL();
-        std::unique_ptr<ASTVarDecl> VAR_DECL();
-        std::unique_ptr<AST> VAR_DECLS();
-        std::unique_ptr<AST> EXPR();
-        std::unique_ptr<AST> EXPRS();
-        std::unique_ptr<AST> E9();
-        std::unique_ptr<AST> E8();
-        std::unique_ptr<AST> E7();
-        std::unique_ptr<AST> E6();
-        std::unique_ptr<AST> E5();
-        std::unique_ptr<AST> E4();
-        std::unique_ptr<AST> E3();
-        std::unique_ptr<AST> E2();
-        std::unique_ptr<AST> E1();
-        std::unique_ptr<AST> E_UNARY_PRE();
-        std::unique_ptr<AST> E_CALL_INDEX_MEMBER_POST();
-        std::unique_ptr<AST> F();
-        std::unique_ptr<ASTIdentifier> IDENT();
+        std::unique_ptr<ASTProgram> PROGRAM();
+        AST * TOP_LEVEL_DECL();
+        AST * FUN_DECL();
+        AST * STATEMENT();
+        AST * BLOCK_STMT();
+        ASTIf * IF_STMT();
+        AST * SWITCH_STMT();
+        AST * CASE_BODY();
+        AST * WHILE_STMT();
+        AST * DO_WHILE_STMT();
+        AST * FOR_STMT();
+        AST * BREAK_STMT();
+        AST * CONTINUE_STMT();
+        ASTReturn * RETURN_STMT();
+        AST * EXPR_STMT();
+        ASTType * TYPE(bool canBeVoid = false);
+        ASTType * TYPE_FUN_RET();
+        ASTStructDecl * STRUCT_DECL();
+        ASTFunPtrDecl * FUNPTR_DECL();
+        AST * EXPR_OR_VAR_DECL();
+        ASTVarDecl * VAR_DECL();
+        AST * VAR_DECLS();
+        AST * EXPR();
+        AST * EXPRS();
+        AST * E9();
+        AST * E_CALL_INDEX_MEMBER_POST();
+        AST * F();
+        ASTIdentifier * IDENT();
 
     private:
-        std::vector<Token> tokens_;
-        size_t i_ = 0;
+        TokenStream tokens_;
 
     }; // tiny::Parser
 
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if (defined __AVX2__)
+#define TINY_SCAN_AVX2 1
+#include <immintrin.h>
+#elif (defined __SSE2__) || (defined _M_X64) || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#define TINY_SCAN_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if (defined _MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace tiny::scan {
+
+    /** Scanning kernels used by the lexer.
+
+        Each kernel takes the [p, end) range and returns pointer to the first character that does not belong to the scanned class, or end. The scalar versions are the reference implementation, the vector versions process 16 (SSE2) or 32 (AVX2) bytes at a time and fall back to the scalar code for the tail of the buffer so that they never read past its end. The instruction set is selected at compile time, Default refers to the best one available.
+     */
+    struct Scalar {
+
+        static bool IsWhitespace(char c) {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        }
+
+        static bool IsIdentifier(char c) {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+        }
+
+        static bool IsDigit(char c) {
+            return c >= '0' && c <= '9';
+        }
+
+        static char const * SkipWhitespace(char const * p, char const * end) {
+            while (p != end && IsWhitespace(*p))
+                ++p;
+            return p;
+        }
+
+        static char const * IdentifierEnd(char const * p, char const * end) {
+            while (p != end && IsIdentifier(*p))
+                ++p;
+            return p;
+        }
+
+        static char const * DigitsEnd(char const * p, char const * end) {
+            while (p != end && IsDigit(*p))
+                ++p;
+            return p;
+        }
+
+        /** Returns first occurence of c.
+         */
+        static char const * Find(char const * p, char const * end, char c) {
+            while (p != end && *p != c)
+                ++p;
+            return p;
+        }
+
+        /** Returns first occurence of either a, or b. Used to find the closing quote, or an escape sequence in string literals.
+         */
+        static char const * FindEither(char const * p, char const * end, char a, char b) {
+            while (p != end && *p != a && *p != b)
+                ++p;
+            return p;
+        }
+
+        /** Returns first occurence of any of a, b and c. Used by the pre-scan of the parallel lexer to find the starts of comments and literals.
+         */
+        static char const * FindAny(char const * p, char const * end, char a, char b, char c) {
+            while (p != end && *p != a && *p != b && *p != c)
+                ++p;
+            return p;
+        }
+
+    }; // tiny::scan::Scalar
+
+#if (defined TINY_SCAN_AVX2) || (defined TINY_SCAN_SSE2)
+
+    /** Vector kernels. All of them compute a bitmask of the characters that belong to the scanned class for a whole block and then locate the first zero bit.
+     */
+    struct Vector {
+
+#if (defined TINY_SCAN_AVX2)
+        using Block = __m256i;
+        using Mask = uint32_t;
+        static constexpr size_t Width = 32;
+
+        static Block Load(char const * p) { return _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p)); }
+        static Block Splat(char c) { return _mm256_set1_epi8(c); }
+        static Block Eq(Block a, Block b) { return _mm256_cmpeq_epi8(a, b); }
+        static Block Gt(Block a, Block b) { return _mm256_cmpgt_epi8(a, b); }
+        static Block Or(Block a, Block b) { return _mm256_or_si256(a, b); }
+        static Block AndNot(Block a, Block b) { return _mm256_andnot_si256(a, b); }
+        static Mask Bits(Block a) { return static_cast<Mask>(_mm256_movemask_epi8(a)); }
+#else
+        using Block = __m128i;
+        using Mask = uint32_t;
+        static constexpr size_t Width = 16;
+
+        static Block Load(char const * p) { return _mm_loadu_si128(reinterpret_cast<__m128i const *>(p)); }
+        static Block Splat(char c) { return _mm_set1_epi8(c); }
+        static Block Eq(Block a, Block b) { return _mm_cmpeq_epi8(a, b); }
+        static Block Gt(Block a, Block b) { return _mm_cmpgt_epi8(a, b); }
+        static Block Or(Block a, Block b) { return _mm_or_si128(a, b); }
+        static Block AndNot(Block a, Block b) { return _mm_andnot_si128(a, b); }
+        static Mask Bits(Block a) { return static_cast<Mask>(_mm_movemask_epi8(a)); }
+#endif
+
+        /** Bytes of a block that lie in [lo, hi]. The comparisons are signed, which is fine since none of the ranges we test contains non-ASCII characters and those are negative.
+         */
+        static Block InRange(Block x, char lo, char hi) {
+            return AndNot(Or(Gt(Splat(lo), x), Gt(x, Splat(hi))), Splat(static_cast<char>(0xff)));
+        }
+
+        static unsigned FirstSet(Mask m) {
+#if (defined _MSC_VER)
+            unsigned long result;
+            _BitScanForward(&result, m);
+            return static_cast<unsigned>(result);
+#else
+            return static_cast<unsigned>(__builtin_ctz(m));
+#endif
+        }
+
+        static constexpr Mask All = (Width == 32) ? ~Mask{0} : ((Mask{1} << Width) - 1);
+
+        /** Advances p while the classifier accepts whole blocks, then finishes the tail with the scalar predicate.
+         */
+        template<typename CLASSIFIER, typename SCALAR>
+        static char const * Span(char const * p, char const * end, CLASSIFIER classify, SCALAR scalar) {
+            while (end - p >= static_cast<ptrdiff_t>(Width)) {
+                Mask m = Bits(classify(Load(p)));
+                if (m != All)
+                    return p + FirstSet(~m & All);
+                p += Width;
+            }
+            while (p != end && scalar(*p))
+                ++p;
+            return p;
+        }
+
+        static char const * SkipWhitespace(char const * p, char const * end) {
+            return Span(p, end, [](Block x) {
+                return Or(Or(Eq(x, Splat(' ')), Eq(x, Splat('\t'))), Or(Eq(x, Splat('\r')), Eq(x, Splat('\n'))));
+            }, Scalar::IsWhitespace);
+        }
+
+        static char const * IdentifierEnd(char const * p, char const * end) {
+            return Span(p, end, [](Block x) {
+                // setting 0x20 maps uppercase letters to lowercase and keeps digits and underscore intact
+                Block lower = Or(x, Splat(0x20));
+                return Or(Or(InRange(lower, 'a', 'z'), InRange(x, '0', '9')), Eq(x, Splat('_')));
+            }, Scalar::IsIdentifier);
+        }
+
+        static char const * DigitsEnd(char const * p, char const * end) {
+            return Span(p, end, [](Block x) {
+                return InRange(x, '0', '9');
+            }, Scalar::IsDigit);
+        }
+
+        static char const * Find(char const * p, char const * end, char c) {
+            return Span(p, end, [c](Block x) {
+                return AndNot(Eq(x, Splat(c)), Splat(static_cast<char>(0xff)));
+            }, [c](char x) { return x != c; });
+        }
+
+        static char const * FindEither(char const * p, char const * end, char a, char b) {
+            return Span(p, end, [a, b](Block x) {
+                return AndNot(Or(Eq(x, Splat(a)), Eq(x, Splat(b))), Splat(static_cast<char>(0xff)));
+            }, [a, b](char x) { return x != a && x != b; });
+        }
+
+        static char const * FindAny(char const * p, char const * end, char a, char b, char c) {
+            return Span(p, end, [a, b, c](Block x) {
+                return AndNot(Or(Or(Eq(x, Splat(a)), Eq(x, Splat(b))), Eq(x, Splat(c))), Splat(static_cast<char>(0xff)));
+            }, [a, b, c](char x) { return x != a && x != b && x != c; });
+        }
+
+    }; // tiny::scan::Vector
+
+    using Default = Vector;
+
+#else
+
+    using Default = Scalar;
+
+#endif
+
+} // namespace tiny::scan
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "lexer.h"
+
+namespace tiny {
+
+    /** Pull-based token source the parser reads from.
+
+        Tokens are lexed on demand and kept in a ring buffer that spans from the current token up to the furthest token the parser has looked ahead to. Lexing and parsing thus run in a single pass and the token memory is bounded by the longest lookahead, not by the size of the input.
+
+        Indices are absolute, i.e. they count tokens from the beginning of the input.
+
+        The stream can also be created from an already tokenized input, such as that of the parallel lexer. The tokens are then read from the vector instead of being lexed.
+     */
+    class TokenStream {
+    public:
+
+        explicit TokenStream(Lexer && lexer):
+            lexer_{std::move(lexer)},
+            ring_(InitialCapacity, lexer_->next()),
+            last_{1} {
+        }
+
+        /** Creates the stream from already lexed tokens, the last of which must be end of file. The stream starts at given index, indices of the stream are the indices of the vector.
+         */
+        explicit TokenStream(std::vector<Token> && tokens, size_t start = 0):
+            tokens_{std::move(tokens)},
+            ring_(InitialCapacity, tokens_[start]),
+            first_{start},
+            last_{start + 1},
+            i_{start} {
+            assert(tokens_.back() == Token::Kind::EoF);
+        }
+
+        /** Returns the tokens the stream was created from.
+         */
+        std::vector<Token> takeTokens() {
+            assert(! lexer_);
+            return std::move(tokens_);
+        }
+
+        /** Absolute index of the current token.
+         */
+        size_t index() const {
+            return i_;
+        }
+
+        Token const & top() const {
+            return ring_[i_ & (ring_.size() - 1)];
+        }
+
+        /** Returns the token offset tokens ahead of the current one, lexing it if necessary. Looking past the end of input returns the end of file token.
+         */
+        Token const & lookahead(size_t offset) {
+            size_t index = i_;
+            while (offset-- > 0 && at(index) != Token::Kind::EoF)
+                ++index;
+            return at(index);
+        }
+
+        /** Moves to the next token. The end of file token is never moved past.
+         */
+        void advance() {
+            if (top() == Token::Kind::EoF)
+                return;
+            at(++i_);
+            first_ = i_;
+        }
+
+        /** Moves to any index of an already lexed input.
+         */
+        void restart(size_t index) {
+            assert(! lexer_ && index < tokens_.size());
+            first_ = index;
+            last_ = index;
+            i_ = index;
+            at(index);
+        }
+
+    private:
+
+        static constexpr size_t InitialCapacity = 16;
+
+        /** Returns token at given absolute index, lexing everything up to it. The buffer grows only when the lookahead does not fit.
+         */
+        Token const & at(size_t index) {
+            assert(index >= first_);
+            while (last_ <= index) {
+                if (last_ - first_ == ring_.size())
+                    grow();
+                ring_[last_ & (ring_.size() - 1)] = lexer_ ? lexer_->next() : tokens_[last_];
+                ++last_;
+            }
+            return ring_[index & (ring_.size() - 1)];
+        }
+
+        void grow() {
+            std::vector<Token> ring(ring_.size() * 2, top());
+            for (size_t i = first_; i != last_; ++i)
+                ring[i & (ring.size() - 1)] = ring_[i & (ring_.size() - 1)];
+            ring_ = std::move(ring);
+        }
+
+        std::optional<Lexer> lexer_;
+        /** Tokens of the input if it was lexed beforehand, empty otherwise.
+         */
+        std::vector<Token> tokens_;
+        std::vector<Token> ring_;
+        /** Absolute index of the oldest token still held.
+         */
+        size_t first_ = 0;
+        /** One past the absolute index of the newest token lexed so far.
+         */
+        size_t last_;
+        size_t i_ = 0;
+
+    }; // tiny::TokenStream
+
+} // namespace tiny
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <atomic>
+#include <exception>
+#include <limits>
+
 #include "common/types.h"
+#include "common/scoped_table.h"
 #include "common/source_error.h"
+#include "common/thread_pool.h"
 #include "ast.h"
 
 namespace tiny {
@@ -20,9 +26,33 @@ namespace tiny {
     class Typechecker : public ASTVisitor {
     public:
 
-        static void checkProgram(std::unique_ptr<AST> const & root) {
+        /** Typechecks the whole program. When parallel, function bodies are checked on the thread pool, see checkParallel().
+         */
+        static void checkProgram(std::unique_ptr<AST> const & root, bool parallel = false) {
+            Typechecker t;
+            if (parallel)
+                t.checkParallel(static_cast<ASTProgram *>(root.get()));
+            else
+                t.typecheck(root.get());
+        }
+
+        /** Typechecks a program whose function bodies were skipped by the parser.
+
+            All declarations are checked first, bodies are then parsed by given function and checked only once a walk of the call graph from main reaches them, i.e. when a checked body, or a global initializer, refers to the function. Unreachable functions keep their bodies unparsed and are not translated. Although the bodies are checked after all declarations, they only see the globals declared before them, as they would in a single pass.
+         */
+        template<typename PARSE_BODY>
+        static void checkReachable(std::unique_ptr<AST> const & root, PARSE_BODY parseBody) {
             Typechecker t;
-            t.typecheck(root);
+            t.lazy_ = true;
+            t.typecheck(root.get());
+            t.reachGlobal(Symbol{"main"});
+            while (! t.reached_.empty()) {
+                auto [f, visibleGlobals] = t.reached_.back();
+                t.reached_.pop_back();
+                parseBody(f);
+                t.visibleGlobals_ = visibleGlobals;
+                t.checkBody(f);
+            }
         }
 
         /** It's ok to leave this unimplemented, the generic AST visitor only exists for fallbacks cases which we do not use in the typechecker. 
@@ -55,7 +85,7 @@ namespace tiny {
          */
         void visit(ASTIdentifier * ast) override { 
             Type * t = getVariable(ast->name);
-            if (t == nullptr)
+            if (t == nullptr || (lazy_ && ! reachGlobal(ast->name)))
                 throw TypeError{STR("Unknown variable " << ast->name.name()), ast->location()};
             ast->setType(t);
         }            
@@ -86,7 +116,7 @@ namespace tiny {
          */
         void visit(ASTNamedType * ast) override { 
             Type * t = Type::getType(ast->name);
-            if (t == nullptr) 
+            if (t == nullptr || ! isVisible(typeOrder_, ast->name))
                 throw TypeError{STR("Unknown type " << ast->name), ast->location()};
             ast->setType(t);
         }
@@ -116,7 +146,7 @@ namespace tiny {
          */
         void visit(ASTVarDecl * ast) override {
             Type * t = typecheck(ast->varType);
-            if (!t->isFullyDefined())
+            if (!isFullyDefined(t))
                 throw TypeError(STR("Type " << *t << " is not fully defined yet"), ast->location());
             if (ast->value != nullptr) {
                 Type * valueType = typecheck(ast->value);
@@ -147,17 +177,14 @@ namespace tiny {
             // that we can get a pointer to it easily
             Type * ftype = Type::getFunction(signature);
             addVariable(ast->name, ftype, ast);
-            // now that the function type has been created, we can enter the function, add local variables for its arguments
-            // and then typecheck its body
-            enterFunction(returnType);
-            for (auto & i : ast->args) 
-                addVariable(i.second->name, i.first->type(), i.second.get());
-            // verify that the function actually returns the type it should have. For this we need the block to return the result of its  
-            typecheck(ast->body);
-            if (!returned_ && returnType != Type::getVoid()) 
-                throw TypeError(STR("Not all paths of the function return " << *returnType), ast->location());
             ast->setType(Type::getVoid());
-            leaveFunction();
+            // a skipped body is checked later, if the function is ever reached, see checkReachable()
+            if (ast->lazyBody != 0)
+                unreached_.insert(std::make_pair(ast->name, std::make_pair(ast, globalOrder_.size())));
+            else if (deferBodies_ && ast->body != nullptr)
+                deferred_.push_back(std::make_pair(ast, globalOrder_.size()));
+            else
+                checkBody(ast);
         }
 
       
@@ -169,13 +196,20 @@ namespace tiny {
                 throw TypeError{STR("Struct " << ast->name << " is already defined"), ast->location()};
             for (auto & i : ast->fields) {
                 Type *fieldT = typecheck(i.second);
-                addVariable(i.first->name,  fieldT, i.second.get());
+                addVariable(i.first->name,  fieldT, i.second);
                 isFullyDefined &= typecheck(i.first)->isFullyDefined();
+                if (ast->isDefinition && fieldT->isFullyDefined())
+                    st->addField(i.first->name, fieldT);
             }
             leaveBlock();
 
             if (isFullyDefined)
                 st->markAsFullyDefined();
+            if (deferBodies_) {
+                typeOrder_.insert(std::make_pair(ast->name, globalOrder_.size()));
+                if (isFullyDefined)
+                    completedStructs_.insert(std::make_pair(static_cast<Type *>(st), globalOrder_.size()));
+            }
             ast->setType(st);
         }
 
@@ -197,6 +231,8 @@ namespace tiny {
             // that we can get a pointer to it easily
             Type *t = Type::getPointerTo(Type::getFunction(signature));
             Type::createAlias(ast->name->name, t);
+            if (deferBodies_)
+                typeOrder_.insert(std::make_pair(ast->name->name, globalOrder_.size()));
             ast->setType(t);
         }
 
@@ -218,9 +254,16 @@ namespace tiny {
             returned_ = old || allReturn;
         }
 
+        /** The switch is over integral values only as the cases are integer literals. Like with loops, a break in any of the cases may skip returns in the following ones, so the switch is assumed not to return.
+         */
         void visit(ASTSwitch * ast) override { 
-            MARK_AS_UNUSED(ast);
-            NOT_IMPLEMENTED;
+            bool old = returned_;
+            if (! typecheck(ast->cond)->isIntegral())
+                throw TypeError{STR("Switch condition must be integral, but " << *ast->cond->type() << " found"), ast->cond->location()};
+            for (auto & i : ast->cases)
+                typecheck(i.second);
+            ast->setType(Type::getVoid());
+            returned_ = old;
         }
 
         void visit(ASTWhile * ast) override { 
@@ -268,7 +311,7 @@ namespace tiny {
          */
         void visit(ASTReturn * ast) override { 
             Type * result = ast->value ? typecheck(ast->value) : Type::getVoid();
-            Type * expectedReturnType = contexts_.back().returnType;
+            Type * expectedReturnType = returnType_;
             if (result != expectedReturnType)
                 throw TypeError{STR("Return type " << *result << " found, but " << *expectedReturnType << " found"), ast->location()};
             ast->setType(result);
@@ -441,11 +484,12 @@ namespace tiny {
             auto * baseType = dynamic_cast<StructType*>(typecheck(ast->base));
             if (baseType == nullptr)
                 throw TypeError(STR("Cannot take field from a non-struct type " << *(ast->type())), ast->location());
-            if (! baseType->isFullyDefined())
+            if (! isFullyDefined(baseType))
                 throw TypeError(STR("Cannot take field from a not fully defined type " << *baseType), ast->location());
             Type * t = (*baseType)[ast->member];
             if (t == nullptr)
                 throw TypeError(STR("Struct of type " << *baseType << " does not have field " << ast->member.name()), ast->location());
+            baseType->countAccess(ast->member);
             ast->setType(t);
         }
 
@@ -457,11 +501,12 @@ namespace tiny {
             auto * baseType = dynamic_cast<StructType*>(p->base());
             if (baseType == nullptr)
                 throw TypeError(STR("Cannot take field from a non-struct type " << *(ast->type())), ast->location());
-            if (! baseType->isFullyDefined())
+            if (! isFullyDefined(baseType))
                 throw TypeError(STR("Cannot take field from a not fully defined type " << *baseType), ast->location());
             Type * t = (*baseType)[ast->member];
             if (t == nullptr)
                 throw TypeError(STR("Struct of type " << *baseType << " does not have field " << ast->member.name()), ast->location());
+            baseType->countAccess(ast->member);
             ast->setType(t);
         }
         
@@ -486,7 +531,7 @@ namespace tiny {
         void visit(ASTCast * ast) override { 
             typecheck(ast->value);
             Type * target = typecheck(ast->type);
-            if (! target->isFullyDefined())
+            if (! isFullyDefined(target))
                 throw TypeError(STR("Cannot typecheck to incomplete type " << *target), ast->location());
             ast->setType(target);
         }
@@ -507,15 +552,115 @@ namespace tiny {
 
     protected:
 
-        struct Context {
-            Type * returnType;
-            std::unordered_map<Symbol, Type *> locals;
+        /** Checks all declarations first and then the function bodies, which are independent of each other at that point, concurrently.
 
-            Context(Type * returnType = nullptr): returnType{returnType} {}
-        }; 
+            Bodies see only the globals declared before them, as in lazy checking, and only the named types declared and the structs completed before them, see isVisible(). The reported error is the one the single-threaded checker would report: a body can only fail before a declaration that follows it, and of the failing bodies the first one in the program wins. Workers take the bodies in program order and skip those after the first failure found so far.
+         */
+        void checkParallel(ASTProgram * program) {
+            lazy_ = true;
+            deferBodies_ = true;
+            std::exception_ptr declarationError;
+            for (auto & s : program->statements) {
+                try {
+                    typecheck(s);
+                } catch (...) {
+                    declarationError = std::current_exception();
+                    break;
+                }
+            }
+            size_t n = deferred_.size();
+            std::vector<std::exception_ptr> errors(n);
+            std::atomic<size_t> next{0};
+            std::atomic<size_t> firstError{n};
+            auto work = [&]() {
+                std::unique_ptr<Typechecker> t{new Typechecker{*this}};
+                for (size_t i = next++; i < firstError.load(); i = next++) {
+                    try {
+                        t->visibleGlobals_ = deferred_[i].second;
+                        t->checkBody(deferred_[i].first);
+                    } catch (...) {
+                        errors[i] = std::current_exception();
+                        size_t first = firstError.load();
+                        while (i < first && ! firstError.compare_exchange_weak(first, i)) { }
+                        // the failed body left its scopes open
+                        t.reset(new Typechecker{*this});
+                    }
+                }
+            };
+            size_t workers = std::min(ThreadPool::Default().size(), n);
+            if (workers > 1) {
+                std::vector<std::future<void>> results;
+                for (size_t i = 0; i < workers; ++i)
+                    results.push_back(ThreadPool::Default().submit(work));
+                for (auto & r : results)
+                    r.get();
+            } else {
+                work();
+            }
+            for (auto & e : errors)
+                if (e != nullptr)
+                    std::rethrow_exception(e);
+            if (declarationError != nullptr)
+                std::rethrow_exception(declarationError);
+            program->setType(Type::getVoid());
+        }
+
+        /** Now that the function type has been created, we can enter the function, add local variables for its arguments and then typecheck its body.
+         */
+        void checkBody(ASTFunDecl * ast) {
+            Type * returnType = ast->returnType->type();
+            enterFunction(returnType);
+            for (auto & i : ast->args) 
+                addVariable(i.second->name, i.first->type(), i.second);
+            // verify that the function actually returns the type it should have. For this we need the block to return the result of its  
+            typecheck(ast->body);
+            if (!returned_ && returnType != Type::getVoid()) 
+                throw TypeError(STR("Not all paths of the function return " << *returnType), ast->location());
+            leaveFunction();
+        }
+
+        /** Called for every identifier when checking lazily. Returns false if the identifier refers to a global declared after the function being checked. Otherwise, if it refers to a function whose body has not been checked yet, marks the function as reached.
+         */
+        bool reachGlobal(Symbol name) {
+            if (variables_.depthOf(name) > 1)
+                return true;
+            auto order = globalOrder_.find(name);
+            if (order != globalOrder_.end() && order->second >= visibleGlobals_)
+                return false;
+            auto i = unreached_.find(name);
+            if (i != unreached_.end()) {
+                reached_.push_back(i->second);
+                unreached_.erase(i);
+            }
+            return true;
+        }
+
+        /** Returns true if the named type or completed struct is visible to the function being checked. Types not in the order, such as all types when not checking in parallel, are always visible.
+         */
+        template<typename T>
+        bool isVisible(std::unordered_map<T, size_t> const & order, T key) const {
+            auto i = order.find(key);
+            return i == order.end() || i->second < visibleGlobals_;
+        }
+
+        /** Returns true if the type is fully defined for the function being checked, i.e. a struct must be completed before the function.
+         */
+        bool isFullyDefined(Type * t) const {
+            return t->isFullyDefined() && isVisible(completedStructs_, t);
+        }
+
+        /** A checker of function bodies that sees the globals and types declared by given checker, see checkParallel().
+         */
+        explicit Typechecker(Typechecker const & globals):
+            variables_{globals.variables_},
+            lazy_{true},
+            globalOrder_{globals.globalOrder_},
+            typeOrder_{globals.typeOrder_},
+            completedStructs_{globals.completedStructs_} {
+        }
 
         Typechecker() {
-            contexts_.push_back(Context{nullptr}); // the global scope
+            variables_.enter(); // the global scope
             Type::resetTypeInformation();
             // add stdlib functions
             Type * int_f = Type::getFunction(std::vector{Type::getInt()});
@@ -529,20 +674,22 @@ namespace tiny {
          * 
         */
         void enterFunction(Type * returnType) {
-            contexts_.push_back(Context{returnType});
+            variables_.enter();
+            returnType_ = returnType;
             returned_ = false;
         }
 
         void leaveFunction() {
-            contexts_.pop_back();
+            variables_.leave();
+            returnType_ = nullptr;
         }
 
         void enterBlock() {
-            contexts_.push_back(Context{contexts_.back().returnType});
+            variables_.enter();
         }
 
         void leaveBlock() {
-            contexts_.pop_back();
+            variables_.leave();
         }
 
         Type * getArithmeticResult(Type * a, Type * b) {
@@ -559,27 +706,21 @@ namespace tiny {
         }
 
         void addVariable(Symbol name, Type * t, AST * ast) {
-            auto & ctx = contexts_.back();
-            auto i = ctx.locals.find(name);
-            if (i != ctx.locals.end())
+            if (! variables_.add(name, t))
                 throw ParserError{STR("Variable " << name.name() << " already declared in current scope"), ast->location()};
-            ctx.locals[name] = t;
+            if (lazy_ && variables_.depth() == 1)
+                globalOrder_.insert(std::make_pair(name, globalOrder_.size()));
         }
 
         Type * getVariable(Symbol name) {
-            //i<e: loop until overflow
-            for (size_t i = contexts_.size() - 1, e = contexts_.size(); i < e; --i) {
-                auto it = contexts_[i].locals.find(name);
-                if (it != contexts_[i].locals.end())
-                    return it->second;
-            }
-            return nullptr;
+            Type * const * t = variables_.find(name);
+            return t == nullptr ? nullptr : *t;
         }
 
         template<typename T> 
         typename std::enable_if<std::is_base_of<AST, T>::value, Type *>::type
-        typecheck(std::unique_ptr<T> const & child) {
-            visitChild(child.get());
+        typecheck(T * child) {
+            visitChild(child);
             Type * result = child->type();
             if (result == nullptr)
                 throw TypeError{"Unable to type expression", child->location()};
@@ -592,8 +733,50 @@ namespace tiny {
          */
         bool returned_ = false;
 
-        std::vector<Context> contexts_; 
+        /** Variables of all scopes, the global scope is the outermost one.
+         */
+        ScopedTable<Type *> variables_;
+
+        /** Return type of the function being checked, nullptr outside of functions.
+         */
+        Type * returnType_ = nullptr;
+
+        /** \name Lazy checking, see checkReachable().
+
+            Functions with skipped bodies are kept together with the number of globals declared up to and including them.
+         */
+        bool lazy_ = false;
+
+        /** Order in which the globals were declared.
+         */
+        std::unordered_map<Symbol, size_t> globalOrder_;
+
+        /** Number of globals visible to the function being checked.
+         */
+        size_t visibleGlobals_ = std::numeric_limits<size_t>::max();
+
+        /** Functions with skipped bodies that nothing checked so far refers to.
+         */
+        std::unordered_map<Symbol, std::pair<ASTFunDecl *, size_t>> unreached_;
+
+        /** Functions that have been reached, but whose bodies are yet to be checked.
+         */
+        std::vector<std::pair<ASTFunDecl *, size_t>> reached_;
 
+        /** \name Parallel checking, see checkParallel().
+
+            Bodies are deferred until all declarations are checked.
+         */
+        bool deferBodies_ = false;
+
+        /** Functions whose bodies are deferred in program order.
+         */
+        std::vector<std::pair<ASTFunDecl *, size_t>> deferred_;
+
+        /** Number of globals declared before each named type was declared, and before each struct was completed. Bodies are checked after all declarations, but must only see the types a single pass would have seen.
+         */
+        std::unordered_map<Symbol, size_t> typeOrder_;
+        std::unordered_map<Type *, size_t> completedStructs_;
 
     }; // tiny::Typechecker
 
@@ -1,5 +1,6 @@
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <map>
@@ -8,6 +9,8 @@
 #include "common/options.h"
 #include "common/colors.h"
 #include "frontend/parser.h"
+#include "frontend/lazy.h"
+#include "frontend/ast_cache.h"
 #include "frontend/typechecker.h"
 #include "optimizer/ast_to_il.h"
 #include "optimizer/il_interpreter.h"
@@ -25,6 +28,18 @@
 #include "test/pointers/pointer_tests.h"
 #include "test/functions/function_tests.h"
 #include "test/struct/struct_tests.h"
+#include "test/incremental/incremental_tests.h"
+#include "test/ast_cache/ast_cache_tests.h"
+#include "test/lexer/lexer_tests.h"
+#include "test/typechecker/typechecker_tests.h"
+
+//benchmarks
+#include "bench/ast/ast_bench.h"
+#include "bench/lexer/lexer_bench.h"
+#include "bench/optimizer/optimizer_bench.h"
+#include "bench/parser/parser_bench.h"
+#include "bench/symbol/symbol_bench.h"
+#include "bench/types/types_bench.h"
 
 using namespace tiny;
 using namespace colors;
@@ -111,14 +126,62 @@ bool testASMProgram(t86::Program const & p, Test const * test) {
     return true;
 }
 
+/** Prints the memory layout of all structs defined by the typechecked program.
+ */
+void printStructLayouts(AST * ast) {
+    for (AST * s : static_cast<ASTProgram *>(ast)->statements)
+        if (auto decl = dynamic_cast<ASTStructDecl *>(s); decl != nullptr && decl->isDefinition)
+            static_cast<StructType *>(decl->type())->formatLayout(std::cout);
+}
+
+/** Closes the compiled source file once the compilation, including the reporting of its errors, is done.
+ */
+struct SourceFileCloser {
+    SourceFile * file = nullptr;
+
+    ~SourceFileCloser() {
+        if (file != nullptr)
+            SourceFile::Close(file->id());
+    }
+};
+
 bool compile(std::string const & contents, Test const * test, TestResult *result) {
+    SourceFileCloser closer;
     try {
-        // parse
-        std::unique_ptr<AST> ast = (test == nullptr) ? Parser::parseFile(contents) : Parser::parse(contents);
+        // contents is the filename, or the source of a test
+        SourceFile & file = (test == nullptr) ? SourceFile::Open(contents) : SourceFile::FromText(contents, "");
+        closer.file = & file;
+        std::unique_ptr<AST> ast;
+        if (test == nullptr && Options::astCache) {
+            // load the typechecked program from the file's cache, or parse & typecheck it and store the cache
+            ast = ASTCache::Load(file, Options::lazyParsing);
+            if (ast == nullptr) {
+                if (Options::lazyParsing) {
+                    ast = LazyParser::parseFile(file);
+                } else {
+                    ast = Parser::parseFile(file);
+                    Typechecker::checkProgram(ast, Options::parallelTypecheck);
+                }
+                if (! ASTCache::Store(static_cast<ASTProgram *>(ast.get()), file, Options::lazyParsing))
+                    std::cerr << color::yellow << "WARNING: " << color::reset << "Unable to store " << ASTCache::CacheFilename(file) << std::endl;
+            }
+            if (Options::verboseAST)
+                std::cout << ColorPrinter::colorize(*ast) << std::endl;
+        } else if (Options::lazyParsing) {
+            // parse & typecheck functions reachable from main
+            ast = LazyParser::parseFile(file);
+            if (Options::verboseAST)
+                std::cout << ColorPrinter::colorize(*ast) << std::endl;
+        } else {
+            // parse
+            ast = Parser::parseFile(file);
+            if (Options::verboseAST)
+                std::cout << ColorPrinter::colorize(*ast) << std::endl;
+            // typecheck
+            Typechecker::checkProgram(ast, Options::parallelTypecheck);
+        }
         if (Options::verboseAST)
-            std::cout << ColorPrinter::colorize(*ast) << std::endl;
-        // typecheck
-        Typechecker::checkProgram(ast);
+            printStructLayouts(ast.get());
         if (test && !test->testResult)
             ++result->typechecks;
         il::Program p = il::ASTToILTranslator::translateProgram(ast);
@@ -154,9 +217,9 @@ bool compile(std::string const & contents, Test const * test, TestResult *result
 
         return (test == nullptr) || ! (test->shouldError);
     } catch (SourceError const & e) {
-        if ((test != nullptr) && test->shouldError == e.kind())
+        if ((test != nullptr) && (test->shouldError != nullptr) && std::strcmp(test->shouldError, e.kind()) == 0)
             return true;
-        if (e.kind() == "TypeError")
+        if (std::strcmp(e.kind(), "TypeError") == 0)
             ++result->typecheck_fails;
         std::cerr << color::red << "ERROR: " << color::reset << e << std::endl;
     } catch (std::exception const &e) {
@@ -205,6 +268,20 @@ void RunAllTestSuites() {
     for (const auto& [suiteName, tests] : testCategories) {
         RunSelectedTestSuite(suiteName);
     }
+    RunIncrementalTests();
+    RunASTCacheTests();
+    RunParallelLexerTests();
+    RunParallelTypecheckerTests();
+}
+
+void RunAllBenchmarks() {
+    for (auto const & [suiteName, benchmarks] : benchmarkSuites()) {
+        std::cout << "Running benchmarks in suite: " << color::blue << suiteName << color::reset << std::endl;
+        for (auto const & b : benchmarks) {
+            std::cout << "  " << b.name << std::endl;
+            b.run();
+        }
+    }
 }
 
 int main(int argc, char * argv []) {
@@ -214,7 +291,9 @@ int main(int argc, char * argv []) {
     if (Options::parseArgs(argc, argv, filename) == EXIT_FAILURE)
         return EXIT_FAILURE;
 
-    if (filename == nullptr) {
+    if (Options::runBenchmarks) {
+        RunAllBenchmarks();
+    } else if (filename == nullptr) {
         if (RUN_ALL_TEST_SUITES) {
             RunAllTestSuites();
         } else {
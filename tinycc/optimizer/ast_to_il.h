@@ -1,8 +1,10 @@
 #pragma once
 
 #include <algorithm>
+#include <unordered_map>
 #include <vector>
 
+#include "common/scoped_table.h"
 #include "common/types.h"
 #include "frontend/ast.h"
 #include "il.h"
@@ -14,7 +16,8 @@ namespace tiny::il {
 
         static Program translateProgram(std::unique_ptr<AST> const & root) {
             ASTToILTranslator t;
-            t.translate(root);
+            t.translate(root.get());
+            t.initializeStrings();
             return std::move(t.p_);
         }
 
@@ -47,10 +50,24 @@ namespace tiny::il {
 
         /** Translating string literals is a bit harder - each string literal is deduplicated and stored as a new
          *  global variable that is also initialized with the contents of the literal.
+         *
+         *  The globals of all literals are parts of a single string pool, so that identical literals share one address
+         *  in the pool and all the literals are stored next to each other. The pool is initialized by the globals basic
+         *  block once the whole program is translated, see initializeStrings().
          */
         void visit(ASTString* ast) override {
-            MARK_AS_UNUSED(ast);
-            NOT_IMPLEMENTED;
+            std::string value{ast->value};
+            auto i = strings_.find(value);
+            if (i == strings_.end()) {
+                if (stringPool_ == nullptr)
+                    stringPool_ = p_.globals()->append(ALLOCG(RegType::Int, 0, "strings"));
+                Instruction * offset = p_.globals()->append(LDI(RegType::Int, static_cast<int64_t>(stringPoolSize_), ast));
+                Instruction * str = p_.globals()->append(GEP(RegType::Int, stringPool_, offset, 1, ast));
+                i = strings_.emplace(value, str).first;
+                // each character takes a word, like the elements of a char array, see Type::slotSize()
+                stringPoolSize_ += (value.size() + 1) * T86_WORD_SZ;
+            }
+            lastResult_ = i->second;
         }
 
         /** Identifier is translated as a variable read. Note that this is as the address.
@@ -93,24 +110,36 @@ namespace tiny::il {
         }
 
 
+        /** Arrays are pointers in TinyC (see Typechecker), so an array variable points to the storage of its elements allocated next to it.
+         */
         void visit(ASTVarDecl* ast) override {
-            Instruction *lvalue = addVariable(ast->name->name, static_cast<int64_t>(ast->type()->size()));
+            Instruction *lvalue = addVariable(ast->name->name, ast->type()->size());
+            if (ast->varType->kind() == ASTKind::ArrayType) {
+                auto * array = static_cast<ASTArrayType *>(ast->varType);
+                if (array->size->kind() != ASTKind::Integer || array->base->kind() == ASTKind::ArrayType)
+                    NOT_IMPLEMENTED;
+                size_t elementSize = static_cast<PointerType *>(ast->type())->base()->slotSize();
+                Instruction * elements = allocate(static_cast<ASTInteger *>(array->size)->value * elementSize, STR(ast->name->name.name() << "-elements"));
+                (*this) += ST(lvalue, elements, ast);
+            }
             if (ast->value) {
                 translate(ast->value);
                 (*this) += ST(lvalue, lastResult_, ast);
             }
         }
 
-        /** Enter a new function.
+        /** Enter a new function. Functions whose bodies were never parsed are not reachable from main and are left out.
          */
         void visit(ASTFunDecl* ast) override {
+            if (ast->body == nullptr)
+                return;
             Function * f = enterFunction(ast->name);
             f->retType_ = registerTypeFor(ast->type());
             for (size_t i = 0, e = ast->args.size(); i != e; ++i) {
                 Symbol name = ast->args[i].second->name;
                 Instruction *arg = ARG(registerTypeFor(ast->args[i].first->type()),
-                                       static_cast<int64_t>(i), ast->args[i].first.get(),
-                                       name.name());
+                                       static_cast<int64_t>(i), ast->args[i].first,
+                                       std::string{name.name()});
                 f->addArg(arg);
                 // now we need to create a local copy of the value so that it acts as a variable
                 Type * t = ast->args[i].first->type();
@@ -118,7 +147,7 @@ namespace tiny::il {
                     Instruction * addr = addVariable(name, static_cast<int64_t>(ast->args[i].first->type()->size()));
                     (*this) += ST(addr, arg);
                 } else {
-                    currentContext().locals.insert(std::make_pair(name, arg));
+                    locals_.add(name, arg);
                 }
             }
             translate(ast->body);
@@ -136,14 +165,11 @@ namespace tiny::il {
         void visit(ASTFunPtrDecl* ast) override {MARK_AS_UNUSED(ast); lastResult_ = nullptr; }
 
         void visit(ASTIf* ast) override {
-            translate(ast->cond);
-
             BasicBlock *thenBB = f_->addBasicBlock(STR("then"));
             BasicBlock *elseBB = f_->addBasicBlock(STR("else"));
             BasicBlock *mergeBB = f_->addBasicBlock(STR("if-else-merge"));
 
-            Instruction *isZero = lastResult_;
-            (*this) += BR(isZero, thenBB, elseBB, ast);
+            translateCondition(ast->cond, thenBB, elseBB);
 
             // Process 'then' block
             //(*this) += JMP(thenBB, ast);
@@ -159,9 +185,34 @@ namespace tiny::il {
             enterBasicBlock(mergeBB);
         }
 
+        /** Each case gets its own basic block, in the order of the source so that a case without break falls through to the next one. The backend decides how to find the case for the value, see T86CodeGen.
+         */
         void visit(ASTSwitch* ast) override {
-            MARK_AS_UNUSED(ast);
-            NOT_IMPLEMENTED;
+            Instruction * value = translate(ast->cond);
+            std::vector<BasicBlock *> bodies;
+            std::vector<std::pair<int64_t, BasicBlock *>> cases;
+            BasicBlock * defaultBB = nullptr;
+            for (auto & i : ast->cases) {
+                bodies.push_back(f_->addBasicBlock((i.second == ast->defaultCase) ? "switch-default" : "switch-case"));
+                if (i.second == ast->defaultCase)
+                    defaultBB = bodies.back();
+                else
+                    cases.emplace_back(i.first, bodies.back());
+            }
+            BasicBlock *mergeBB = f_->addBasicBlock(STR("switch-merge"));
+            (*this) += SWITCH(value, defaultBB == nullptr ? mergeBB : defaultBB, cases, ast);
+
+            // break leaves the switch, continue still belongs to the enclosing loop
+            BasicBlock * breakBB = currentContext().breakBlock;
+            currentContext().breakBlock = mergeBB;
+            for (size_t i = 0; i < bodies.size(); ++i) {
+                enterBasicBlock(bodies[i]);
+                translate(ast->cases[i].second);
+                (*this) += JMP(i + 1 < bodies.size() ? bodies[i + 1] : mergeBB, ast);
+            }
+            currentContext().breakBlock = breakBB;
+
+            enterBasicBlock(mergeBB);
         }
 
         void visit(ASTWhile* ast) override {
@@ -170,14 +221,18 @@ namespace tiny::il {
             BasicBlock *mergeBB = f_->addBasicBlock(STR("while-merge"));
 
             (*this) += JMP(condBB, ast);
-            enterLoopBasicBlock(condBB, bodyBB, mergeBB);
-            translate(ast->cond);
-            (*this) += BR(lastResult_, bodyBB, mergeBB, ast);
+            // a break or continue after the loop belongs to the enclosing loop or switch again
+            BasicBlock * breakBB = currentContext().breakBlock;
+            BasicBlock * continueBB = currentContext().continueBlock;
+            enterLoopBasicBlock(condBB, condBB, mergeBB);
+            translateCondition(ast->cond, bodyBB, mergeBB);
 
             enterBasicBlock(bodyBB);
             translate(ast->body);
             (*this) += JMP(condBB, ast);
 
+            currentContext().breakBlock = breakBB;
+            currentContext().continueBlock = continueBB;
             enterBasicBlock(mergeBB);
         }
 
@@ -187,14 +242,17 @@ namespace tiny::il {
             BasicBlock *mergeBB = f_->addBasicBlock(STR("do-while-merge"));
 
             (*this) += JMP(bodyBB, ast);
+            BasicBlock * breakBB = currentContext().breakBlock;
+            BasicBlock * continueBB = currentContext().continueBlock;
             enterLoopBasicBlock(bodyBB, condBB, mergeBB);
             translate(ast->body);
             (*this) += JMP(condBB, ast);
 
             enterBasicBlock(condBB);
-            translate(ast->cond);
-            (*this) += BR(lastResult_, bodyBB, mergeBB, ast);
+            translateCondition(ast->cond, bodyBB, mergeBB);
 
+            currentContext().breakBlock = breakBB;
+            currentContext().continueBlock = continueBB;
             enterBasicBlock(mergeBB);
         }
 
@@ -209,9 +267,10 @@ namespace tiny::il {
             BasicBlock *mergeBB = f_->addBasicBlock(STR("for-merge"));
 
             (*this) += JMP(condBB, ast);
+            BasicBlock * breakBB = currentContext().breakBlock;
+            BasicBlock * continueBB = currentContext().continueBlock;
             enterLoopBasicBlock(condBB, incBB, mergeBB);
-            translate(ast->cond);
-            (*this) += BR(lastResult_, bodyBB, mergeBB, ast);
+            translateCondition(ast->cond, bodyBB, mergeBB);
 
             enterBasicBlock(bodyBB);
             translate(ast->body);
@@ -221,6 +280,8 @@ namespace tiny::il {
             translate(ast->increment);
             (*this) += JMP(condBB, ast);
 
+            currentContext().breakBlock = breakBB;
+            currentContext().continueBlock = continueBB;
             enterBasicBlock(mergeBB);
         }
 
@@ -249,6 +310,10 @@ namespace tiny::il {
         }
 
         void visit(ASTBinaryOp* ast) override {
+            if (ast->op == Symbol::And || ast->op == Symbol::Or) {
+                translateLogicalValue(ast);
+                return;
+            }
             Instruction * lhs = translate(ast->left);
             Instruction * rhs = translate(ast->right);
             if (ast->op == Symbol::Mul) {
@@ -269,10 +334,6 @@ namespace tiny::il {
                 (*this) += GTE(binaryResult(lhs, rhs), lhs, rhs, ast);
             } else if (ast->op == Symbol::Eq){
                 (*this) += EQ(binaryResult(lhs, rhs), lhs, rhs, ast);
-            } else if (ast->op == Symbol::And){
-                (*this) += AND(binaryResult(lhs, rhs), lhs, rhs, ast);
-            } else if (ast->op == Symbol::Or){
-                (*this) += OR(binaryResult(lhs, rhs), lhs, rhs, ast);
             } else {
                 NOT_IMPLEMENTED;
             }
@@ -299,9 +360,10 @@ namespace tiny::il {
             NOT_IMPLEMENTED;
         }
 
+        /** The lvalue of the target already is its address.
+         */
         void visit(ASTAddress* ast) override {
             translateLValue(ast->target);
-            (*this) += LD(RegType::Int, lastResult_, ast);
         }
 
         void visit(ASTDeref* ast) override {
@@ -309,19 +371,35 @@ namespace tiny::il {
             (*this) += LD(lastResult_->type, lastResult_, ast);
         }
 
+        /** The address of an element is the pointer moved by the index times the size of the element's slot, see Type::slotSize(). The element is then loaded unless it is used as an lvalue.
+         */
         void visit(ASTIndex* ast) override {
-            MARK_AS_UNUSED(ast);
-            NOT_IMPLEMENTED;
+            bool lValue = lValue_;
+            lValue_ = false;
+            Instruction * base = translate(ast->base);
+            Instruction * index = translate(ast->index);
+            (*this) += GEP(RegType::Int, base, index, static_cast<int64_t>(ast->type()->slotSize()), ast);
+            if (! lValue)
+                (*this) += LD(registerTypeFor(ast->type()), lastResult_, ast);
         }
 
+        /** The address of a field is the address of the struct moved by the field's offset in the struct's layout. The field is then loaded unless it is used as an lvalue.
+         */
         void visit(ASTMember* ast) override {
-            MARK_AS_UNUSED(ast);
-            NOT_IMPLEMENTED;
+            bool lValue = lValue_;
+            lValue_ = false;
+            Instruction * base = translateLValue(ast->base);
+            translateField(ast, base, static_cast<StructType *>(ast->base->type()), ast->member, lValue);
         }
 
+        /** Same as member, but the address of the struct is the value of the base.
+         */
         void visit(ASTMemberPtr* ast) override {
-            MARK_AS_UNUSED(ast);
-            NOT_IMPLEMENTED;
+            bool lValue = lValue_;
+            lValue_ = false;
+            Instruction * base = translate(ast->base);
+            auto * st = static_cast<StructType *>(static_cast<PointerType *>(ast->base->type())->base());
+            translateField(ast, base, st, ast->member, lValue);
         }
 
         void visit(ASTCall* ast) override {
@@ -353,19 +431,69 @@ namespace tiny::il {
 
     private:
 
+        /** Translates the condition to a branch to the true or false basic block. The operands of && and || branch on their own as soon as the result is known, so that no value is built for the operator.
+         */
+        void translateCondition(AST * cond, BasicBlock * trueBB, BasicBlock * falseBB) {
+            auto * op = cond->kind() == ASTKind::BinaryOp ? static_cast<ASTBinaryOp *>(cond) : nullptr;
+            if (op != nullptr && op->op == Symbol::And) {
+                BasicBlock * rhsBB = f_->addBasicBlock("and-rhs");
+                translateCondition(op->left, rhsBB, falseBB);
+                enterBasicBlock(rhsBB);
+                translateCondition(op->right, trueBB, falseBB);
+            } else if (op != nullptr && op->op == Symbol::Or) {
+                BasicBlock * rhsBB = f_->addBasicBlock("or-rhs");
+                translateCondition(op->left, trueBB, rhsBB);
+                enterBasicBlock(rhsBB);
+                translateCondition(op->right, trueBB, falseBB);
+            } else {
+                translate(cond);
+                (*this) += BR(lastResult_, trueBB, falseBB, cond);
+            }
+        }
+
+        /** A && or || used as a value branches as in a condition, the value is then selected by a phi in the join block.
+         */
+        void translateLogicalValue(ASTBinaryOp * ast) {
+            BasicBlock * trueBB = f_->addBasicBlock("logical-true");
+            BasicBlock * falseBB = f_->addBasicBlock("logical-false");
+            BasicBlock * joinBB = f_->addBasicBlock("logical-join");
+            translateCondition(ast, trueBB, falseBB);
+            enterBasicBlock(trueBB);
+            Instruction * one = LDI(RegType::Int, 1, ast);
+            (*this) += one;
+            (*this) += JMP(joinBB, ast);
+            enterBasicBlock(falseBB);
+            Instruction * zero = LDI(RegType::Int, 0, ast);
+            (*this) += zero;
+            (*this) += JMP(joinBB, ast);
+            enterBasicBlock(joinBB);
+            Instruction::Phi * phi = PHI(RegType::Int, ast);
+            phi->incoming.emplace_back(trueBB, one);
+            phi->incoming.emplace_back(falseBB, zero);
+            (*this) += phi;
+        }
+
+        void translateField(AST * ast, Instruction * base, StructType * st, Symbol member, bool lValue) {
+            Instruction * offset = LDI(RegType::Int, static_cast<int64_t>(st->offsetOf(member)), ast);
+            (*this) += offset;
+            (*this) += GEP(RegType::Int, base, offset, 1, ast);
+            if (! lValue)
+                (*this) += LD(registerTypeFor(ast->type()), lastResult_, ast);
+        }
+
         template<typename T>
         typename std::enable_if<std::is_base_of<AST, T>::value, Instruction *>::type
-        translate(std::unique_ptr<T> const & child) {
-            visitChild(child.get());
+        translate(T * child) {
+            visitChild(child);
             return lastResult_;
         }
 
         template<typename T>
         typename std::enable_if<std::is_base_of<AST, T>::value, Instruction *>::type
-        translateLValue(std::unique_ptr<T> const & child) {
+        translateLValue(T * child) {
             bool old = lValue_;
             lValue_ = true;
-            visitChild(child.get());
+            visitChild(child);
             lValue_ = old;
             return lastResult_;
         }
@@ -379,8 +507,11 @@ namespace tiny::il {
             return *this;
         }
 
+        ASTToILTranslator() {
+            locals_.enter(); // the global scope with the functions
+        }
+
         struct Context {
-            std::unordered_map<Symbol, Instruction *> locals;
             BasicBlock * localsBlock = nullptr;
             BasicBlock * firstBB = nullptr;
             //following bbs have to be part of the contexts because eg we can enter a for loop in a for loop
@@ -412,15 +543,18 @@ namespace tiny::il {
         Function * enterFunction(Symbol name) {
             ASSERT(f_ == nullptr);
             f_ = p_.addFunction(name);
-            Instruction * fReg = FUN(name,name.name());
+            Instruction * fReg = FUN(name, std::string{name.name()});
             p_.globals()->append(fReg);
             bb_ = f_->addBasicBlock("entry");
+            locals_.add(name, fReg);
             contexts_.emplace_back(bb_);
-            contexts_.front().locals.insert(std::make_pair(name, fReg));
+            locals_.enter();
             return f_;
         }
 
         void leaveFunction() {
+            locals_.leave();
+            contexts_.pop_back();
             f_ = nullptr;
         }
 
@@ -434,6 +568,7 @@ namespace tiny::il {
             bb_ = bb;
             contexts_.emplace_back(locals, bb_, currentContext().breakBlock,
                                    currentContext().continueBlock);
+            locals_.enter();
         }
 
         void leaveBlock() {
@@ -442,6 +577,7 @@ namespace tiny::il {
             locals->append(JMP(firstBB));
             f_->updateLocalsSize(-currentContext().sizeOfLocals);
             contexts_.pop_back();
+            locals_.leave();
         }
 
         BasicBlock *enterBasicBlock(BasicBlock * bb) {
@@ -461,39 +597,67 @@ namespace tiny::il {
         }
 
         /** Creates new local variable with given name and size. The variable's ALLOCA instruction is appended to the
-         *  current block's local definitions basic block and the register containing the address is returned.
+         *  current block's local definitions basic block and the register containing the address is returned. On the
+         *  stack each variable occupies whole words.
          */
         Instruction * addVariable(Symbol name, size_t size) {
-            auto alloc = ALLOCA(RegType::Int, static_cast<int64_t>(size), name.name());
+            Instruction * res = allocate(size, std::string{name.name()});
+            locals_.add(name, res);
+            return res;
+        }
+
+        /** Allocates given number of bytes on the stack in the current context's local definitions basic block and returns the register with the address.
+         */
+        Instruction * allocate(size_t size, std::string const & name) {
+            // registers are stored as whole words, even pointers
+            int words = static_cast<int>((size + T86_WORD_SZ - 1) / T86_WORD_SZ);
+            auto alloc = ALLOCA(RegType::Int, static_cast<int64_t>(words * T86_WORD_SZ), name);
             Instruction * res = currentContext().localsBlock->append(alloc);
-            f_->updateLocalsSize(size);
-            currentContext().sizeOfLocals += size;
-            currentContext().locals.insert(std::make_pair(name, res));
+            f_->updateLocalsSize(words * T86_WORD_SZ);
+            currentContext().sizeOfLocals += words * T86_WORD_SZ;
             return res;
         }
 
+        /** Sets the size of the string pool and its initial contents, so that no instructions are needed to fill it. Each
+         *  character takes a word of its own so that the literals can be indexed as char arrays. The word after the last
+         *  character is zero, which terminates the string.
+         */
+        void initializeStrings() {
+            if (stringPool_ == nullptr)
+                return;
+            static_cast<Instruction::ImmI *>(stringPool_)->value = static_cast<int64_t>(stringPoolSize_);
+            std::vector<int64_t> words(stringPoolSize_ / T86_WORD_SZ, 0);
+            for (auto const & [value, str] : strings_) {
+                int64_t start = static_cast<Instruction::ImmI *>(static_cast<Instruction::RegRegImmI *>(str)->reg2)->value;
+                for (size_t i = 0; i < value.size(); ++i)
+                    words[static_cast<size_t>(start) / T86_WORD_SZ + i] = static_cast<unsigned char>(value[i]);
+            }
+            p_.setData(stringPool_, std::move(words));
+        }
+
         /** Returns the register that holds the address of variable with given name. The address can then be used to
          *  load/store its contents.
          */
         Instruction* getVariable(Symbol name) {
-            auto it = std::find_if(contexts_.rbegin(),
-                                   contexts_.rend(), [&name](const auto& context) {
-                return context.locals.find(name) != context.locals.end();
-            });
-
-            if (it != contexts_.rend()) {
-                auto varIt = it->locals.find(name);
-                auto opcode = varIt->second->opcode;
-                assert(opcode == Opcode::ALLOCA || opcode == Opcode::FUN);
-                return varIt->second;
-            }
-            return nullptr;
+            Instruction * const * var = locals_.find(name);
+            if (var == nullptr)
+                return nullptr;
+            assert((*var)->opcode == Opcode::ALLOCA || (*var)->opcode == Opcode::FUN);
+            return *var;
         }
 
         Context &currentContext() { return contexts_.back(); }
 
         Program p_;
         std::vector<Context> contexts_;
+        /** Registers holding the addresses of the variables and functions, scopes follow the contexts.
+         */
+        ScopedTable<Instruction *> locals_;
+        /** The string pool in the globals and the addresses of the literals in it, see visit(ASTString*).
+         */
+        Instruction * stringPool_ = nullptr;
+        size_t stringPoolSize_ = 0;
+        std::unordered_map<std::string, Instruction *> strings_;
         Instruction * lastResult_ = nullptr;
         BasicBlock * bb_ = nullptr;
         Function * f_ = nullptr; 
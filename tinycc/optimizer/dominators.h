@@ -0,0 +1,151 @@
+#pragma once
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "il.h"
+
+namespace tiny::il {
+
+    /** Control flow graph of a function together with its dominator tree and dominance frontiers.
+
+        Only basic blocks reachable from the start of the function are part of the graph. Immediate dominators are computed by the iterative algorithm of Cooper, Harvey and Kennedy, which refines them over the blocks in reverse postorder until nothing changes. For the reducible graphs the translator produces this takes two passes.
+     */
+    class DominatorTree {
+    public:
+
+        explicit DominatorTree(Function const * f) {
+            computeOrder(f->start());
+            size_t n = rpo_.size();
+            preds_.resize(n);
+            for (size_t i = 0; i < n; ++i)
+                for (BasicBlock * s : rpo_[i]->successors())
+                    preds_[index(s)].push_back(rpo_[i]);
+            computeDominators();
+            children_.resize(n);
+            for (size_t i = 1; i < n; ++i)
+                children_[idom_[i]].push_back(rpo_[i]);
+            computeFrontiers();
+        }
+
+        /** Reachable basic blocks in reverse postorder, i.e. the start first and every block before its successors, unless the edge closes a loop.
+         */
+        std::vector<BasicBlock *> const & blocks() const { return rpo_; }
+
+        bool reachable(BasicBlock const * b) const { return order_.find(b) != order_.end(); }
+
+        /** Reachable blocks that may jump to the block. A block is listed once for every edge to the block.
+         */
+        std::vector<BasicBlock *> const & predecessors(BasicBlock const * b) const { return preds_[index(b)]; }
+
+        /** Immediate dominator of the block, nullptr for the start.
+         */
+        BasicBlock * idom(BasicBlock const * b) const {
+            size_t i = index(b);
+            return i == 0 ? nullptr : rpo_[idom_[i]];
+        }
+
+        /** Blocks immediately dominated by the block.
+         */
+        std::vector<BasicBlock *> const & children(BasicBlock const * b) const { return children_[index(b)]; }
+
+        /** Blocks where the dominance of the block ends, i.e. blocks not strictly dominated by it that have a predecessor dominated by it.
+         */
+        std::vector<BasicBlock *> const & frontier(BasicBlock const * b) const { return frontier_[index(b)]; }
+
+    private:
+
+        size_t index(BasicBlock const * b) const {
+            auto i = order_.find(b);
+            ASSERT(i != order_.end() && "Basic block not reachable");
+            return i->second;
+        }
+
+        void computeOrder(BasicBlock * start) {
+            std::vector<BasicBlock *> postorder;
+            std::unordered_map<BasicBlock const *, bool> visited;
+            std::vector<std::pair<BasicBlock *, std::vector<BasicBlock *>>> stack;
+            visited[start] = true;
+            stack.emplace_back(start, start->successors());
+            while (! stack.empty()) {
+                auto & top = stack.back();
+                if (top.second.empty()) {
+                    postorder.push_back(top.first);
+                    stack.pop_back();
+                    continue;
+                }
+                BasicBlock * next = top.second.front();
+                top.second.erase(top.second.begin());
+                if (! visited[next]) {
+                    visited[next] = true;
+                    stack.emplace_back(next, next->successors());
+                }
+            }
+            rpo_.assign(postorder.rbegin(), postorder.rend());
+            for (size_t i = 0; i < rpo_.size(); ++i)
+                order_[rpo_[i]] = i;
+        }
+
+        void computeDominators() {
+            size_t const undefined = rpo_.size();
+            idom_.assign(rpo_.size(), undefined);
+            idom_[0] = 0;
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (size_t i = 1; i < rpo_.size(); ++i) {
+                    size_t newIdom = undefined;
+                    for (BasicBlock * p : preds_[i]) {
+                        size_t pi = index(p);
+                        if (idom_[pi] == undefined)
+                            continue;
+                        newIdom = (newIdom == undefined) ? pi : intersect(pi, newIdom);
+                    }
+                    if (idom_[i] != newIdom) {
+                        idom_[i] = newIdom;
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        /** Walks up the dominator tree from both blocks until they meet. A dominator always precedes the blocks it dominates in reverse postorder.
+         */
+        size_t intersect(size_t a, size_t b) const {
+            while (a != b) {
+                while (a > b)
+                    a = idom_[a];
+                while (b > a)
+                    b = idom_[b];
+            }
+            return a;
+        }
+
+        void computeFrontiers() {
+            frontier_.resize(rpo_.size());
+            for (size_t i = 0; i < rpo_.size(); ++i) {
+                if (preds_[i].size() < 2)
+                    continue;
+                for (BasicBlock * p : preds_[i]) {
+                    for (size_t runner = index(p); runner != idom_[i]; runner = idom_[runner]) {
+                        auto & df = frontier_[runner];
+                        if (df.empty() || df.back() != rpo_[i])
+                            df.push_back(rpo_[i]);
+                    }
+                }
+            }
+        }
+
+        std::vector<BasicBlock *> rpo_;
+        std::unordered_map<BasicBlock const *, size_t> order_;
+        std::vector<std::vector<BasicBlock *>> preds_;
+        /** Immediate dominators as indices to rpo_, the start is its own.
+         */
+        std::vector<size_t> idom_;
+        std::vector<std::vector<BasicBlock *>> children_;
+        std::vector<std::vector<BasicBlock *>> frontier_;
+
+    }; // tiny::il::DominatorTree
+
+} // namespace tiny::il
@@ -14,4 +14,20 @@ namespace tiny::il {
         p << " " << (*reg) << SYMBOL("? ") << (*target1) << SYMBOL(" : ") << (*target2);
     }
 
+    void Instruction::TerminatorRegBBs::print(colors::ColorPrinter & p) const {
+        using namespace colors;
+        Instruction::print(p);
+        p << " " << (*reg) << SYMBOL("?");
+        for (auto & c : cases)
+            p << " " << c.first << SYMBOL(": ") << (*c.second) << SYMBOL(",");
+        p << " " << KEYWORD("default") << SYMBOL(": ") << (*defaultTarget);
+    }
+
+    void Instruction::Phi::print(colors::ColorPrinter & p) const {
+        using namespace colors;
+        Instruction::print(p);
+        for (size_t i = 0; i < incoming.size(); ++i)
+            p << (i == 0 ? " " : ", ") << SYMBOL("[") << (*incoming[i].first) << SYMBOL(": ") << (*incoming[i].second) << SYMBOL("]");
+    }
+
 }
\ No newline at end of file
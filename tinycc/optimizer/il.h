@@ -1,8 +1,10 @@
 #pragma once
 
 
+#include <algorithm>
 #include <unordered_map>
 #include <memory>
+#include <vector>
 
 #include "common/colors.h"
 #include "frontend/ast.h"
@@ -66,10 +68,12 @@ namespace tiny::il {
         class RegReg;
         class RegRegImmI;
         class RegRegs;
+        class Phi;
         class Terminator;
         class TerminatorB;
         class TerminatorReg;
         class TerminatorRegBB;
+        class TerminatorRegBBs;
 
         virtual ~Instruction() = default;
 
@@ -348,7 +352,7 @@ namespace tiny::il {
         void print(colors::ColorPrinter & p) const override {
             using namespace colors;
             Instruction::print(p);
-            p << " " << (*reg1) << SYMBOL(", ") << (*reg2);
+            p << " " << (*reg1) << SYMBOL(", ") << (*reg2) << SYMBOL(", ") << value;
         }
 
 
@@ -393,6 +397,40 @@ namespace tiny::il {
 
     }; // tiny::il::Instruction::RegRegs
 
+    class Instruction::Phi : public Instruction {
+    public:
+        /** The incoming values paired with the predecessor basic blocks they come from.
+         */
+        std::vector<std::pair<BasicBlock *, Instruction *>> incoming;
+
+        Phi(Opcode opcode, RegType type, AST const * ast = nullptr):
+            Instruction{opcode, type, ast} {
+        }
+
+        Phi(Opcode opcode, RegType type, AST const * ast, std::string const & name):
+            Instruction{opcode, type, ast, name} {
+        }
+
+        Phi(Opcode opcode, RegType type, std::string const & name):
+            Instruction{opcode, type, nullptr, name} {
+        }
+
+        /** Returns the value coming from given predecessor, or nullptr if there is none.
+         */
+        Instruction * from(BasicBlock const * pred) const {
+            for (auto & i : incoming)
+                if (i.first == pred)
+                    return i.second;
+            return nullptr;
+        }
+
+    protected:
+        void accept(IRVisitor* visitor) override;
+
+        void print(colors::ColorPrinter & p) const override;
+
+    }; // tiny::il::Instruction::Phi
+
     class Instruction::Terminator : public Instruction {
     public:
         Terminator(Opcode opcode, AST const * ast, std::string const & name):
@@ -500,6 +538,51 @@ namespace tiny::il {
 
     }; // tiny::il::Instruction::RegBB
 
+    class Instruction::TerminatorRegBBs : public Instruction::Terminator {
+    public:
+        Instruction * reg;
+        BasicBlock * defaultTarget;
+        /** The case values paired with their targets, in the order of the source code. 
+         */
+        std::vector<std::pair<int64_t, BasicBlock *>> cases;
+
+        TerminatorRegBBs(Opcode opcode, Instruction * reg, BasicBlock * defaultTarget, std::vector<std::pair<int64_t, BasicBlock *>> const & cases, AST const * ast = nullptr):
+            Terminator{opcode, ast},
+            reg{reg},
+            defaultTarget{defaultTarget},
+            cases{cases} {
+        }
+
+        TerminatorRegBBs(Opcode opcode, Instruction * reg, BasicBlock * defaultTarget, std::vector<std::pair<int64_t, BasicBlock *>> const & cases, AST const * ast, std::string const & name):
+            Terminator{opcode, ast, name},
+            reg{reg},
+            defaultTarget{defaultTarget},
+            cases{cases} {
+        }
+
+        TerminatorRegBBs(Opcode opcode, Instruction * reg, BasicBlock * defaultTarget, std::vector<std::pair<int64_t, BasicBlock *>> const & cases, std::string const & name):
+            Terminator{opcode, nullptr, name},
+            reg{reg},
+            defaultTarget{defaultTarget},
+            cases{cases} {
+        }
+
+        /** Returns the target for given value.
+         */
+        BasicBlock * targetFor(int64_t value) const {
+            for (auto & c : cases)
+                if (c.first == value)
+                    return c.second;
+            return defaultTarget;
+        }
+
+    protected:
+        void accept(IRVisitor* visitor) override;
+
+        void print(colors::ColorPrinter & p) const override;
+
+    }; // tiny::il::Instruction::TerminatorRegBBs
+
 
 
 /*#define INS(NAME, ENCODING) \
@@ -598,6 +681,9 @@ namespace tiny::il {
     template<typename... Args>
     Instruction::ImmI * ARG(Args... args) { return new Instruction::ImmI{Opcode::ARG, args...}; }
 
+    template<typename... Args>
+    Instruction::Phi * PHI(Args... args) { return new Instruction::Phi{Opcode::PHI, args...}; }
+
     template<typename... Args>
     Instruction::Terminator * RET(Args... args) { return new Instruction::Terminator{Opcode::RET, args...}; }
 
@@ -610,6 +696,9 @@ namespace tiny::il {
     template<typename... Args>
     Instruction::TerminatorRegBB * BR(Args... args) { return new Instruction::TerminatorRegBB{Opcode::BR, args...}; }
 
+    template<typename... Args>
+    Instruction::TerminatorRegBBs * SWITCH(Args... args) { return new Instruction::TerminatorRegBBs{Opcode::SWITCH, args...}; }
+
 
     /** Basic block.
      */
@@ -639,6 +728,33 @@ namespace tiny::il {
             return ins;
         }
 
+        /** Inserts the instruction before the i-th instruction of the basic block.
+         */
+        Instruction * insert(size_t i, Instruction * ins) {
+            insns_.insert(insns_.begin() + static_cast<std::ptrdiff_t>(i), std::unique_ptr<Instruction>{ins});
+            return ins;
+        }
+
+        /** Deletes all instructions for which the predicate holds.
+         */
+        template<typename P>
+        void removeIf(P pred) {
+            insns_.erase(std::remove_if(insns_.begin(), insns_.end(), [&](std::unique_ptr<Instruction> const & i) { return pred(i.get()); }), insns_.end());
+        }
+
+        /** Basic blocks the terminator of the block may jump to.
+         */
+        std::vector<BasicBlock *> successors() const;
+
+        /** Number of phis at the beginning of the block.
+         */
+        size_t numPhis() const {
+            size_t result = 0;
+            while (result < insns_.size() && insns_[result]->opcode == Opcode::PHI)
+                ++result;
+            return result;
+        }
+
         size_t size() const { return insns_.size(); }
 
         Instruction * operator[](size_t i) const { return insns_[i].get(); }
@@ -733,10 +849,10 @@ namespace tiny::il {
             }
         }
 
-        // gets called when we allocate space for a local variable, size is the size of the variable in bytes
+        // gets called when we allocate space for a local variable, size is the size of the variable in bytes rounded up to whole words
         // when we leave a block, then call this function with negative size
         void updateLocalsSize(int size) {
-            assert((size <= 8) && "currently we only support max 8 byte variables");
+            assert((size % T86_WORD_SZ == 0) && "local variables must occupy whole words");
             localsSize_ += size;
             if (localsSize_ > localsMaxSize_)
                 localsMaxSize_ = localsSize_;
@@ -744,10 +860,17 @@ namespace tiny::il {
                 totalLocalsSize_ += size;
         }
 
+        /** Called when an optimization removes a local variable of given size, so that the stack frame does not reserve space for it.
+         */
+        void removeLocal(size_t size) {
+            size_t bytes = (size + T86_WORD_SZ - 1) / T86_WORD_SZ * T86_WORD_SZ;
+            ASSERT(bytes <= totalLocalsSize_);
+            totalLocalsSize_ -= bytes;
+        }
+
         size_t getStackSize(const bool stupid) const {
             if (stupid) {
                 //TODO args might have different size than 1 word, but for simplicity we currently assume they can't
-                assert(totalLocalsSize_ % 8 == 0 && "currently we only support 8 byte variables");
                 return totalLocalsSize_ / T86_WORD_SZ;
             }
             else
@@ -794,10 +917,26 @@ namespace tiny::il {
 
         const std::unordered_map<Symbol, Function *>& getFunctions() const { return functions_; }
 
+        /** Sets the initial contents of the global allocated by given ALLOCG, one value per word. The words past the given ones start zeroed.
+         */
+        void setData(Instruction const * global, std::vector<int64_t> words) {
+            ASSERT(global->opcode == Opcode::ALLOCG);
+            data_[global] = std::move(words);
+        }
+
+        /** Returns the initial words of the global, or nullptr if the whole global starts zeroed.
+         */
+        std::vector<int64_t> const * getData(Instruction const * global) const {
+            auto i = data_.find(global);
+            return (i == data_.end()) ? nullptr : & i->second;
+        }
+
         void print(colors::ColorPrinter & p) const {
             using namespace colors;
             p << COMMENT("; globals") << NEWLINE << INDENT;
             globals_.print(p);
+            for (auto const & [global, words] : data_)
+                p << NEWLINE << COMMENT("; initialized words of ") << global->name << ": " << words.size();
             p << DEDENT << NEWLINE << COMMENT("; number of functions: ") << functions_.size() << NEWLINE;
             for (auto f : functions_) {
                 p << IDENT("function_") << f.first << SYMBOL(":") << INDENT;
@@ -810,6 +949,7 @@ namespace tiny::il {
 
         BasicBlock globals_;
         std::unordered_map<Symbol, Function *> functions_;
+        std::unordered_map<Instruction const *, std::vector<int64_t>> data_;
     };
 
     class IRVisitor {
@@ -823,10 +963,12 @@ namespace tiny::il {
         virtual void visit(Instruction::RegReg* instr) { MARK_AS_UNUSED(instr); NOT_IMPLEMENTED; }
         virtual void visit(Instruction::RegRegImmI* instr) { MARK_AS_UNUSED(instr); NOT_IMPLEMENTED; }
         virtual void visit(Instruction::RegRegs* instr) { MARK_AS_UNUSED(instr); NOT_IMPLEMENTED; }
+        virtual void visit(Instruction::Phi* instr) { MARK_AS_UNUSED(instr); NOT_IMPLEMENTED; }
         virtual void visit(Instruction::Terminator* instr) { MARK_AS_UNUSED(instr); NOT_IMPLEMENTED; }
         virtual void visit(Instruction::TerminatorReg* instr) { MARK_AS_UNUSED(instr); NOT_IMPLEMENTED; }
         virtual void visit(Instruction::TerminatorB* instr) { MARK_AS_UNUSED(instr); NOT_IMPLEMENTED; }
         virtual void visit(Instruction::TerminatorRegBB* instr) { MARK_AS_UNUSED(instr); NOT_IMPLEMENTED; }
+        virtual void visit(Instruction::TerminatorRegBBs* instr) { MARK_AS_UNUSED(instr); NOT_IMPLEMENTED; }
     protected:
         void visitChild(Instruction *instr) {
             instr->accept(this);
@@ -840,10 +982,58 @@ namespace tiny::il {
     inline void Instruction::RegReg::accept(IRVisitor * v) { v->visit(this); }
     inline void Instruction::RegRegImmI::accept(IRVisitor * v) { v->visit(this); }
     inline void Instruction::RegRegs::accept(IRVisitor * v) { v->visit(this); }
+    inline void Instruction::Phi::accept(IRVisitor * v) { v->visit(this); }
     inline void Instruction::Terminator::accept(IRVisitor * v) { v->visit(this); }
     inline void Instruction::TerminatorReg::accept(IRVisitor * v) { v->visit(this); }
     inline void Instruction::TerminatorB::accept(IRVisitor * v) { v->visit(this); }
     inline void Instruction::TerminatorRegBB::accept(IRVisitor * v) { v->visit(this); }
+    inline void Instruction::TerminatorRegBBs::accept(IRVisitor * v) { v->visit(this); }
+
+    inline std::vector<BasicBlock *> BasicBlock::successors() const {
+        if (insns_.empty())
+            return {};
+        Instruction * last = insns_.back().get();
+        if (auto jmp = dynamic_cast<Instruction::TerminatorB *>(last))
+            return { jmp->target };
+        if (auto br = dynamic_cast<Instruction::TerminatorRegBB *>(last))
+            return { br->target1, br->target2 };
+        if (auto sw = dynamic_cast<Instruction::TerminatorRegBBs *>(last)) {
+            std::vector<BasicBlock *> result;
+            for (auto & c : sw->cases)
+                result.push_back(c.second);
+            result.push_back(sw->defaultTarget);
+            return result;
+        }
+        return {};
+    }
+
+    /** Calls the function with a reference to every register the instruction reads so that passes can inspect, or replace them. Phis pass their incoming values.
+     */
+    template<typename FN>
+    void forEachOperand(Instruction * ins, FN fn) {
+        if (auto i = dynamic_cast<Instruction::Reg *>(ins)) {
+            fn(i->reg);
+        } else if (auto i = dynamic_cast<Instruction::RegReg *>(ins)) {
+            fn(i->reg1);
+            fn(i->reg2);
+        } else if (auto i = dynamic_cast<Instruction::RegRegImmI *>(ins)) {
+            fn(i->reg1);
+            fn(i->reg2);
+        } else if (auto i = dynamic_cast<Instruction::RegRegs *>(ins)) {
+            fn(i->reg);
+            for (Instruction * & r : i->regs)
+                fn(r);
+        } else if (auto i = dynamic_cast<Instruction::Phi *>(ins)) {
+            for (auto & in : i->incoming)
+                fn(in.second);
+        } else if (auto i = dynamic_cast<Instruction::TerminatorReg *>(ins)) {
+            fn(i->reg);
+        } else if (auto i = dynamic_cast<Instruction::TerminatorRegBB *>(ins)) {
+            fn(i->reg);
+        } else if (auto i = dynamic_cast<Instruction::TerminatorRegBBs *>(ins)) {
+            fn(i->reg);
+        }
+    }
 
 } // namespace tiny
 
@@ -13,16 +13,24 @@ namespace tiny::il {
     class ILInterpreter {
     public:
         static uint64_t run(Program const & p) {
+            uint64_t executed;
+            return run(p, executed);
+        }
+
+        /** Runs the program and reports the number of instructions executed, which allows comparing the effects of the optimizations.
+         */
+        static uint64_t run(Program const & p, uint64_t & executed) {
             ILInterpreter i{p};
             BasicBlock const * b = p.globals();
             i.locals_ = & i.globals_; // for the execution of the global context
-            b = i.runBasicBlock(b);
+            b = i.runBasicBlock(b, nullptr);
             ASSERT(b == nullptr && "We only support single globals basic block");
             Function const * f = p.getFunction(Symbol{"main"});
             ASSERT(f != nullptr);
             std::vector<Reg> args;
             Reg result = i.runFunction(f, args);
             ASSERT(result.ins->type == RegType::Int);
+            executed = i.executed_;
             return result.iVal;
         }
 
@@ -128,19 +136,26 @@ namespace tiny::il {
             for (size_t i = 0, e = f->numArgs(); i != e; ++i)
                 set(f->getArg(i), args[i]);
             BasicBlock const * bb = f->start();
+            BasicBlock const * from = nullptr;
             while (bb != nullptr) {
                 ASSERT(bb->terminated());
-                bb = runBasicBlock(bb);
+                BasicBlock const * next = runBasicBlock(bb, from);
+                from = bb;
+                bb = next;
             }
             locals_ = oldLocals;
             return retVal_;
         }
 
         /** Runs the given basic block and returns the basic block to be executed next, or nullptr if the function should return.
+
+            The block the control arrived from selects the values of the phis.
          */
-        BasicBlock const * runBasicBlock(BasicBlock const * bb) {
+        BasicBlock const * runBasicBlock(BasicBlock const * bb, BasicBlock const * from) {
             BasicBlock * next = nullptr;
             bool terminated = false;
+            runPhis(bb, from);
+            executed_ += bb->size();
             for (size_t i = 0, e = bb->size(); i != e; ++i) {
                 Instruction const * ins = (*bb)[i];
                 switch (ins->opcode) {
@@ -174,12 +189,28 @@ namespace tiny::il {
                         mem_.write(get(st->reg1).iVal, get(st->reg2));
                         break;
                     }
-                    case Opcode::ALLOCA:
-                    case Opcode::ALLOCG: {
+                    case Opcode::ALLOCA: {
                         int64_t  size = IMMI(ins)->value;
                         set(ins, mem_.alloc(size));
                         break;
                     }
+                    /** Globals may have initial contents, such as the string pool.
+                     */
+                    case Opcode::ALLOCG: {
+                        int64_t address = mem_.alloc(IMMI(ins)->value);
+                        if (auto words = p_.getData(ins))
+                            for (size_t i = 0; i < words->size(); ++i)
+                                mem_.write(address + static_cast<int64_t>(i * sizeof(int64_t)), Reg{(*words)[i], ins});
+                        set(ins, address);
+                        break;
+                    }
+                    /** The address of an element is the base moved by index times the element size.
+                     */
+                    case Opcode::GEP: {
+                        auto gep = REG_REG_IMMI(ins);
+                        set(ins, get(gep->reg1).iVal + get(gep->reg2).iVal * gep->value);
+                        break;
+                    }
                     case Opcode::ADD: {
                         auto add = REG_REG(ins);
                         Reg lhs = get(add->reg1);
@@ -224,6 +255,20 @@ namespace tiny::il {
                         executeBinaryOperation(ins, [](auto lhs, auto rhs) { return static_cast<int64_t>(lhs > rhs ? 1 : 0); }, lhs, rhs);
                         break;
                     }
+                    case Opcode::LTE: {
+                        auto lte = REG_REG(ins);
+                        Reg lhs = get(lte->reg1);
+                        Reg rhs = get(lte->reg2);
+                        executeBinaryOperation(ins, [](auto lhs, auto rhs) { return static_cast<int64_t>(lhs <= rhs ? 1 : 0); }, lhs, rhs);
+                        break;
+                    }
+                    case Opcode::GTE: {
+                        auto gte = REG_REG(ins);
+                        Reg lhs = get(gte->reg1);
+                        Reg rhs = get(gte->reg2);
+                        executeBinaryOperation(ins, [](auto lhs, auto rhs) { return static_cast<int64_t>(lhs >= rhs ? 1 : 0); }, lhs, rhs);
+                        break;
+                    }
                     case Opcode::EQ: {
                         auto eq = REG_REG(ins);
                         Reg lhs = get(eq->reg1);
@@ -269,6 +314,11 @@ namespace tiny::il {
                         //set(ins, (*args_)[IMMI(ins)->value]);
                         break;
                     }
+                    /** Phis have already been evaluated when entering the block.
+                     */
+                    case Opcode::PHI: {
+                        break;
+                    }
                     case Opcode::RET: {
                         ASSERT(!terminated);
                         terminated = true;
@@ -291,8 +341,18 @@ namespace tiny::il {
                         terminated = true;
                         auto br = TERMINATOR_REG_BB(ins);
                         Reg cond = get(br->reg);
-                        ASSERT(cond.ins->type == RegType::Int);
-                        next = (cond.iVal == 0) ? br->target2 : br->target1;
+                        // doubles are true unless zero, as the operands of && and ||
+                        bool isZero = cond.ins->type == RegType::Float ? cond.fVal == 0 : cond.iVal == 0;
+                        next = isZero ? br->target2 : br->target1;
+                        break;
+                    }
+                    case Opcode::SWITCH: {
+                        ASSERT(!terminated);
+                        terminated = true;
+                        auto sw = TERMINATOR_REG_BBS(ins);
+                        Reg value = get(sw->reg);
+                        ASSERT(value.ins->type == RegType::Int);
+                        next = sw->targetFor(value.iVal);
                         break;
                     }
                     default:
@@ -303,6 +363,19 @@ namespace tiny::il {
             return next;
         }
 
+        /** All phis of the block read their values before any of them is set, as a phi may use another phi of the same block (e.g. swapping two variables in a loop).
+         */
+        void runPhis(BasicBlock const * bb, BasicBlock const * from) {
+            std::vector<Reg> values;
+            for (size_t i = 0, e = bb->numPhis(); i != e; ++i) {
+                Instruction * value = dynamic_cast<Instruction::Phi const *>((*bb)[i])->from(from);
+                ASSERT(value != nullptr && "Phi has no value for the predecessor");
+                values.push_back(get(value));
+            }
+            for (size_t i = 0; i < values.size(); ++i)
+                set((*bb)[i], values[i]);
+        }
+
         static Instruction::ImmI const * IMMI(Instruction const * ins) {
             return dynamic_cast<Instruction::ImmI const *>(ins);
         }
@@ -323,6 +396,10 @@ namespace tiny::il {
             return dynamic_cast<Instruction::RegReg const *>(ins);
         }
 
+        static Instruction::RegRegImmI const * REG_REG_IMMI(Instruction const * ins) {
+            return dynamic_cast<Instruction::RegRegImmI const *>(ins);
+        }
+
         static Instruction::RegRegs const * REG_REGS(Instruction const * ins) {
             return dynamic_cast<Instruction::RegRegs const *>(ins);
         }
@@ -336,6 +413,9 @@ namespace tiny::il {
         static Instruction::TerminatorRegBB const * TERMINATOR_REG_BB(Instruction const * ins) {
             return dynamic_cast<Instruction::TerminatorRegBB const *>(ins);
         }
+        static Instruction::TerminatorRegBBs const * TERMINATOR_REG_BBS(Instruction const * ins) {
+            return dynamic_cast<Instruction::TerminatorRegBBs const *>(ins);
+        }
 
         void set(Instruction const * ins, int64_t value) {
             ASSERT(ins->type == RegType::Int);
@@ -397,6 +477,8 @@ namespace tiny::il {
         std::unordered_map<Instruction const *, Reg> * locals_;
         // return value from a function
         Reg retVal_;
+        // number of instructions executed so far
+        uint64_t executed_ = 0;
 
 
     }; // tiny::ILInterpreter
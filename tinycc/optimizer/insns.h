@@ -64,9 +64,17 @@ INS(FUN, ImmS)
 INS(CALL, RegRegs)
 INS(ARG, ImmI)
 
+/** Selects the value of the register coming from the basic block the control arrived from. Phis only appear at the beginning of basic blocks and all phis of a block take their values at once.
+ */
+INS(PHI, Phi)
+
 INS(RET, Terminator)
 INS(RETR, TerminatorReg)
 INS(JMP, TerminatorB)
 INS(BR, TerminatorRegBB)
 
+/** Jumps to the basic block of the case whose value equals the register, or to the default basic block if there is no such case. 
+ */
+INS(SWITCH, TerminatorRegBBs)
+
 #undef INS
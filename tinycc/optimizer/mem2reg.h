@@ -0,0 +1,329 @@
+#pragma once
+
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "dominators.h"
+#include "il.h"
+
+namespace tiny::il {
+
+    /** Promotes local variables to registers, turning the function into SSA form.
+
+        The translator gives every local variable and argument its own ALLOCA and reads and writes it by LD and ST. A variable whose address is never used otherwise, i.e. it is not passed to calls, stored, or offset into, can instead live in registers: every load is replaced by the value last stored along the path to it. Where different values meet, the variable gets a phi, these are placed at the iterated dominance frontiers of the blocks storing to the variable and the values are then assigned by a walk of the dominator tree (Cytron et al.). Loads that no store reaches read zero.
+
+        Phis take their values on the edges they come from, so an edge from a branch or a switch to a block with phis is split by a block with a single jump for the backend to place the copies in. Phis that end up unused, or selecting a single value are removed.
+     */
+    class Mem2Reg {
+    public:
+
+        static void optimize(Program & p) {
+            for (auto & [name, f] : p.getFunctions())
+                Mem2Reg{f}.promote();
+        }
+
+    private:
+
+        explicit Mem2Reg(Function * f):
+            f_{f} {
+        }
+
+        /** A promoted variable.
+         */
+        struct Variable {
+            Instruction * alloca;
+            RegType type;
+            /** Blocks that store to the variable.
+             */
+            std::vector<BasicBlock *> defs;
+            /** Value of loads that no store reaches, created when first needed.
+             */
+            Instruction * undefined = nullptr;
+            /** Values of the variable along the dominator tree path being renamed.
+             */
+            std::vector<Instruction *> values;
+        }; // Mem2Reg::Variable
+
+        void promote() {
+            removeUnreachable();
+            DominatorTree dt{f_};
+            findVariables(dt);
+            if (vars_.empty())
+                return;
+            placePhis(dt);
+            rename(dt);
+            simplifyPhis();
+            removeDead();
+            splitPhiEdges(dt);
+        }
+
+        /** Blocks no path from the start leads to are never executed, but would still refer to the variables.
+         */
+        void removeUnreachable() {
+            DominatorTree dt{f_};
+            auto & bbs = f_->getBasicBlocks();
+            bbs.erase(std::remove_if(bbs.begin(), bbs.end(), [&](std::unique_ptr<BasicBlock> const & b) { return ! dt.reachable(b.get()); }), bbs.end());
+        }
+
+        /** Finds allocas whose every use is a load from, or a store to the variable of a single register type.
+         */
+        void findVariables(DominatorTree const & dt) {
+            std::unordered_map<Instruction *, size_t> candidates;
+            std::vector<Variable> vars;
+            std::vector<bool> promotable;
+            for (BasicBlock * b : dt.blocks()) {
+                for (size_t i = 0, e = b->size(); i != e; ++i) {
+                    Instruction * ins = (*b)[i];
+                    if (ins->opcode == Opcode::ALLOCA && static_cast<Instruction::ImmI *>(ins)->value <= static_cast<int64_t>(T86_WORD_SZ)) {
+                        candidates[ins] = vars.size();
+                        vars.push_back(Variable{ins, RegType::Void, {}, nullptr, {}});
+                        promotable.push_back(true);
+                    }
+                }
+            }
+            auto use = [&](Instruction * reg, RegType type) {
+                auto i = candidates.find(reg);
+                if (i == candidates.end())
+                    return;
+                Variable & v = vars[i->second];
+                if (type == RegType::Void || (v.type != RegType::Void && v.type != type))
+                    promotable[i->second] = false;
+                v.type = type;
+            };
+            for (BasicBlock * b : dt.blocks()) {
+                for (size_t i = 0, e = b->size(); i != e; ++i) {
+                    Instruction * ins = (*b)[i];
+                    if (ins->opcode == Opcode::LD) {
+                        use(static_cast<Instruction::Reg *>(ins)->reg, ins->type);
+                    } else if (ins->opcode == Opcode::ST) {
+                        auto st = static_cast<Instruction::RegReg *>(ins);
+                        use(st->reg1, st->reg2->type);
+                        // storing the address itself lets it escape
+                        use(st->reg2, RegType::Void);
+                        auto v = candidates.find(st->reg1);
+                        if (v != candidates.end())
+                            vars[v->second].defs.push_back(b);
+                    } else {
+                        forEachOperand(ins, [&](Instruction * & reg) { use(reg, RegType::Void); });
+                    }
+                }
+            }
+            for (size_t i = 0; i < vars.size(); ++i) {
+                if (! promotable[i])
+                    continue;
+                if (vars[i].type == RegType::Void)
+                    vars[i].type = RegType::Int; // neither loaded, nor stored
+                varIndex_[vars[i].alloca] = vars_.size();
+                vars_.push_back(std::move(vars[i]));
+            }
+        }
+
+        /** Places phis at the iterated dominance frontier of the blocks storing to each variable.
+         */
+        void placePhis(DominatorTree const & dt) {
+            for (size_t vi = 0; vi < vars_.size(); ++vi) {
+                Variable & v = vars_[vi];
+                std::unordered_set<BasicBlock *> hasPhi;
+                std::unordered_set<BasicBlock *> queued{v.defs.begin(), v.defs.end()};
+                std::vector<BasicBlock *> worklist{queued.begin(), queued.end()};
+                while (! worklist.empty()) {
+                    BasicBlock * b = worklist.back();
+                    worklist.pop_back();
+                    for (BasicBlock * df : dt.frontier(b)) {
+                        if (! hasPhi.insert(df).second)
+                            continue;
+                        Instruction * phi = df->insert(0, PHI(v.type, v.alloca->ast, v.alloca->name));
+                        phiVar_[phi] = vi;
+                        if (queued.insert(df).second)
+                            worklist.push_back(df);
+                    }
+                }
+            }
+        }
+
+        /** Walks the dominator tree replacing loads by the values of the variables and filling in the phis of the successors.
+         */
+        void rename(DominatorTree const & dt) {
+            // second of the pair tells whether the block is being entered, or left
+            std::vector<std::pair<BasicBlock *, bool>> stack{{f_->start(), true}};
+            std::unordered_map<BasicBlock *, std::vector<size_t>> pushed;
+            while (! stack.empty()) {
+                auto [b, entering] = stack.back();
+                stack.pop_back();
+                if (! entering) {
+                    for (size_t vi : pushed[b])
+                        vars_[vi].values.pop_back();
+                    continue;
+                }
+                std::vector<size_t> & defined = pushed[b];
+                for (size_t i = 0, e = b->size(); i != e; ++i) {
+                    Instruction * ins = (*b)[i];
+                    if (ins->opcode == Opcode::PHI) {
+                        auto v = phiVar_.find(ins);
+                        if (v != phiVar_.end()) {
+                            vars_[v->second].values.push_back(ins);
+                            defined.push_back(v->second);
+                        }
+                        continue;
+                    }
+                    forEachOperand(ins, [&](Instruction * & reg) { reg = resolve(reg); });
+                    if (ins->opcode == Opcode::LD) {
+                        auto v = varIndex_.find(static_cast<Instruction::Reg *>(ins)->reg);
+                        if (v != varIndex_.end()) {
+                            replaced_[ins] = currentValue(v->second);
+                            dead_.insert(ins);
+                        }
+                    } else if (ins->opcode == Opcode::ST) {
+                        auto st = static_cast<Instruction::RegReg *>(ins);
+                        auto v = varIndex_.find(st->reg1);
+                        if (v != varIndex_.end()) {
+                            vars_[v->second].values.push_back(st->reg2);
+                            defined.push_back(v->second);
+                            dead_.insert(ins);
+                        }
+                    }
+                }
+                for (BasicBlock * s : b->successors()) {
+                    for (size_t i = 0, e = s->numPhis(); i != e; ++i) {
+                        auto v = phiVar_.find((*s)[i]);
+                        if (v != phiVar_.end())
+                            static_cast<Instruction::Phi *>((*s)[i])->incoming.emplace_back(b, currentValue(v->second));
+                    }
+                }
+                stack.emplace_back(b, false);
+                for (BasicBlock * c : dt.children(b))
+                    stack.emplace_back(c, true);
+            }
+            // the zeros read by uninitialized loads go first so that they dominate all their uses
+            for (Variable & v : vars_)
+                if (v.undefined != nullptr)
+                    f_->start()->insert(0, v.undefined);
+        }
+
+        Instruction * currentValue(size_t vi) {
+            Variable & v = vars_[vi];
+            if (! v.values.empty())
+                return v.values.back();
+            if (v.undefined == nullptr)
+                v.undefined = (v.type == RegType::Float) ? static_cast<Instruction *>(LDF(RegType::Float, 0.0)) : LDI(RegType::Int, 0);
+            return v.undefined;
+        }
+
+        Instruction * resolve(Instruction * reg) {
+            auto i = replaced_.find(reg);
+            while (i != replaced_.end()) {
+                reg = i->second;
+                i = replaced_.find(reg);
+            }
+            return reg;
+        }
+
+        /** A phi all of whose incoming values are the same value, or the phi itself (a loop that does not change the variable) is that value.
+         */
+        void simplifyPhis() {
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (auto & [phi, vi] : phiVar_) {
+                    if (dead_.count(phi))
+                        continue;
+                    Instruction * same = nullptr;
+                    bool unique = true;
+                    for (auto & in : static_cast<Instruction::Phi *>(phi)->incoming) {
+                        Instruction * value = resolve(in.second);
+                        if (value == phi || value == same)
+                            continue;
+                        if (same != nullptr)
+                            unique = false;
+                        same = value;
+                    }
+                    if (unique && same != nullptr) {
+                        replaced_[phi] = same;
+                        dead_.insert(phi);
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        /** Deletes the promoted variables with their loads and stores and the phis no instruction other than dead phis uses.
+         */
+        void removeDead() {
+            for (auto & b : f_->getBasicBlocks())
+                for (size_t i = 0, e = b->size(); i != e; ++i)
+                    forEachOperand((*b)[i], [&](Instruction * & reg) { reg = resolve(reg); });
+            std::unordered_set<Instruction *> live;
+            std::vector<Instruction *> worklist;
+            for (auto & b : f_->getBasicBlocks()) {
+                for (size_t i = 0, e = b->size(); i != e; ++i) {
+                    Instruction * ins = (*b)[i];
+                    if (ins->opcode == Opcode::PHI || dead_.count(ins))
+                        continue;
+                    forEachOperand(ins, [&](Instruction * & reg) {
+                        if (reg->opcode == Opcode::PHI && live.insert(reg).second)
+                            worklist.push_back(reg);
+                    });
+                }
+            }
+            while (! worklist.empty()) {
+                Instruction * phi = worklist.back();
+                worklist.pop_back();
+                forEachOperand(phi, [&](Instruction * & reg) {
+                    if (reg->opcode == Opcode::PHI && live.insert(reg).second)
+                        worklist.push_back(reg);
+                });
+            }
+            for (Variable & v : vars_) {
+                dead_.insert(v.alloca);
+                f_->removeLocal(static_cast<size_t>(static_cast<Instruction::ImmI *>(v.alloca)->value));
+            }
+            for (auto & b : f_->getBasicBlocks())
+                b->removeIf([&](Instruction * ins) { return dead_.count(ins) || (ins->opcode == Opcode::PHI && ! live.count(ins)); });
+        }
+
+        /** Splits edges from branches and switches to blocks with phis by a block that only jumps, so that the copies the phis need can be placed on each edge separately.
+         */
+        void splitPhiEdges(DominatorTree const & dt) {
+            for (BasicBlock * b : dt.blocks()) {
+                std::vector<BasicBlock **> targets;
+                if (auto * br = dynamic_cast<Instruction::TerminatorRegBB *>((*b)[b->size() - 1])) {
+                    targets = { & br->target1, & br->target2 };
+                } else if (auto * sw = dynamic_cast<Instruction::TerminatorRegBBs *>((*b)[b->size() - 1])) {
+                    for (auto & c : sw->cases)
+                        targets.push_back(& c.second);
+                    targets.push_back(& sw->defaultTarget);
+                }
+                for (BasicBlock ** target : targets) {
+                    if ((*target)->numPhis() == 0)
+                        continue;
+                    BasicBlock * edge = f_->addBasicBlock("edge");
+                    edge->append(JMP(*target));
+                    for (size_t i = 0, e = (*target)->numPhis(); i != e; ++i) {
+                        for (auto & in : static_cast<Instruction::Phi *>((**target)[i])->incoming) {
+                            if (in.first == b) {
+                                in.first = edge;
+                                break;
+                            }
+                        }
+                    }
+                    *target = edge;
+                }
+            }
+        }
+
+        Function * f_;
+        std::vector<Variable> vars_;
+        std::unordered_map<Instruction *, size_t> varIndex_;
+        std::unordered_map<Instruction *, size_t> phiVar_;
+        /** Loads and phis replaced by other values.
+         */
+        std::unordered_map<Instruction *, Instruction *> replaced_;
+        /** Instructions to be deleted.
+         */
+        std::unordered_set<Instruction *> dead_;
+
+    }; // tiny::il::Mem2Reg
+
+} // namespace tiny::il
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "il.h"
+#include "mem2reg.h"
 #include "peephole.h"
 #include "reg_optimizer.h"
 
@@ -28,21 +31,25 @@ namespace tiny {
     public:
         static void optimize(il::Program &program) {
             MiddleEndOptimizer opt;
+            il::Mem2Reg::optimize(program);
             opt.removeRedundantJMPBBs(program);
+            opt.bypassPhiEdgeBBs(program);
+            opt.removeEmptyStartBBs(program);
         }
 
     private:
         MiddleEndOptimizer() = default;
         //some BBs only contain a JMP instruction, this function removes them
+        //blocks jumping to phis are kept as the phis select their values by them
         static void removeRedundantJMPBBs(il::Program& program) {
             std::unordered_map<il::BasicBlock *, il::BasicBlock *> redundantBlocks;
             // Step 1: Identify redundant blocks
             for (const auto &[name, function]: program.getFunctions()) {
                 for (const auto &bbPtr: function->getBasicBlocks()) {
-                    if (bbPtr->size() == 1) {  // Check if only one instruction
+                    if (bbPtr->size() == 1 && bbPtr.get() != function->start()) {  // Check if only one instruction, the start must stay first
                         auto *terminatorB = dynamic_cast<il::Instruction::TerminatorB *>(bbPtr->operator[](0));
                         // Check if the single instruction is a JMP
-                        if (terminatorB && terminatorB->opcode == il::Opcode::JMP) {
+                        if (terminatorB && terminatorB->opcode == il::Opcode::JMP && terminatorB->target->numPhis() == 0) {
                             redundantBlocks[bbPtr.get()] = terminatorB->target;
                         }
                     }
@@ -52,7 +59,7 @@ namespace tiny {
             bool changed = true;
             while (changed) {
                 changed = false;
-                // Step 2: Redirect JMPs and BRs
+                // Step 2: Redirect JMPs, BRs and SWITCHes
                 for (const auto &[name, function]: program.getFunctions()) {
                     for (const auto &bbPtr: function->getBasicBlocks()) {
                         for (size_t i = 0; i < bbPtr->size(); ++i) {
@@ -79,6 +86,22 @@ namespace tiny {
                                     terminatorRegBB->target2 = found2->second;
                                     changed = true;
                                 }
+                                continue;
+                            }
+                            auto *terminatorRegBBs = dynamic_cast<il::Instruction::TerminatorRegBBs *>(bbPtr->operator[](i));
+                            if (terminatorRegBBs && terminatorRegBBs->opcode == il::Opcode::SWITCH) {
+                                for (auto &c: terminatorRegBBs->cases) {
+                                    auto found = redundantBlocks.find(c.second);
+                                    if (found != redundantBlocks.end()) {
+                                        c.second = found->second;
+                                        changed = true;
+                                    }
+                                }
+                                auto found = redundantBlocks.find(terminatorRegBBs->defaultTarget);
+                                if (found != redundantBlocks.end()) {
+                                    terminatorRegBBs->defaultTarget = found->second;
+                                    changed = true;
+                                }
                             }
                         }
                     }
@@ -96,6 +119,66 @@ namespace tiny {
             }
         }
 
+        //the start block is kept by removeRedundantJMPBBs, if it only jumps to a block with no other predecessors, that block becomes the start
+        static void removeEmptyStartBBs(il::Program& program) {
+            for (const auto &[name, function]: program.getFunctions()) {
+                auto &bbs = function->getBasicBlocks();
+                auto *jmp = dynamic_cast<il::Instruction::TerminatorB *>(bbs[0]->operator[](0));
+                if (bbs[0]->size() != 1 || jmp == nullptr || jmp->opcode != il::Opcode::JMP || jmp->target == bbs[0].get())
+                    continue;
+                bool otherPreds = false;
+                for (const auto &bbPtr: bbs) {
+                    if (bbPtr == bbs[0])
+                        continue;
+                    for (il::BasicBlock *succ: bbPtr->successors())
+                        otherPreds = otherPreds || succ == jmp->target;
+                }
+                if (otherPreds)
+                    continue;
+                auto target = std::find_if(bbs.begin(), bbs.end(), [&](const std::unique_ptr<il::BasicBlock>& bb) { return bb.get() == jmp->target; });
+                std::iter_swap(bbs.begin(), target);
+                bbs.erase(target);
+            }
+        }
+
+        //a block that only jumps to phis can be bypassed if its single predecessor ends with a JMP, which then becomes the phis' predecessor instead
+        static void bypassPhiEdgeBBs(il::Program& program) {
+            for (const auto &[name, function]: program.getFunctions()) {
+                std::unordered_map<il::BasicBlock *, std::vector<il::BasicBlock *>> preds;
+                for (const auto &bbPtr: function->getBasicBlocks())
+                    for (il::BasicBlock *succ: bbPtr->successors())
+                        preds[succ].push_back(bbPtr.get());
+                std::unordered_set<il::BasicBlock *> bypassed;
+                for (const auto &bbPtr: function->getBasicBlocks()) {
+                    auto *jmp = dynamic_cast<il::Instruction::TerminatorB *>(bbPtr->operator[](0));
+                    if (bbPtr->size() != 1 || jmp == nullptr || jmp->opcode != il::Opcode::JMP || jmp->target->numPhis() == 0)
+                        continue;
+                    auto &from = preds[bbPtr.get()];
+                    if (from.size() != 1 || bypassed.count(from[0]))
+                        continue;
+                    il::BasicBlock *pred = from[0];
+                    auto *predJmp = dynamic_cast<il::Instruction::TerminatorB *>(pred->operator[](pred->size() - 1));
+                    // the phis would not know which of the two edges was taken
+                    auto &targetPreds = preds[jmp->target];
+                    if (predJmp == nullptr || predJmp->opcode != il::Opcode::JMP || std::find(targetPreds.begin(), targetPreds.end(), pred) != targetPreds.end())
+                        continue;
+                    predJmp->target = jmp->target;
+                    for (size_t i = 0, e = jmp->target->numPhis(); i != e; ++i)
+                        for (auto &in: static_cast<il::Instruction::Phi *>(jmp->target->operator[](i))->incoming)
+                            if (in.first == bbPtr.get())
+                                in.first = pred;
+                    std::replace(targetPreds.begin(), targetPreds.end(), bbPtr.get(), pred);
+                    bypassed.insert(bbPtr.get());
+                }
+                function->getBasicBlocks().erase(std::remove_if(function->getBasicBlocks().begin(),
+                                                                function->getBasicBlocks().end(),
+                                                                [&](const std::unique_ptr<il::BasicBlock>& bb) {
+                                                                    return bypassed.count(bb.get()) > 0;
+                                                                }),
+                                                 function->getBasicBlocks().end());
+            }
+        }
+
     };
 
 
@@ -229,6 +312,12 @@ namespace tiny {
                 case il::Opcode::ADD:
                     // TODO
                     break;
+                case il::Opcode::PHI:
+                    // TODO the value is the merge of the values of the incoming registers
+                    break;
+                case il::Opcode::SWITCH:
+                    // terminators define no value
+                    break;
             }
             NOT_IMPLEMENTED;
         }
@@ -65,7 +65,7 @@ namespace tiny {
             size_t bb = bbIndex_;
             size_t instr = instrIndex_;
             while (n > 1) {
-                if (instr >= bbs_->operator[](bb)->size()) {
+                if (instr + 1 >= bbs_->operator[](bb)->size()) {
                     instr = 0;
                     bb++;
                 }
@@ -217,8 +217,8 @@ namespace tiny {
             auto next = getInstruction();
             auto nextMovIns = dynamic_cast<t86::MOVIns *>(next);
             if (nextMovIns == nullptr) return false;
-            if (*nextMovIns->operand1_ == *source) {
-                remove(1, i);
+            if (*nextMovIns->operand1_ == *source && *nextMovIns->operand2_ == *movIns->operand1_) {
+                remove(2, next);
             }
             return false;
         }
@@ -19,6 +19,9 @@ std::vector<Test> arithmetic_tests = {
     //TEST("int main() { double a = 3.5; char b = 'A'; return a + b * 2.0; }"),
     TEST("char getChar() { return 'A'; } \
           int main() { int a = 5; char b = getChar(); int c = 2; return a + b; }"),
+    TEST("int main() { return 8589934592 / 4294967296; }", 2),
+    TEST("int main() { return 9223372036854775807 - 9223372036854775806; }", 1),
+    ERROR("int main() { return 9223372036854775808; }", ParserError),
 };
 
 DEFINE_TEST_CATEGORY(arithmetic_tests)
@@ -7,6 +7,16 @@
 std::vector<Test> array_tests = {
     TEST("int main() { int arr[5]; return arr[2]; }"),
     TEST("int main() { int arr[5]; return arr[10]; }"),
+    TEST("int main() { int a[5]; a[0] = 3; a[1] = 4; a[4] = a[0] + a[1]; return a[4]; }", 7),
+    TEST("int main() { int a[10]; int i = 0; while (i < 10) { a[i] = i * i; i = i + 1; } int s = 0; i = 0; while (i < 10) { s = s + a[i]; i = i + 1; } return s; }", 285),
+    TEST("int main() { int a[4]; a[3] = 7; a[1] = 9; a[2] = 8; a[a[3] - 7] = 100; return a[0] + a[1] + a[2] + a[3]; }", 124),
+    TEST("int main() { int a[4]; a[3] = 5; a[0] = 2; a[2] = 6; a[a[0] - 1] = 30; return a[0] + a[1] * 2 + a[2] + a[3]; }", 73),
+    TEST("int main() { int a[5]; int * p = a; a[0] = 1000; p[1] = 500; a[2] = 70; p[3] = 2; a[4] = 9; return a[0] + p[1] + a[2] + p[3] + a[4]; }", 1581),
+    TEST("int sum(int * p, int n) { int s = 0; int i = 0; while (i < n) { s = s + p[i]; i = i + 1; } return s; } int main() { int a[4]; a[0] = 1; a[1] = 2; a[2] = 3; a[3] = 4; return sum(a, 4); }", 10),
+    TEST("void fill(int * p, int n) { int i = 0; while (i < n) { p[i] = i + 1; i = i + 1; } } int main() { int a[5]; a[0] = 100; fill(a, 5); return a[0] + a[4] * 10; }", 51),
+    TEST("int main() { int a[4]; a[0] = 1; a[1] = 2; a[2] = 3; a[3] = 4; return a[3] * 1000 + a[2] * 100 + a[1] * 10 + a[0]; }", 4321),
+    TEST("int main() { int x = 1; int y = 2; int * arr[2]; arr[1] = &y; arr[0] = &x; return *arr[1] * 10 + *arr[0]; }", 21),
+    TEST("int main() { char a[3]; a[0] = 'a'; a[1] = 'b'; a[2] = 'c'; int r = 0; if (a[1] == 'b') r = 1; return r * 100 + a[2] - a[0]; }", 102),
 };
 
 DEFINE_TEST_CATEGORY(array_tests)
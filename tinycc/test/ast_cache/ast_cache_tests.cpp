@@ -0,0 +1,100 @@
+#include <iostream>
+#include <sstream>
+
+#include "common/colors.h"
+#include "frontend/ast_cache.h"
+#include "frontend/ast_walker.h"
+#include "frontend/parser.h"
+#include "frontend/typechecker.h"
+#include "test/test.h"
+
+#include "ast_cache_tests.h"
+
+using namespace tiny;
+using namespace colors;
+
+namespace {
+
+    /** The printed AST followed by the offsets and types of all its nodes and the layouts of the structs it defines.
+     */
+    std::string Dump(ASTProgram * ast) {
+        std::stringstream ss;
+        ss << ColorPrinter::colorize(*ast) << "\n";
+        ASTWalker nodes{[&ss](AST * node) {
+            ss << node->location().offset() << ":";
+            if (node->type() != nullptr)
+                ss << *node->type();
+            ss << " ";
+        }};
+        nodes.walk(ast);
+        ss << "\n";
+        for (AST * s : ast->statements)
+            if (auto decl = dynamic_cast<ASTStructDecl *>(s); decl != nullptr && decl->isDefinition)
+                static_cast<StructType *>(decl->type())->formatLayout(ss);
+        return ss.str();
+    }
+
+    /** Returns an empty string if the program round-trips through the cache, or what went wrong. Programs that do not typecheck are skipped.
+     */
+    std::string RoundTrip(char const * input) {
+        SourceFile & file = SourceFile::FromText(input, "");
+        std::string data;
+        std::string expected;
+        try {
+            std::unique_ptr<AST> ast{Parser::parseFile(file)};
+            Typechecker::checkProgram(ast, false);
+            auto program = static_cast<ASTProgram *>(ast.get());
+            data = ASTWriter::Write(program, file.text(), 0);
+            expected = Dump(program);
+        } catch (SourceError const &) {
+            SourceFile::Close(file.id());
+            return "";
+        }
+        std::string result;
+        try {
+            std::unique_ptr<ASTProgram> read = ASTReader::Read(data, file, 0);
+            if (read == nullptr)
+                result = "cache rejected";
+            else if (std::string actual = Dump(read.get()); actual != expected)
+                result = STR("read program differs\n    expected: " << expected << "\n    actual: " << actual);
+        } catch (std::runtime_error const & e) {
+            result = e.what();
+        }
+        std::string changed{file.text()};
+        if (! changed.empty()) {
+            changed.back() = changed.back() == ' ' ? '\n' : ' ';
+            SourceFile & other = SourceFile::FromText(changed, "");
+            if (result.empty() && ASTReader::Read(data, other, 0) != nullptr)
+                result = "cache accepted for a different source";
+            SourceFile::Close(other.id());
+        }
+        SourceFile::Close(file.id());
+        return result;
+    }
+
+}
+
+bool RunASTCacheTests() {
+    std::cout << "Running tests in category: " << color::blue << "ast_cache_tests" << color::reset << std::endl;
+    size_t total = 0;
+    size_t fails = 0;
+    for (auto const & [suiteName, tests] : testCategories) {
+        for (Test const & t : tests) {
+            if (t.shouldError != nullptr)
+                continue;
+            ++total;
+            std::string error = RoundTrip(t.input);
+            if (! error.empty()) {
+                std::cout << color::red << t.file << ":" << t.line << ": " << error << color::reset << std::endl;
+                std::cout << "    " << t.input << std::endl;
+                ++fails;
+            }
+        }
+    }
+    if (fails > 0) {
+        std::cout << color::red << "All: " << fails << "/" << total << " failed." << color::reset << std::endl;
+        return false;
+    }
+    std::cout << color::green << "PASS. All " << total << " programs round-trip through the AST cache." << color::reset << std::endl;
+    return true;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+/** Round-trip test of the AST cache.
+
+    Writes every test program that typechecks into the cache format and reads it back. The read program must print the same, with the same types of all its nodes and the same struct layouts, and the cache must be rejected for a source of the same size with a different character. Returns true if all programs round-trip.
+ */
+bool RunASTCacheTests();
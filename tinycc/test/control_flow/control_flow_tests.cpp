@@ -56,6 +56,151 @@ std::vector<Test> control_flow_tests = {
     TEST("int main(int a) { return 1; if (a) { return 2; }}"),
     TEST("int main() { if (1) {return 10;} else return 2; }", 10),
     TEST("int main() { if (0) return 10; else return 2; }", 2),
+    TEST("int f(int x) { \
+         int r = 0; \
+         switch (x) { \
+            case 1: r = 10; break;\
+            case 2: r = 20; break;\
+            case 3: r = 30; break;\
+            case 4: r = 40; break;\
+            case 6: r = 60; break;\
+            default: r = 1;\
+         }\
+         return r; \
+     } \
+     int main() { return f(1) + f(3) + f(5) + f(6) + f(9); }", 102),
+    TEST("int f(int x) { \
+         int r = 0; \
+         switch (x) { \
+            case 1000: r = 1; break;\
+            case 7: r = 2; break;\
+            case 40: r = 3; break;\
+            case 300: r = 4; break;\
+            case 55: r = 5; break;\
+         }\
+         return r; \
+     } \
+     int main() { return f(1000) * 1000 + f(40) * 100 + f(55) * 10 + f(8); }", 1350),
+    TEST("int main() { \
+         int r = 0; \
+         switch (2) { \
+            case 1: r = r + 1;\
+            case 2: r = r + 2;\
+            case 3: r = r + 3; break;\
+            case 4: r = r + 4;\
+         }\
+         return r; \
+     }", 5),
+    TEST("int f(int x) { int r = 0; switch (x) { case 0: r = 1; break; case 4294967296: r = 2; break; } return r; } \
+     int main() { return f(4294967296) * 10 + f(0); }", 21),
+    TEST("int f(int x) { \
+         int r = 0; \
+         switch (x) { \
+            case 4294967296: r = 1; break;\
+            case 4294967297: r = 2; break;\
+            case 4294967298: r = 3; break;\
+            case 4294967300: r = 4; break;\
+         }\
+         return r; \
+     } \
+     int main() { return f(4294967300) * 100 + f(4294967297) * 10 + f(2); }", 420),
+    TEST("int f(int x) { \
+         int r = 0; \
+         switch (x) { \
+            case 9223372036854775807: r = 1; break;\
+            case 0: r = 2; break;\
+            case 5: r = 3; break;\
+            case 4294967296: r = 4; break;\
+         }\
+         return r; \
+     } \
+     int main() { return f(9223372036854775807) * 1000 + f(0) * 100 + f(4294967296) * 10 + f(5); }", 1243),
+    TEST("int main() { int r = 0; switch (5) { case 1: r = 1; } return r; }", 0),
+    TEST("int main() { int r = 0; switch (7) { default: r = 5; break; case 0: r = 9; } return r; }", 5),
+    TEST("int main() { \
+         int r = 1; \
+         int i = 0; \
+         switch (3) { \
+            case 3: \
+                while (i < 10) { i = i + 1; if (i == 4) break; }\
+                if (i == 4) break;\
+                r = 2;\
+         }\
+         return r + i; \
+     }", 5),
+    TEST("int main() { \
+         int r = 0; \
+         int i = 0; \
+         while (i < 6) { \
+            i = i + 1; \
+            switch (i) { \
+                case 2: continue;\
+                case 4: break;\
+                default: r = r + i;\
+            }\
+            r = r + 100; \
+         }\
+         return r; \
+     }", 515),
+    TEST("int div(int x) { return 10 / x; } \
+     int main() { \
+         int a = 0; \
+         if (a == 1 && div(a) > 1) return 1; \
+         if (a == 0 || div(a) > 1) return 2; \
+         return 3; \
+     }", 2),
+    TEST("int main() { \
+         int i = 0; \
+         int n = 0; \
+         while (i < 10 && n <= 20) { \
+            i = i + 1; \
+            if (i >= 3 || i == 1) n = n + i; \
+         }\
+         return i * 100 + n; \
+     }", 726),
+    TEST("int main() { \
+         int n = 0; \
+         while (n < 10) { \
+            int i = 0; \
+            while (i < 3) { i = i + 1; } \
+            n = n + 1; \
+            if (n == 5) { break; } \
+         }\
+         return n; \
+     }", 5),
+    TEST("int main() { \
+         int s = 0; \
+         int n = 0; \
+         while (n < 2) { \
+            int i = 0; \
+            while (i < 2) { i = i + 1; } \
+            n = n + 1; \
+            if (n == 2) { continue; } \
+            s = s + n; \
+         }\
+         return s; \
+     }", 1),
+    TEST("int main() { \
+         int s = 0; \
+         for (int n = 0; n < 4; n = n + 1) { \
+            int i = 0; \
+            do { i = i + 1; } while (i < 3); \
+            if (n == 1) { continue; } \
+            if (n == 3) { break; } \
+            s = s + n + 10; \
+         }\
+         return s; \
+     }", 22),
+    TEST("int main() { \
+         int a = 2; \
+         int b = 0; \
+         int c = a && b; \
+         int d = b || a; \
+         if (b || c || d) { c = c + 10; } \
+         return c * 10 + d; \
+     }", 101),
+    ERROR("int main() { double d = 1.0; switch (d) { case 1: return 1; } return 0; }", TypeError),
+    ERROR("int main() { switch (1) { case 1: return 1; case 1: return 2; } return 0; }", ParserError),
 };
 
 DEFINE_TEST_CATEGORY(control_flow_tests)
@@ -35,7 +35,8 @@ std::vector<Test> function_tests = {
     TEST("int foo(int a, int b) { return a; } int main() { return foo(1, 2); }", 1),
     TEST("int main(int x) { return main(x); }"),
     TEST("int bar(int i) { if (i) return 10; else return 5; } int main() { return bar(5); }", 10),
-    //TEST("void bar(int * i) { *i = 10; } int main() { int i = 1; bar(&i); return i; }", 10),
+    TEST("int f(int x) { return x + 1; } int main() { return f(1) * 10 + f(2) * 3 + f(3); }", 33),
+    TEST("void bar(int * i) { *i = 10; } int main() { int i = 1; bar(&i); return i; }", 10),
 };
 
 DEFINE_TEST_CATEGORY(function_tests)
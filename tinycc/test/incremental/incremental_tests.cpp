@@ -0,0 +1,92 @@
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+
+#include "common/colors.h"
+#include "frontend/incremental.h"
+
+#include "incremental_tests.h"
+
+using namespace tiny;
+using namespace colors;
+
+namespace {
+
+    /** The printed AST followed by the offsets of all its nodes, or nothing if the text does not parse.
+     */
+    std::string Dump(AST * ast) {
+        if (ast == nullptr)
+            return "";
+        std::stringstream ss;
+        ss << ColorPrinter::colorize(*ast) << "\n";
+        ASTWalker offsets{[&ss](AST * node) { ss << node->location().offset() << " "; }};
+        offsets.walk(ast);
+        return ss.str();
+    }
+
+    std::string Parse(std::string const & text) {
+        SourceFile & file = SourceFile::FromText(text, "");
+        std::string result;
+        try {
+            std::unique_ptr<AST> ast{Parser::parseFile(file)};
+            result = Dump(ast.get());
+        } catch (SourceError const &) {
+        }
+        SourceFile::Close(file.id());
+        return result;
+    }
+
+    char const * Source =
+        "struct S { int a; };\n"
+        "int f(int x) { return x + 1; }\n"
+        "int g = 3;\n"
+        "double d = 2.5;\n"
+        "char * s = \"str\";\n"
+        "int h(S * s) { return s->a * 2; }\n"
+        "int main() { return f(g) + 40; }\n";
+
+    /** Edits are made of these pieces so that they often break and repair comments, strings, blocks and declarations.
+     */
+    char const * Pieces[] = { "1", "2.5", " ", "x", ";", "}", "{", "/*", "*/", "\"", "int q;", "\n", "+", "S" };
+
+    size_t const NumEdits = 3000;
+
+}
+
+bool RunIncrementalTests() {
+    std::cout << "Running tests in category: " << color::blue << "incremental_tests" << color::reset << std::endl;
+    std::mt19937 rng{1};
+    std::string text{Source};
+    std::unique_ptr<IncrementalParser> parser{new IncrementalParser{text, ""}};
+    size_t fails = 0;
+    for (size_t i = 0; i < NumEdits; ++i) {
+        size_t offset = rng() % (text.size() + 1);
+        size_t length = std::min<size_t>(rng() % 3, text.size() - offset);
+        std::string piece{Pieces[rng() % (sizeof(Pieces) / sizeof(Pieces[0]))]};
+        text = text.substr(0, offset) + piece + text.substr(offset + length);
+        std::string expected = Parse(text);
+        std::string actual;
+        try {
+            parser->edit(offset, length, piece);
+            actual = Dump(parser->program());
+        } catch (SourceError const &) {
+        }
+        if (actual != expected) {
+            std::cout << color::red << "Edit " << i << " differs from parsing from scratch:" << color::reset << std::endl;
+            std::cout << "    " << text << std::endl;
+            ++fails;
+        }
+        // start over now and then so that the edits do not only pile up in broken text
+        if (expected.empty() && rng() % 2 == 0) {
+            text = Source;
+            parser.reset(new IncrementalParser{text, ""});
+        }
+    }
+    if (fails > 0) {
+        std::cout << color::red << "All: " << fails << "/" << NumEdits << " failed." << color::reset << std::endl;
+        return false;
+    }
+    std::cout << color::green << "PASS. All " << NumEdits << " edits matched." << color::reset << std::endl;
+    return true;
+}
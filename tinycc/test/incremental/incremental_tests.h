@@ -0,0 +1,7 @@
+#pragma once
+
+/** Differential test of the incremental parser.
+
+    Applies a fixed sequence of random edits to a program and compares the AST the incremental parser keeps, including the locations of all its nodes, with the AST of the edited text parsed from scratch. Returns true if they always agree.
+ */
+bool RunIncrementalTests();
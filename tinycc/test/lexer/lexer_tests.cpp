@@ -0,0 +1,94 @@
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include "common/colors.h"
+#include "frontend/lexer.h"
+
+#include "lexer_tests.h"
+
+using namespace tiny;
+using namespace colors;
+
+namespace {
+
+    /** The tokens with their offsets and values, or the error if the text does not lex.
+     */
+    template<typename TOKENIZE>
+    std::string Dump(std::string const & text, TOKENIZE tokenize) {
+        SourceFile & file = SourceFile::FromText(text, "");
+        std::stringstream ss;
+        try {
+            for (Token const & t : tokenize(file)) {
+                ss << t.location().offset() << " " << t.kind() << " ";
+                if (t == Token::Kind::Identifier || t == Token::Kind::Operator)
+                    ss << t.valueSymbol().id() << " " << static_cast<int>(t.keyword());
+                else if (t != Token::Kind::EoF)
+                    ss << t;
+                ss << "\n";
+            }
+        } catch (SourceError const & e) {
+            ss << e;
+        }
+        SourceFile::Close(file.id());
+        return ss.str();
+    }
+
+    /** Sources are made of these pieces so that newlines, where chunks may start, appear inside comments and literals as well as outside of them.
+     */
+    char const * Pieces[] = {
+        "int x = 42;\n",
+        "double d = 2.5;\n",
+        "x = x + 7 * 3.25;\n",
+        "/* block\n comment with \"quotes\" and 'a' and // inside\n */\n",
+        "/** doc ** / * \n*/",
+        "// line comment with \" and ' and /* inside\n",
+        "char * s = \"string with \\\" escaped \\\\ quotes\";\n",
+        "\"a\\\nb\" ",
+        "char c = '\\'';\n",
+        "char q = '\"';\n",
+        "\"/* not a comment */\" ",
+        "\"// not a comment either\" ",
+        "\n\n",
+        "   ",
+        "\"\\n\\t\" ",
+        "9223372036854775807 ",
+    };
+
+    size_t const NumSources = 200;
+
+    size_t const Chunks[] = { 2, 3, 5, 8, 16, 64 };
+
+}
+
+bool RunParallelLexerTests() {
+    std::cout << "Running tests in category: " << color::blue << "parallel_lexer_tests" << color::reset << std::endl;
+    std::mt19937 rng{1};
+    size_t tests = 0;
+    size_t fails = 0;
+    for (size_t i = 0; i < NumSources; ++i) {
+        std::string text;
+        size_t pieces = rng() % 200;
+        for (size_t j = 0; j < pieces; ++j)
+            text += Pieces[rng() % (sizeof(Pieces) / sizeof(Pieces[0]))];
+        // every tenth source ends in the middle of a comment or a literal
+        if (i % 10 == 9)
+            text += (i % 20 == 9) ? "/* unterminated\n" : "\"unterminated\n";
+        std::string expected = Dump(text, [](SourceFile & file) { return Lexer::Tokenize(file); });
+        for (size_t chunks : Chunks) {
+            ++tests;
+            std::string actual = Dump(text, [chunks](SourceFile & file) { return Lexer::TokenizeParallel(file, chunks); });
+            if (actual != expected) {
+                std::cout << color::red << "Source " << i << " split into " << chunks << " chunks differs from lexing it at once:" << color::reset << std::endl;
+                std::cout << "    " << text << std::endl;
+                ++fails;
+            }
+        }
+    }
+    if (fails > 0) {
+        std::cout << color::red << "All: " << fails << "/" << tests << " failed." << color::reset << std::endl;
+        return false;
+    }
+    std::cout << color::green << "PASS. All " << tests << " tokenizations matched." << color::reset << std::endl;
+    return true;
+}
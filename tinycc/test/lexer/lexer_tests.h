@@ -0,0 +1,7 @@
+#pragma once
+
+/** Differential test of the parallel lexer.
+
+    Lexes generated sources split into various numbers of chunks and compares the tokens, their offsets and literal values with the tokens of the single-threaded lexer. The sources are dense with comments and literals, including escaped quotes and comment delimiters inside literals, so that the candidate chunk boundaries often fall inside them. Returns true if the tokens always agree.
+ */
+bool RunParallelLexerTests();
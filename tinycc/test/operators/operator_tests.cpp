@@ -25,6 +25,8 @@ std::vector<Test> operator_tests = {
     TEST("int main(int a, int b) { return a | b; }"),
     TEST("int main(int a, int b) { return a && b; }"),
     TEST("int main(int a, int b) { return a || b; }"),
+    TEST("int main() { int a = 3; int b = 0; int x = a && b; int y = b || a; int z = b || 0; return x * 100 + y * 10 + z; }", 10),
+    TEST("int main() { int a = 2; int b = 0; return 4 - a * 2 || b; }", 0),
     TEST("int main(double a, double b) { return a > b; }"),
     TEST("int main(double a, int b) { return a > b; }"),
     TEST("int main(int a, double b) { return a > b; }"),
@@ -23,6 +23,13 @@ std::vector<Test> pointer_tests = {
     TEST("int main() { int * a; return *a; }"),
     TEST("void main(double * a) { *a = 6.0; }"),
     TEST("void main(int * a) { a = 678; }"),
+    TEST("int main() { char * a = \"hello\"; char * b = \"hello\"; char * c = \"world\"; int r = 0; if (a == b) r = r + 10; if (a == c) r = r + 100; return r + *\"B\"; }", 76),
+    TEST("int f(char * s) { if (*s == 97) return 1; return 0; } int main() { char * a = \"hello world, strings\"; char * b = \"hello world, strings\"; int e = 0; if (a == b) e = 1; return f(\"a\") * 100 + f(a) * 10 + f(\"\") + e; }", 101),
+    TEST("int main() { char * s = \"hello\"; int r = 0; if (s[1] == 'e') r = 1; if (*\"ab\" == 'a') r = r + 10; return r * 100 + s[4] - s[0]; }", 1107),
+    TEST("int main() { char * s = \"abc\"; int n = 0; while (s[n] > 0) n = n + 1; return n; }", 3),
+    TEST("int main() { int x = 1; int * p = &x; int y = x; *p = 7; return x * 10 + y; }", 71),
+    TEST("int main() { int x = 1; int * p = &x; int ** q = &p; **q = 4; return *p * 10 + x; }", 44),
+    TEST("int main() { char a = 'a'; char b = 'b'; char * p = &a; char * q = &b; *q = 'c'; return *p * 1000 + *q; }", 97099),
 };
 
 DEFINE_TEST_CATEGORY(pointer_tests)
@@ -11,6 +11,15 @@ std::vector<Test> struct_tests{
     TEST("struct Node; struct Node { int value; struct Node *next; }; int main() { struct Node n1, n2; n1.value = 5; n1.next = &n2; n2.value = 6; n2.next = 0; return n1.value + n1.next->value; }"),
     TEST("struct Foo { }; void main(Foo x) {}"),
     TEST("struct Foo; struct Foo { int i; }; void main(Foo x) {}"),
+    TEST("struct Point { int x; int y; }; int main() { Point p; p.x = 5; p.y = 6; return p.x + p.y; }", 11),
+    TEST("struct Point { int x; int y; }; struct Line { Point p1; Point p2; }; int main() { Line l; l.p1.x = 1; l.p1.y = 2; l.p2.x = 3; l.p2.y = 4; return l.p1.x + l.p1.y * 10 + l.p2.x * 100 + l.p2.y * 1000; }", 4321),
+    TEST("struct Node { int value; Node * next; }; int main() { Node n1; Node n2; n1.value = 5; n1.next = &n2; n2.value = 6; n2.next = 0; return n1.value + n1.next->value; }", 11),
+    TEST("struct Node { int value; Node * next; }; int main() { Node a; Node b; Node c; a.value = 1; b.value = 20; c.value = 300; a.next = &b; b.next = &c; c.next = &a; Node * n = &a; int s = 0; int i = 0; while (i < 4) { s = s + n->value; n = n->next; i = i + 1; } return s; }", 322),
+    // fields smaller than a word must not overwrite their neighbours. Double fields are not tested, the t86 backend cannot store double constants yet
+    TEST("struct Mixed { char a; int * b; char c; int d; }; int main() { Mixed m; m.d = 7; m.c = 'x'; m.b = &m.d; m.a = 'y'; if (m.c == 'x') { return *m.b; } return 0; }", 7),
+    TEST("struct P { int * a; int * b; }; int main() { int x = 1; int y = 2; P p; p.b = &y; p.a = &x; return *p.b; }", 2),
+    TEST("struct C { char a; char b; }; int main() { C c; c.b = 'b'; c.a = 'a'; int r = 0; if (c.b == 'b') { r = r + 1; } if (c.a == 'a') { r = r + 10; } return r; }", 11),
+    TEST("struct C { char a; char b; }; struct O { C c; int * p; char d; }; int main() { int x = 5; O o; o.d = 'd'; o.p = &x; o.c.b = 'b'; o.c.a = 'a'; int r = *o.p; if (o.d == 'd') { r = r + 10; } if (o.c.b == 'b') { r = r + 100; } return r; }", 115),
 };
 
 DEFINE_TEST_CATEGORY(struct_tests)
@@ -1,8 +1,17 @@
 //
 // Created by Mirek Škrabal on 17.06.2023.
 //
+#include <iostream>
+
+#include "common/colors.h"
+#include "frontend/parser.h"
+#include "frontend/typechecker.h"
+
 #include "typechecker_tests.h"
 
+using namespace tiny;
+using namespace colors;
+
 std::vector<Test> typechecker_tests = {
     TEST("int main() { return 1; }", 1),
     TEST("int main() { int i = 1; return i; }", 1),
@@ -60,6 +69,51 @@ std::vector<Test> typechecker_tests = {
     ERROR("struct Foo {}; Foo main(Foo i) { return !i; }", TypeError),
     ERROR("struct Foo {}; Foo main(Foo i) { return ++i; }", TypeError),
     ERROR("struct Foo {}; Foo main(Foo i) { return --i; }", TypeError),
+// a body must not see a struct completed after it, even when the bodies are checked after all declarations
+    ERROR("struct S; int f() { S s; return 0; } struct S { int a; }; int main() { return f(); }", TypeError),
+    ERROR("struct S; int f(S * p) { return p->a; } struct S { int a; }; int main() { return 0; }", TypeError),
+    ERROR("struct S; int f(S * p) { S s; s.a = 1; return s.a; } int g() { return 1; } struct S { int a; }; int main() { return g(); }", TypeError),
 };
 
 DEFINE_TEST_CATEGORY(typechecker_tests)
+
+namespace {
+
+    /** Typechecks the program and returns the error, or an empty string if it typechecks.
+     */
+    std::string Typecheck(char const * input, bool parallel) {
+        SourceFile & file = SourceFile::FromText(input, "");
+        std::string result;
+        try {
+            std::unique_ptr<AST> ast{Parser::parseFile(file)};
+            Typechecker::checkProgram(ast, parallel);
+        } catch (SourceError const & e) {
+            result = STR(e);
+        }
+        SourceFile::Close(file.id());
+        return result;
+    }
+
+}
+
+bool RunParallelTypecheckerTests() {
+    std::cout << "Running tests in category: " << color::blue << "parallel_typechecker_tests" << color::reset << std::endl;
+    size_t fails = 0;
+    for (Test const & t : typechecker_tests) {
+        std::string sequential = Typecheck(t.input, false);
+        std::string parallel = Typecheck(t.input, true);
+        if (sequential != parallel) {
+            std::cout << color::red << t.file << ":" << t.line << ": Parallel typechecking differs." << color::reset << std::endl;
+            std::cout << "    " << t.input << std::endl;
+            std::cout << "    sequential: " << sequential << std::endl;
+            std::cout << "    parallel: " << parallel << std::endl;
+            ++fails;
+        }
+    }
+    if (fails > 0) {
+        std::cout << color::red << "All: " << fails << "/" << typechecker_tests.size() << " failed." << color::reset << std::endl;
+        return false;
+    }
+    std::cout << color::green << "PASS. All " << typechecker_tests.size() << " tests typecheck the same in parallel." << color::reset << std::endl;
+    return true;
+}
@@ -10,3 +10,7 @@
 
 extern std::vector<Test> typechecker_tests;
 
+/** Typechecks each of the typechecker tests both sequentially and in parallel and checks that both report the same error, or none. Returns true if they always agree.
+ */
+bool RunParallelTypecheckerTests();
+